@@ -0,0 +1,71 @@
+/* throughput of nk_memcopy and nk_memset next to memmove and memset
+ *
+ * Built twice: with the vector paths and with NK_NO_SIMD for the old word
+ * loops. Configure with -DCMAKE_BUILD_TYPE=Release, then
+ *   cmake --build <dir> --target atirgul_bench_memory atirgul_bench_memory_scalar
+ * and compare the output of both. */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "nuklear.h"
+#include "nuklear_internal.h"
+
+#define BENCH_BYTES (1 << 20)
+#define BENCH_TOTAL 2e9 /* bytes moved per measurement */
+
+/* called through pointers so the compiler can not inline or drop them */
+static void *(*volatile libc_copy)(void*, const void*, size_t) = memmove;
+static void *(*volatile libc_set)(void*, int, size_t) = memset;
+static void *(*volatile nk_copy)(void*, const void*, nk_size) = nk_memcopy;
+static void (*volatile nk_set)(void*, int, nk_size) = nk_memset;
+
+static unsigned char dst[BENCH_BYTES + 64], src[BENCH_BYTES + 64];
+
+static double
+seconds(clock_t begin)
+{
+    return (double)(clock() - begin) / CLOCKS_PER_SEC;
+}
+static double
+copy_rate(int libc, size_t size)
+{
+    /* GB/s, the destination moves over the first 8 bytes to vary alignment */
+    long i, count = (long)(BENCH_TOTAL / (double)(size + 64));
+    clock_t begin = clock();
+    for (i = 0; i < count; ++i) {
+        if (libc) libc_copy(dst + (i & 7), src, size);
+        else nk_copy(dst + (i & 7), src, size);
+    }
+    return (double)size * (double)count / seconds(begin) / 1e9;
+}
+static double
+set_rate(int libc, size_t size)
+{
+    long i, count = (long)(BENCH_TOTAL / (double)(size + 64));
+    clock_t begin = clock();
+    for (i = 0; i < count; ++i) {
+        if (libc) libc_set(dst + (i & 7), (int)i, size);
+        else nk_set(dst + (i & 7), (int)i, size);
+    }
+    return (double)size * (double)count / seconds(begin) / 1e9;
+}
+int
+main(void)
+{
+    static const size_t sizes[] = {24, 40, 64, 496, 520, 4096, 65536, BENCH_BYTES};
+    size_t i;
+
+    memset(src, 0x5a, sizeof(src));
+#ifdef NK_NO_SIMD
+    printf("nk_memcopy/nk_memset: word loops (NK_NO_SIMD)\n");
+#else
+    printf("nk_memcopy/nk_memset: vector loops\n");
+#endif
+    printf("%8s %12s %12s %12s %12s\n", "bytes", "copy nk", "copy libc", "set nk", "set libc");
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        size_t size = sizes[i];
+        printf("%8lu %7.2f GB/s %7.2f GB/s %7.2f GB/s %7.2f GB/s\n", (unsigned long)size,
+            copy_rate(0, size), copy_rate(1, size), set_rate(0, size), set_rate(1, size));
+    }
+    return 0;
+}
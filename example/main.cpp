@@ -55,7 +55,6 @@ void draw_multilingual_window(struct nk_context *ctx, AppData &data)
     int wmargin = (data.width > data.draw_width) ? (data.width - data.draw_width) / 2 : 0;
     int hmargin = (data.height > data.draw_height) ? (data.height - data.draw_height) / 2 : 0;
 
-    std::string progress_str = std::to_string(data.current_progress) + " %";
     auto progress_nk = static_cast<nk_size>(data.current_progress);
 
     auto window_flags = NK_WINDOW_BORDER | NK_WINDOW_NO_SCROLLBAR;
@@ -92,7 +91,8 @@ void draw_multilingual_window(struct nk_context *ctx, AppData &data)
 
         // 10% Progress Text
         nk_layout_row_push(ctx, 0.10f);
-        nk_label(ctx, progress_str.c_str(), NK_TEXT_CENTERED);
+        const char *percent = nk_frame_printf(ctx, "%d %%", data.current_progress);
+        nk_label(ctx, percent ? percent : "", NK_TEXT_CENTERED);
         nk_layout_row_end(ctx);
 
         // 4. Spacer
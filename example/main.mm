@@ -224,7 +224,6 @@ static void draw_multilingual_window(struct nk_context *ctx, AppData &data)
 {
     const LanguageData &lang = LANGUAGES[data.language_index];
 
-    std::string progress_str = std::to_string(data.current_progress) + " %";
     auto progress_nk = static_cast<nk_size>(data.current_progress);
 
     auto window_flags = NK_WINDOW_BORDER | NK_WINDOW_NO_SCROLLBAR;
@@ -251,7 +250,8 @@ static void draw_multilingual_window(struct nk_context *ctx, AppData &data)
         nk_layout_row_push(ctx, 0.85f);
         nk_progress(ctx, &progress_nk, MAX_PROGRESS, NK_FIXED);
         nk_layout_row_push(ctx, 0.10f);
-        nk_label(ctx, progress_str.c_str(), NK_TEXT_CENTERED);
+        const char *percent = nk_frame_printf(ctx, "%d %%", data.current_progress);
+        nk_label(ctx, percent ? percent : "", NK_TEXT_CENTERED);
         nk_layout_row_end(ctx);
 
         nk_layout_row_dynamic(ctx, 10, 1);
@@ -352,7 +352,15 @@ enum nk_symbol_type {
  * \ref nk_init_fixed   | Initializes context from single fixed size memory block
  * \ref nk_init         | Initializes context with memory allocator callbacks for alloc and free
  * \ref nk_init_custom  | Initializes context from two buffers. One for draw commands the other for window/panel/table allocations
+ * \ref nk_init_virtual | Initializes context from a reserved virtual memory range committed on demand
  * \ref nk_clear        | Called at the end of the frame to reset and prepare the context for the next frame
+ * \ref nk_trim         | Returns memory of closed windows, popups and tables
+ * \ref nk_collect      | Frees window state left over by a `gc_budget` limited `nk_clear`
+ * \ref nk_attach_worker| Adds the windows of a context built on another thread to this frame
+ * \ref nk_frame_needs_redraw    | Returns if the next frame could look different even without new input
+ * \ref nk_next_deadline_seconds | Returns how long the application can wait for input before the next frame
+ * \ref nk_frame_alloc  | Allocates scratch memory that stays valid until the next `nk_clear`
+ * \ref nk_frame_printf | Formats a string into scratch memory that stays valid until the next `nk_clear`
  * \ref nk_free         | Shutdown and free all memory allocated inside the context
  * \ref nk_set_user_data| Utility function to pass user data to draw command
  */
@@ -403,6 +411,29 @@ NK_API nk_bool nk_init_default(struct nk_context*, const struct nk_user_font*);
  */
 NK_API nk_bool nk_init_fixed(struct nk_context*, void *memory, nk_size size, const struct nk_user_font*);
 
+#ifdef NK_INCLUDE_VIRTUAL_MEMORY
+/**
+ * # nk_init_virtual
+ * Initializes a `nk_context` struct from a reserved range of virtual memory.
+ * Works like `nk_init_fixed` but pages are only committed once draw commands,
+ * windows, panels or tables need them, and the memory never moves, so pointers
+ * to draw commands stay valid while a frame grows.
+ *
+ * ```c
+ * nk_bool nk_init_virtual(struct nk_context *ctx, nk_size reserve, const struct nk_user_font *font);
+ * ```
+ *
+ * Parameter   | Description
+ * ------------|--------------------------------------------------------------
+ * \param[in] ctx     | Must point to an either stack or heap allocated `nk_context` struct
+ * \param[in] reserve | Size of the address range to reserve, the upper bound of memory usage
+ * \param[in] font    | Must point to a previously initialized font handle for more info look at font documentation
+ *
+ * \returns either `false(0)` if the range could not be reserved or `true(1)` on success.
+ */
+NK_API nk_bool nk_init_virtual(struct nk_context*, nk_size reserve, const struct nk_user_font*);
+#endif
+
 /**
  * # nk_init
  * Initializes a `nk_context` struct with memory allocation callbacks for nuklear to allocate
@@ -458,6 +489,205 @@ NK_API nk_bool nk_init_custom(struct nk_context*, struct nk_buffer *cmds, struct
  */
 NK_API void nk_clear(struct nk_context*);
 
+/**
+ * \brief Returns memory that is no longer used by the context.
+ *
+ * \details
+ * Windows, panels and tables that were freed by `nk_clear` are kept for reuse.
+ * This releases every pool page whose elements are all unused, gives unused
+ * elements at the end of a fixed memory block back to the draw commands and
+ * decommits unused pages of a virtual buffer. The `nk_frame_alloc` arena is
+ * freed too if nothing was allocated from it since `nk_clear`. Call it outside of
+ * `nk_begin`/`nk_end`, for example after closing a batch of popups or once
+ * every few seconds in long running applications.
+ *
+ * ```c
+ * nk_size nk_trim(struct nk_context *ctx);
+ * ```
+ *
+ * \param[in] ctx  Must point to a previously initialized `nk_context` struct
+ *
+ * \returns the number of bytes released.
+ */
+NK_API nk_size nk_trim(struct nk_context*);
+
+/**
+ * \brief Frees window state tables that were not used in the last frame.
+ *
+ * \details
+ * `nk_clear` frees widget state nobody looked up during the frame. Its cost
+ * grows with the number of these stale tables, not with the retained state.
+ * Set `ctx->gc_budget` to limit the number of tables `nk_clear` frees per
+ * frame, for example when a large tree was collapsed in a big context. The
+ * rest stays around and is freed by later frames, or by calling
+ * `nk_collect` while the application is idle. State that is used again
+ * before it is freed is kept.
+ *
+ * ```c
+ * nk_size nk_collect(struct nk_context *ctx, nk_size budget);
+ * ```
+ *
+ * \param[in] ctx     Must point to a previously initialized `nk_context` struct
+ * \param[in] budget  Maximum number of tables to free, `0` for all
+ *
+ * \returns the number of tables freed.
+ */
+NK_API nk_size nk_collect(struct nk_context*, nk_size budget);
+
+/**
+ * \brief Adds the windows of a worker context to the current frame.
+ *
+ * \details
+ * Windows that do not overlap can be built in parallel, each thread with its
+ * own context. Attach every worker on the UI thread after `nk_input_end`: the
+ * worker gets a copy of the input and style of `ctx` to build its windows
+ * with, so the UI thread can go on building windows on `ctx` while the workers
+ * run. Only drawing and clearing `ctx` have to wait until all workers
+ * finished. Drawing `ctx` then includes the commands of all attached workers,
+ * placed above the windows of `ctx` in the order they were attached, and
+ * `nk_clear` clears the workers too:
+ *
+ * ```c
+ * nk_input_end(&ctx);
+ * for (i = 0; i < count; ++i) {
+ *     nk_attach_worker(&ctx, &workers[i]);
+ *     start_thread(build_windows, &workers[i]);
+ * }
+ * build_windows(&ctx);
+ * join_threads();
+ * nk_foreach(cmd, &ctx) {...}
+ * nk_clear(&ctx);
+ * ```
+ *
+ * Window names, state, focus and popups are private to each context, so a
+ * worker should always build the same windows and its popups are drawn above
+ * its own windows only. Mouse input goes to all of them, keyboard and text
+ * input to one: the context whose text field or property became active last,
+ * `ctx` if there is none. The others get no keys and no text from this call.
+ * Font callbacks and allocators have to be safe to call from all threads
+ * involved.
+ *
+ * ```c
+ * void nk_attach_worker(struct nk_context *ctx, struct nk_context *worker);
+ * ```
+ *
+ * \param[in] ctx     Must point to a previously initialized `nk_context` struct
+ * \param[in] worker  Separately initialized context to build windows on another thread
+ */
+NK_API void nk_attach_worker(struct nk_context*, struct nk_context *worker);
+
+/**
+ * \brief Returns if another frame has to be run right away.
+ *
+ * \details
+ * Input of the last frame can still change the UI in the next one, for
+ * example hover transitions, opened popups or held repeater buttons, and
+ * auto hiding scrollbars have to be hidden once their timer ran out. Call it
+ * after the frame was built and before the next `nk_input_begin`. If it
+ * returns `nk_false` the application can block until new input arrives or
+ * `nk_next_deadline_seconds` passed:
+ *
+ * ```c
+ * if (!nk_frame_needs_redraw(&ctx))
+ *     wait_for_events(nk_next_deadline_seconds(&ctx));
+ * ```
+ *
+ * ```c
+ * nk_bool nk_frame_needs_redraw(const struct nk_context *ctx);
+ * ```
+ *
+ * \param[in] ctx  Must point to a previously initialized `nk_context` struct
+ *
+ * \returns `nk_true` if the next frame could differ without any new input.
+ */
+NK_API nk_bool nk_frame_needs_redraw(const struct nk_context*);
+
+/**
+ * \brief Returns the time until a running timer changes the UI.
+ *
+ * \details
+ * Timers like the scrollbar hiding timer of `NK_WINDOW_SCROLL_AUTO_HIDE`
+ * windows advance by `delta_time_seconds` each frame, so the frame run at the
+ * deadline has to pass the time waited in `delta_time_seconds`.
+ *
+ * ```c
+ * float nk_next_deadline_seconds(const struct nk_context *ctx);
+ * ```
+ *
+ * \param[in] ctx  Must point to a previously initialized `nk_context` struct
+ *
+ * \returns `0` if `nk_frame_needs_redraw` is true, the seconds until the
+ * next timer runs out or a negative value if no timer is running.
+ */
+NK_API float nk_next_deadline_seconds(const struct nk_context*);
+
+/**
+ * \brief Allocates memory from the per-frame scratch arena of the context.
+ *
+ * \details
+ * The memory stays valid until the next `nk_clear` and does not have to be
+ * freed. It is meant for data that is built every frame, like formatted
+ * labels. The arena keeps one block sized to the busiest frame so far, so a
+ * steady frame does not allocate at all. Contexts created with an allocator
+ * use it for the arena. Fixed memory contexts need `nk_frame_init_fixed`
+ * first, and otherwise return `0`.
+ *
+ * ```c
+ * void *nk_frame_alloc(struct nk_context *ctx, nk_size size);
+ * ```
+ *
+ * \param[in] ctx   Must point to a previously initialized `nk_context` struct
+ * \param[in] size  Number of bytes to allocate
+ *
+ * \returns memory aligned to `NK_FRAME_ALIGNMENT` or `0` if the arena is out of memory.
+ */
+NK_API void *nk_frame_alloc(struct nk_context*, nk_size size);
+
+/**
+ * \brief Gives the per-frame scratch arena a fixed memory block to allocate from.
+ *
+ * \details
+ * ```c
+ * void nk_frame_init_fixed(struct nk_context *ctx, void *memory, nk_size size);
+ * ```
+ *
+ * \param[in] ctx     Must point to a previously initialized `nk_context` struct
+ * \param[in] memory  Block that stays owned by the caller and outlives the context
+ * \param[in] size    Size of the block in bytes
+ */
+NK_API void nk_frame_init_fixed(struct nk_context*, void *memory, nk_size size);
+
+/**
+ * \brief Returns the most scratch memory used by any frame so far.
+ *
+ * \details
+ * ```c
+ * nk_size nk_frame_high_water(const struct nk_context *ctx);
+ * ```
+ *
+ * \param[in] ctx  Must point to a previously initialized `nk_context` struct
+ */
+NK_API nk_size nk_frame_high_water(const struct nk_context*);
+
+#ifdef NK_INCLUDE_STANDARD_VARARGS
+/**
+ * \brief Formats a string into the per-frame scratch arena.
+ *
+ * \details
+ * ```c
+ * const char *nk_frame_printf(struct nk_context *ctx, const char *fmt, ...);
+ * ```
+ *
+ * \param[in] ctx  Must point to a previously initialized `nk_context` struct
+ * \param[in] fmt  printf style format string
+ *
+ * \returns the zero terminated string, valid until the next `nk_clear`, or
+ * `0` if the arena is out of memory.
+ */
+NK_API const char *nk_frame_printf(struct nk_context*, NK_PRINTF_FORMAT_STRING const char*, ...) NK_PRINTF_VARARG_FUNC(2);
+NK_API const char *nk_frame_vprintf(struct nk_context*, NK_PRINTF_FORMAT_STRING const char*, va_list) NK_PRINTF_VALIST_FUNC(2);
+#endif
+
 /**
  * \brief Frees all memory allocated by nuklear; Not needed if context was initialized with `nk_init_fixed`.
  *
@@ -734,6 +964,128 @@ NK_API void nk_input_unicode(struct nk_context*, nk_rune);
  */
 NK_API void nk_input_end(struct nk_context*);
 
+#ifdef NK_INCLUDE_INPUT_QUEUE
+/**
+ * # Input Queue
+ * The `nk_input_xxx` functions have to be called on the UI thread. An input
+ * queue lets other threads, like evdev or touch driver threads, push
+ * timestamped events at any time instead. The queue is a fixed ring of
+ * `NK_INPUT_QUEUE_SIZE` events; pushing is lock-free and safe from any
+ * number of threads, while only the UI thread drains it between
+ * `nk_input_begin` and `nk_input_end`:
+ *
+ * ```c
+ * // input thread
+ * nk_input_queue_motion(&queue, now(), x, y);
+ *
+ * // UI thread
+ * nk_input_begin(&ctx);
+ * nk_input_drain(&ctx, &queue, now());
+ * nk_input_end(&ctx);
+ * ```
+ *
+ * Draining applies consecutive motion events as one, sums up scrolling and
+ * stops at the first event the frame cannot represent without losing it: a
+ * second transition of the same key or button, text beyond `NK_INPUT_MAX`
+ * bytes, or an event newer than the frame. Those stay queued for the next
+ * frame, so fast typing and pasted text arrive over several frames instead of
+ * being dropped. Applications that wait for input should run another frame
+ * while events are left over. Pushing fails if the queue is full.
+ *
+ * # Reference
+ * Function                  | Description
+ * --------------------------|-------------------------------------------------------
+ * \ref nk_input_queue_init    | Empties a queue before its first use
+ * \ref nk_input_queue_push    | Pushes an event from any thread
+ * \ref nk_input_queue_motion  | Pushes a mouse motion from any thread
+ * \ref nk_input_queue_button  | Pushes a mouse button change from any thread
+ * \ref nk_input_queue_key     | Pushes a key change from any thread
+ * \ref nk_input_queue_scroll  | Pushes a scroll value from any thread
+ * \ref nk_input_queue_unicode | Pushes a unicode codepoint from any thread
+ * \ref nk_input_drain         | Applies queued events up to a timestamp to the context
+ */
+#ifndef NK_INPUT_QUEUE_SIZE
+#define NK_INPUT_QUEUE_SIZE 256 /* must be a power of two */
+#endif
+
+enum nk_input_event_type {
+    NK_INPUT_EVENT_MOTION,
+    NK_INPUT_EVENT_BUTTON,
+    NK_INPUT_EVENT_KEY,
+    NK_INPUT_EVENT_SCROLL,
+    NK_INPUT_EVENT_UNICODE
+};
+
+struct nk_input_event {
+    enum nk_input_event_type type;
+    double time; /**!< seconds on the clock passed to `nk_input_drain` */
+    union {
+        struct {int x, y;} motion;
+        struct {enum nk_buttons id; int x, y; nk_bool down;} button;
+        struct {enum nk_keys id; nk_bool down;} key;
+        struct nk_vec2 scroll;
+        nk_rune unicode;
+    } data;
+};
+
+struct nk_input_queue_slot {
+    nk_size seq; /**!< tells producers and the consumer whose turn it is */
+    struct nk_input_event event;
+};
+
+struct nk_input_queue {
+    nk_size head; /**!< next slot claimed by a producer */
+    nk_size tail; /**!< next slot read by `nk_input_drain` */
+    struct nk_input_queue_slot slots[NK_INPUT_QUEUE_SIZE];
+};
+
+/**
+ * # nk_input_queue_init
+ * Empties a queue. Must not race with pushes or draining.
+ *
+ * ```c
+ * void nk_input_queue_init(struct nk_input_queue *queue);
+ * ```
+ */
+NK_API void nk_input_queue_init(struct nk_input_queue*);
+
+/**
+ * # nk_input_queue_push
+ * Copies an event into the queue, can be called from any thread.
+ *
+ * ```c
+ * nk_bool nk_input_queue_push(struct nk_input_queue *queue, const struct nk_input_event *event);
+ * ```
+ *
+ * \returns `nk_false` if the queue is full and the event was not added.
+ */
+NK_API nk_bool nk_input_queue_push(struct nk_input_queue*, const struct nk_input_event*);
+NK_API nk_bool nk_input_queue_motion(struct nk_input_queue*, double time, int x, int y);
+NK_API nk_bool nk_input_queue_button(struct nk_input_queue*, double time, enum nk_buttons, int x, int y, nk_bool down);
+NK_API nk_bool nk_input_queue_key(struct nk_input_queue*, double time, enum nk_keys, nk_bool down);
+NK_API nk_bool nk_input_queue_scroll(struct nk_input_queue*, double time, struct nk_vec2 val);
+NK_API nk_bool nk_input_queue_unicode(struct nk_input_queue*, double time, nk_rune);
+
+/**
+ * # nk_input_drain
+ * Applies queued events with a timestamp up to `time` to the context. Has to
+ * be called on the UI thread between `nk_input_begin` and `nk_input_end`.
+ *
+ * ```c
+ * int nk_input_drain(struct nk_context *ctx, struct nk_input_queue *queue, double time);
+ * ```
+ *
+ * Parameter   | Description
+ * ------------|-----------------------------------------------------------
+ * \param[in] ctx     | Must point to a previously initialized `nk_context` struct
+ * \param[in] queue   | Queue the events were pushed to
+ * \param[in] time    | Timestamp of the frame, later events stay queued
+ *
+ * \returns the number of events taken from the queue.
+ */
+NK_API int nk_input_drain(struct nk_context*, struct nk_input_queue*, double time);
+#endif
+
 /** =============================================================================
  *
  *                                  DRAWING
@@ -958,6 +1310,10 @@ NK_API void nk_input_end(struct nk_context*);
  * \ref nk__begin       | Returns the first draw command in the context draw command list to be drawn
  * \ref nk__next        | Increments the draw command iterator to the next command inside the context draw command list
  * \ref nk_foreach      | Iterates over each draw command inside the context draw command list
+ * \ref nk_set_command_encoding | Selects whether the draw command list is iterated as is or from a compact encoding
+ * \ref nk_command_stream | Returns the draw command list of the frame as bytes in the selected encoding
+ * \ref nk_command_serialize | Serializes the draw command list of the frame for another process
+ * \ref nk_command_deserialize | Makes a serialized frame the draw command list of a context
  * \ref nk_convert      | Converts from the abstract draw commands list into a hardware accessible vertex format
  * \ref nk_draw_begin   | Returns the first vertex command in the context vertex draw list to be executed
  * \ref nk__draw_next   | Increments the vertex command iterator to the next command inside the context vertex command list
@@ -1032,6 +1388,220 @@ NK_API const struct nk_command* nk__next(struct nk_context*, const struct nk_com
  */
 #define nk_foreach(c, ctx) for((c) = nk__begin(ctx); (c) != 0; (c) = nk__next(ctx,c))
 
+enum nk_command_encoding {
+    NK_COMMAND_ENCODING_RAW,    /**!< commands are iterated in place inside the context memory */
+    NK_COMMAND_ENCODING_COMPACT /**!< commands are iterated from a compact re-encoding of the frame */
+};
+
+/**
+ * \brief Selects the encoding the draw command list is iterated in.
+ *
+ * \details
+ * The compact encoding re-encodes the frame once it is built: command sizes
+ * are implied instead of stored as `next` offsets, coordinates are variable
+ * length integers, colors index a per-frame palette and font and userdata
+ * pointers are interned. `nk__begin`/`nk__next` decode one command at a time,
+ * so a returned command is only valid until the next call. A frame the
+ * encoding runs out of memory for is iterated raw instead. Requires a context
+ * created with an allocator.
+ *
+ * ```c
+ * nk_bool nk_set_command_encoding(struct nk_context*, enum nk_command_encoding);
+ * ```
+ *
+ * \param[in] ctx       | Must point to an previously initialized `nk_context` struct
+ * \param[in] encoding  | `NK_COMMAND_ENCODING_RAW` (default) or `NK_COMMAND_ENCODING_COMPACT`
+ *
+ * \returns `nk_true` if the encoding was selected, `nk_false` otherwise.
+ */
+NK_API nk_bool nk_set_command_encoding(struct nk_context*, enum nk_command_encoding);
+
+/**
+ * \brief Returns the draw command list of the frame in the selected encoding.
+ *
+ * \details
+ * Builds the frame like `nk__begin` if necessary. Two frames with equal bytes
+ * draw the same, which makes it a cheap way to skip unchanged frames, and the
+ * size is the number of bytes per frame the encoding takes. A frame that could
+ * not be encoded is returned as the raw command list.
+ *
+ * ```c
+ * const void* nk_command_stream(struct nk_context*, nk_size *size);
+ * ```
+ *
+ * \param[in] ctx   | Must point to an previously initialized `nk_context` struct at the end of a frame
+ * \param[out] size | Number of bytes in the returned memory
+ *
+ * \returns the encoded commands or `0` if there are none.
+ */
+NK_API const void* nk_command_stream(struct nk_context*, nk_size *size);
+
+/**
+ * # Command Serialization
+ * Draw commands hold font, image and callback pointers and link each other by
+ * offsets into the context memory, so they are only meaningful inside the
+ * process that built them. A serializer turns each frame into a byte stream
+ * without pointers that can be sent over a pipe, socket or shared memory to a
+ * renderer in another process, where a deserializer turns it back into the
+ * draw command list of a context:
+ *
+ * ```c
+ * // UI process, after building the frame
+ * const void *frame = nk_command_serialize(&ser, &ctx, &size);
+ * write_frame(pipe, frame, size);
+ * nk_clear(&ctx);
+ *
+ * // renderer process
+ * read_frame(pipe, buffer, &size);
+ * if (!nk_command_deserialize(&des, nk_cairo_get_nk_context(cairo), buffer, size))
+ *     request_key_frame();
+ * nk_cairo_render(cairo);
+ * ```
+ *
+ * Fonts and images are sent as ids both sides register with the same value,
+ * including the default font and `nk_image_id` images. Text is always copied,
+ * custom commands keep their bounds and `callback_data.id` and get the
+ * `custom` callback of the deserializer.
+ *
+ * Every frame after the first only sends the commands that changed since the
+ * frame before, unchanged runs are copied by the receiver from the previous
+ * frame it applied. A receiver that missed a frame rejects the following ones
+ * until `nk_command_serializer_reset` makes the sender start over with a frame
+ * that stands on its own.
+ *
+ * # Reference
+ * Function                           | Description
+ * -----------------------------------|-------------------------------------------------------
+ * \ref nk_command_serializer_init     | Initializes a serializer with an allocator
+ * \ref nk_command_serializer_free     | Frees the memory of a serializer
+ * \ref nk_command_serializer_reset    | Makes the next frame independent of the previous one
+ * \ref nk_command_serializer_font     | Gives a font the id it is sent as
+ * \ref nk_command_serializer_image    | Gives an image handle the id it is sent as
+ * \ref nk_command_serialize           | Serializes the draw command list of the frame
+ * \ref nk_command_deserializer_init   | Initializes a deserializer with an allocator
+ * \ref nk_command_deserializer_free   | Frees the memory of a deserializer
+ * \ref nk_command_deserializer_font   | Gives an id the font it is drawn with
+ * \ref nk_command_deserializer_image  | Gives an id the image handle it is drawn with
+ * \ref nk_command_deserialize         | Turns a serialized frame into the draw command list of a context
+ */
+struct nk_command_serializer;
+struct nk_command_deserializer;
+
+/**
+ * # nk_command_serializer_init
+ * Initializes a serializer which allocates its buffers with `alloc`.
+ * `nk_command_serializer_init_default` uses the standard library instead.
+ *
+ * ```c
+ * void nk_command_serializer_init(struct nk_command_serializer*, const struct nk_allocator *alloc);
+ * ```
+ */
+#ifdef NK_INCLUDE_DEFAULT_ALLOCATOR
+NK_API void nk_command_serializer_init_default(struct nk_command_serializer*);
+#endif
+NK_API void nk_command_serializer_init(struct nk_command_serializer*, const struct nk_allocator*);
+NK_API void nk_command_serializer_free(struct nk_command_serializer*);
+
+/**
+ * # nk_command_serializer_reset
+ * Makes the next serialized frame a key frame that does not depend on the
+ * previous one, for a renderer that just connected or missed a frame.
+ *
+ * ```c
+ * void nk_command_serializer_reset(struct nk_command_serializer*);
+ * ```
+ */
+NK_API void nk_command_serializer_reset(struct nk_command_serializer*);
+
+/**
+ * # nk_command_serializer_font / nk_command_serializer_image
+ * Registers the id a font or an image handle is sent as. Registering a font
+ * or handle again changes its id. Frames drawing with a font or image that
+ * is not registered are not serialized.
+ *
+ * ```c
+ * nk_bool nk_command_serializer_font(struct nk_command_serializer*, const struct nk_user_font*, nk_uint id);
+ * nk_bool nk_command_serializer_image(struct nk_command_serializer*, nk_handle, nk_uint id);
+ * ```
+ *
+ * \returns `nk_false` if `NK_COMMAND_SERIAL_FONTS` or `NK_COMMAND_SERIAL_IMAGES` ids are registered already.
+ */
+NK_API nk_bool nk_command_serializer_font(struct nk_command_serializer*, const struct nk_user_font*, nk_uint id);
+NK_API nk_bool nk_command_serializer_image(struct nk_command_serializer*, nk_handle, nk_uint id);
+
+/**
+ * # nk_command_serialize
+ * Builds the frame like `nk__begin` if necessary and serializes its draw
+ * command list as the difference to the previously serialized frame.
+ *
+ * ```c
+ * const void* nk_command_serialize(struct nk_command_serializer*, struct nk_context*, nk_size *size);
+ * ```
+ *
+ * Parameter   | Description
+ * ------------|-----------------------------------------------------------
+ * \param[in] ser   | Serializer the frames of `ctx` are sent with
+ * \param[in] ctx   | Must point to an previously initialized `nk_context` struct at the end of a frame
+ * \param[out] size | Number of bytes in the returned frame
+ *
+ * \returns the frame, valid until the next call, or `0` if out of memory or
+ * a command uses a font or image that is not registered.
+ */
+NK_API const void* nk_command_serialize(struct nk_command_serializer*, struct nk_context*, nk_size *size);
+
+/**
+ * # nk_command_deserializer_init
+ * Initializes a deserializer which allocates its buffers with `alloc`.
+ * `nk_command_deserializer_init_default` uses the standard library instead.
+ *
+ * ```c
+ * void nk_command_deserializer_init(struct nk_command_deserializer*, const struct nk_allocator *alloc);
+ * ```
+ */
+#ifdef NK_INCLUDE_DEFAULT_ALLOCATOR
+NK_API void nk_command_deserializer_init_default(struct nk_command_deserializer*);
+#endif
+NK_API void nk_command_deserializer_init(struct nk_command_deserializer*, const struct nk_allocator*);
+NK_API void nk_command_deserializer_free(struct nk_command_deserializer*);
+
+/**
+ * # nk_command_deserializer_font / nk_command_deserializer_image
+ * Registers the font or image handle commands with the id are drawn with.
+ * Frames with font or image ids that are not registered are rejected.
+ *
+ * ```c
+ * nk_bool nk_command_deserializer_font(struct nk_command_deserializer*, nk_uint id, const struct nk_user_font*);
+ * nk_bool nk_command_deserializer_image(struct nk_command_deserializer*, nk_uint id, nk_handle);
+ * ```
+ *
+ * \returns `nk_false` if `NK_COMMAND_SERIAL_FONTS` or `NK_COMMAND_SERIAL_IMAGES` ids are registered already.
+ */
+NK_API nk_bool nk_command_deserializer_font(struct nk_command_deserializer*, nk_uint id, const struct nk_user_font*);
+NK_API nk_bool nk_command_deserializer_image(struct nk_command_deserializer*, nk_uint id, nk_handle);
+
+/**
+ * # nk_command_deserialize
+ * Checks a serialized frame and makes it the draw command list of `ctx`, to
+ * be iterated with `nk_foreach` and cleared with `nk_clear` like a frame built
+ * by the context itself. The context must not build windows of its own.
+ *
+ * ```c
+ * nk_bool nk_command_deserialize(struct nk_command_deserializer*, struct nk_context*, const void *frame, nk_size size);
+ * ```
+ *
+ * Parameter   | Description
+ * ------------|-----------------------------------------------------------
+ * \param[in] des   | Deserializer that applied the frames before
+ * \param[in] ctx   | Context that was cleared since its last frame
+ * \param[in] frame | Bytes returned by `nk_command_serialize`
+ * \param[in] size  | Number of bytes in `frame`
+ *
+ * \returns `nk_false` if the frame is malformed, uses an unknown font or image
+ * id, refers to a frame that was not applied, or memory ran out. The context
+ * has no commands then.
+ */
+NK_API nk_bool nk_command_deserialize(struct nk_command_deserializer*, struct nk_context*, const void *frame, nk_size size);
+
 #ifdef NK_INCLUDE_VERTEX_BUFFER_OUTPUT
 
 /**
@@ -3075,6 +3645,45 @@ struct nk_list_view {
 };
 NK_API nk_bool nk_list_view_begin(struct nk_context*, struct nk_list_view *out, const char *id, nk_flags, int row_height, int row_count);
 NK_API void nk_list_view_end(struct nk_list_view*);
+/* =============================================================================
+ *
+ *                                  CACHED REGION
+ *
+ * ============================================================================= */
+/**
+ * \page Cached Region
+ * A cached region records the draw commands of a static part of a window,
+ * like a settings page or a legend, and replays them in later frames
+ * without running the widget code again:
+ *
+ * ```c
+ * if (nk_cache_begin(ctx, nk_murmur_hash("legend", 6, 0), legend_version)) {
+ *     nk_layout_row_dynamic(ctx, 20, 1);
+ *     nk_label(ctx, "...", NK_TEXT_LEFT);
+ *     nk_cache_end(ctx);
+ * }
+ * ```
+ *
+ * The region is replayed when its key and version match the previous frame
+ * and the layout it starts in (panel bounds, clip, scrolling and row) is
+ * unchanged. Replaying copies the recorded commands and moves the layout
+ * cursor to where the region ended. The widgets run again whenever the
+ * mouse hovers or presses inside the region or the window receives keyboard
+ * input, so widgets inside keep reacting to input. Bump the version whenever
+ * the content or style changes. A region should start and end at a new
+ * layout row and must not open popups, combos or tooltips. Text inside is
+ * always copied into the recording, except for `nk_draw_text_ref` whose
+ * strings have to outlive the region. Regions begun while another one is
+ * recorded are executed and become part of the outer recording.
+ *
+ * # Reference
+ * Function            | Description
+ * --------------------|-------------------------------------------------------
+ * \ref nk_cache_begin  | Replays the region and returns `nk_false`, or starts recording it and returns `nk_true`
+ * \ref nk_cache_end    | Finishes recording; only call it if `nk_cache_begin` returned `nk_true`
+ */
+NK_API nk_bool nk_cache_begin(struct nk_context*, nk_hash key, nk_uint version);
+NK_API void nk_cache_end(struct nk_context*);
 /* =============================================================================
  *
  *                                  WIDGET
@@ -3127,6 +3736,29 @@ enum nk_text_alignment {
     NK_TEXT_CENTERED    = NK_TEXT_ALIGN_MIDDLE|NK_TEXT_ALIGN_CENTERED,
     NK_TEXT_RIGHT       = NK_TEXT_ALIGN_MIDDLE|NK_TEXT_ALIGN_RIGHT
 };
+
+/**
+ * \brief Makes text widgets of the current window reference their strings
+ * instead of copying them into the command buffer.
+ *
+ * \details
+ * Text drawn while enabled is pushed as `NK_COMMAND_TEXT_REF`, which stores
+ * a pointer, the length and a hash of the string. The caller guarantees the
+ * strings stay valid and unchanged until the frame has been drawn, which
+ * holds for string literals and most static menu or table text. Text the
+ * library formats itself, like `nk_labelf` or property values, is still
+ * copied. The setting lasts until it is changed again or the window ends.
+ *
+ * ```c
+ * nk_bool nk_set_text_ref(struct nk_context *ctx, nk_bool enable);
+ * ```
+ *
+ * \param[in] ctx     Must point to a previously initialized `nk_context` struct
+ * \param[in] enable  `nk_true` to reference text, `nk_false` to copy it again
+ *
+ * \returns the previous setting so it can be restored.
+ */
+NK_API nk_bool nk_set_text_ref(struct nk_context*, nk_bool enable);
 NK_API void nk_text(struct nk_context*, const char*, int, nk_flags);
 NK_API void nk_text_colored(struct nk_context*, const char*, int, nk_flags, struct nk_color);
 NK_API void nk_text_wrap(struct nk_context*, const char*, int);
@@ -3492,7 +4124,8 @@ enum nk_edit_flags {
     NK_EDIT_NO_HORIZONTAL_SCROLL    = NK_FLAG(8),
     NK_EDIT_ALWAYS_INSERT_MODE      = NK_FLAG(9),
     NK_EDIT_MULTILINE               = NK_FLAG(10),
-    NK_EDIT_GOTO_END_ON_ACTIVATE    = NK_FLAG(11)
+    NK_EDIT_GOTO_END_ON_ACTIVATE    = NK_FLAG(11),
+    NK_EDIT_WORD_WRAP               = NK_FLAG(12)
 };
 enum nk_edit_types {
     NK_EDIT_SIMPLE  = NK_EDIT_ALWAYS_INSERT_MODE,
@@ -3871,10 +4504,29 @@ NK_API const char* nk_utf_at(const char *buffer, int length, int index, nk_rune
  *     font.userdata.ptr = &your_font_class_or_struct;
  *     font.height = your_font_height;
  *     font.width = your_text_width_calculation;
+ *     font.advances = NULL;
  *
  *     struct nk_context ctx;
  *     nk_init_default(&ctx, &font);
  * ```
+ *
+ * Fitting and wrapping text needs the width of every prefix of a string,
+ * which would otherwise require one `width` call per glyph. If your font
+ * backend can lay out a whole run at once you can additionally provide an
+ * `advances` callback which writes the advance of each UTF-8 glyph of the
+ * string into the passed array (one float per glyph). Nuklear then queries
+ * runs in batches and fits text in linear time. Leave it `NULL` otherwise.
+ *
+ * ```c
+ *     void your_text_advances(nk_handle handle, float height, const char *text, int len, float *advances)
+ *     {
+ *         your_font_type *type = handle.ptr;
+ *         int i, glyphs = ...;
+ *         for (i = 0; i < glyphs; ++i)
+ *             advances[i] = ...;
+ *     }
+ *     font.advances = your_text_advances;
+ * ```
  * # Using your own implementation with vertex buffer output
  *
  * While the first approach works fine if you don't want to use the optional
@@ -3992,6 +4644,7 @@ NK_API const char* nk_utf_at(const char *buffer, int length, int index, nk_rune
 
 struct nk_user_font_glyph;
 typedef float(*nk_text_width_f)(nk_handle, float h, const char*, int len);
+typedef void(*nk_text_advances_f)(nk_handle, float h, const char*, int len, float *advances);
 typedef void(*nk_query_font_glyph_f)(nk_handle handle, float font_height,
                                     struct nk_user_font_glyph *glyph,
                                     nk_rune codepoint, nk_rune next_codepoint);
@@ -4009,6 +4662,7 @@ struct nk_user_font {
     nk_handle userdata;    /**!< user provided font handle */
     float height;          /**!< max height of the font */
     nk_text_width_f width; /**!< font string width in pixel callback */
+    nk_text_advances_f advances; /**!< optional callback writing the advance in pixel of every glyph in a string into `advances` (one float per UTF-8 glyph). Set to NULL if not supported */
 #ifdef NK_INCLUDE_VERTEX_BUFFER_OUTPUT
     nk_query_font_glyph_f query; /**!< font glyph callback to query drawing info */
     nk_handle texture;           /**!< texture handle to the used font atlas or texture */
@@ -4160,6 +4814,12 @@ NK_API void nk_font_atlas_clear(struct nk_font_atlas*);
  * NK_INCLUDE_DEFAULT_ALLOCATOR which uses the standard library memory
  * allocation functions malloc and free and takes over complete control over
  * memory in this library.
+ *
+ * With NK_INCLUDE_VIRTUAL_MEMORY a buffer can instead reserve a large address
+ * range up front and commit pages to it on demand (`nk_buffer_init_virtual`).
+ * Growing such a buffer never allocates a new block or copies memory, so
+ * pointers into it stay valid and a frame that suddenly needs more commands
+ * only pays for the pages it touches.
  */
 
 struct nk_memory_status {
@@ -4174,8 +4834,17 @@ struct nk_memory_status {
 enum nk_allocation_type {
     NK_BUFFER_FIXED,
     NK_BUFFER_DYNAMIC
+#ifdef NK_INCLUDE_VIRTUAL_MEMORY
+    ,NK_BUFFER_VIRTUAL
+#endif
 };
 
+#ifdef NK_INCLUDE_VIRTUAL_MEMORY
+#ifndef NK_BUFFER_VIRTUAL_COMMIT_SIZE
+#define NK_BUFFER_VIRTUAL_COMMIT_SIZE (64*1024) /* bytes committed at once, multiple of the page size */
+#endif
+#endif
+
 enum nk_buffer_allocation_type {
     NK_BUFFER_FRONT,
     NK_BUFFER_BACK,
@@ -4198,6 +4867,9 @@ struct nk_buffer {
     nk_size needed;               /**!< totally consumed memory given that enough memory is present */
     nk_size calls;                /**!< number of allocation calls */
     nk_size size;                 /**!< current size of the buffer */
+#ifdef NK_INCLUDE_VIRTUAL_MEMORY
+    nk_size committed[NK_BUFFER_MAX]; /**!< bytes committed at the front and back of a virtual buffer */
+#endif
 };
 
 #ifdef NK_INCLUDE_DEFAULT_ALLOCATOR
@@ -4205,6 +4877,9 @@ NK_API void nk_buffer_init_default(struct nk_buffer*);
 #endif
 NK_API void nk_buffer_init(struct nk_buffer*, const struct nk_allocator*, nk_size size);
 NK_API void nk_buffer_init_fixed(struct nk_buffer*, void *memory, nk_size size);
+#ifdef NK_INCLUDE_VIRTUAL_MEMORY
+NK_API nk_bool nk_buffer_init_virtual(struct nk_buffer*, nk_size reserve);
+#endif
 NK_API void nk_buffer_info(struct nk_memory_status*, const struct nk_buffer*);
 NK_API void nk_buffer_push(struct nk_buffer*, enum nk_buffer_allocation_type type, const void *memory, nk_size size, nk_size align);
 NK_API void nk_buffer_mark(struct nk_buffer*, enum nk_buffer_allocation_type type);
@@ -4225,9 +4900,27 @@ NK_API nk_size nk_buffer_total(const struct nk_buffer*);
  *  the default string handling method. The only instance you should have any contact
  *  with this API is if you interact with an `nk_text_edit` object inside one of the
  *  copy and paste functions and even there only for more advanced cases. */
+#ifdef NK_INCLUDE_STRING_INDEX
+#ifndef NK_STR_INDEX_SIZE
+#define NK_STR_INDEX_SIZE 64 /* number of rune to byte checkpoints kept per string */
+#endif
+#endif
 struct nk_str {
     struct nk_buffer buffer;
     int len; /**!< in codepoints/runes/glyphs */
+    nk_bool use_gap; /**!< keep a movable gap at the last edit position (gap buffer) */
+    int gap_begin;   /**!< byte offset of the gap inside `buffer` */
+    int gap_len;     /**!< size of the gap in bytes, zero if the text is contiguous */
+    int gap_rune;    /**!< number of runes in front of the gap */
+#ifdef NK_INCLUDE_STRING_INDEX
+    /* rune to byte checkpoints, so rune lookups in long text do not walk
+     * it from the start, at the cost of NK_STR_INDEX_SIZE ints per string */
+    int index[NK_STR_INDEX_SIZE]; /**!< byte offset of every `index_stride`th rune, built on demand */
+    int index_count;  /**!< number of valid entries in `index` */
+    int index_stride; /**!< runes between two entries, doubles whenever `index` runs full */
+    int index_len;    /**!< `len` the index was last validated against */
+    int index_bytes;  /**!< text size in bytes the index was last validated against */
+#endif
 };
 
 #ifdef NK_INCLUDE_DEFAULT_ALLOCATOR
@@ -4268,6 +4961,7 @@ NK_API const char *nk_str_at_const(const struct nk_str*, int pos, nk_rune *unico
 
 NK_API char *nk_str_get(struct nk_str*);
 NK_API const char *nk_str_get_const(const struct nk_str*);
+NK_API const char *nk_str_span(const struct nk_str*, int pos, int *len);
 NK_API int nk_str_len(const struct nk_str*);
 NK_API int nk_str_len_char(const struct nk_str*);
 
@@ -4300,6 +4994,50 @@ NK_API int nk_str_len_char(const struct nk_str*);
  * complexity I would not recommend editing gigabytes of data with it.
  * It is rather designed for uses cases which make sense for a GUI library not for
  * an full blown text editor.
+ *
+ * For larger documents `nk_textedit_set_gap_buffer` switches the string of a
+ * text editor to gap buffer storage. Inserts and deletes then happen inside a
+ * gap kept at the last edit position instead of moving the whole tail of the
+ * text for every glyph. Functions handing out a pointer to the rest of the
+ * text (`nk_str_get`, `nk_str_get_const`, `nk_str_at_char_const`, ...) close
+ * the gap first, which moves the text behind it. `nk_str_at_const` and
+ * `nk_str_rune_at` read a single rune and leave the gap in place. To read the
+ * text without closing the gap, `nk_str_span(str, pos, &len)` returns the text
+ * from byte `pos` on with `len` bytes of it in one piece, so
+ * `pos += len` steps to the next piece until it returns 0.
+ * Call it after one of the `nk_textedit_init_xxx` functions.
+ *
+ * Text editors with an allocator (`nk_textedit_init`, `nk_textedit_init_default`
+ * and `nk_edit_string` on a context with dynamic memory) keep a table of line
+ * starts and widths. Layout, hit testing and cursor movement read it instead
+ * of measuring the whole text every frame. Edits through the text editor
+ * mark the lines they touched, which are measured again. Text changed behind
+ * the editor's back is only noticed by its length in runes and bytes, and
+ * `nk_edit_string` also notices a different buffer. The table is then
+ * rebuilt. Text replaced outside of the editor by other text of the same
+ * length keeps the rows of the old text, so change it with the
+ * `nk_textedit_*` functions or hand `nk_edit_string` another buffer.
+ *
+ * Multi-line edit widgets with `NK_EDIT_WORD_WRAP` break lines at the last
+ * space that fits the widget width, or inside a word longer than a row. The
+ * soft breaks are kept as extra rows in the same line table, so an edit
+ * re-wraps only the rows it touched and resizing the widget rebuilds the
+ * table once. Word wrap needs the line table, and without an allocator rows
+ * only end at line breaks. Wrapped text does not scroll horizontally.
+ * `nk_edit_string` keeps one line table per widget in its window, so several
+ * edit widgets do not take turns rebuilding a shared one. A table is freed
+ * at the end of the first frame its widget was not built in.
+ *
+ * `nk_textedit_set_undo_journal` moves the undo history of a text editor with
+ * an allocator out of the fixed `undo_rec` and `undo_char` arrays into a
+ * journal that grows on demand up to `NK_TEXTEDIT_JOURNAL_ENTRIES` changes and
+ * `NK_TEXTEDIT_JOURNAL_SIZE` bytes of text. Consecutive typing is merged into
+ * one change, and dropping the oldest change once the journal is full does not
+ * move any memory. A change inserting more text than the journal holds can be
+ * undone but not redone, only one removing more than that ends the history
+ * since nothing before it can be undone. If every editor uses the journal,
+ * define both `NK_TEXTEDIT_UNDOSTATECOUNT` and `NK_TEXTEDIT_UNDOCHARCOUNT` as
+ * 1 to shrink `nk_text_edit`.
  */
 
 #ifndef NK_TEXTEDIT_UNDOSTATECOUNT
@@ -4310,6 +5048,14 @@ NK_API int nk_str_len_char(const struct nk_str*);
 #define NK_TEXTEDIT_UNDOCHARCOUNT      999
 #endif
 
+#ifndef NK_TEXTEDIT_JOURNAL_ENTRIES
+#define NK_TEXTEDIT_JOURNAL_ENTRIES    (1 << 14)
+#endif
+
+#ifndef NK_TEXTEDIT_JOURNAL_SIZE
+#define NK_TEXTEDIT_JOURNAL_SIZE       (1 << 20)
+#endif
+
 struct nk_text_edit;
 struct nk_clipboard {
     nk_handle userdata;
@@ -4319,11 +5065,33 @@ struct nk_clipboard {
 
 struct nk_text_undo_record {
    int where;
-   short insert_length;
-   short delete_length;
+   int insert_length;
+   int delete_length;
    short char_storage;
 };
 
+struct nk_text_undo_entry {
+    int where;          /**!< rune offset of the change */
+    int removed;        /**!< number of runes the change removed */
+    int inserted;       /**!< number of runes the change inserted */
+    int removed_bytes;  /**!< size of the removed text */
+    int inserted_bytes; /**!< size of the inserted text, negative while the entry is still open */
+    nk_size text;       /**!< journal offset of the removed text, followed by the inserted text */
+};
+
+struct nk_text_undo_journal {
+    struct nk_allocator pool;           /**!< allocator of the journal, the journal is off without one */
+    struct nk_text_undo_entry *entries; /**!< ring of `entry_cap` entries */
+    char *text;                         /**!< ring of `text_cap` bytes of UTF-8 text */
+    int entry_cap;
+    int text_cap;
+    int first;                          /**!< ring slot of the oldest entry */
+    int undo_count;                     /**!< number of entries that can be undone */
+    int redo_count;                     /**!< number of undone entries following them */
+    nk_size text_begin;                 /**!< journal offset of the oldest text still in use */
+    nk_size text_end;                   /**!< journal offset one past the newest text */
+};
+
 struct nk_text_undo_state {
    struct nk_text_undo_record undo_rec[NK_TEXTEDIT_UNDOSTATECOUNT];
    nk_rune undo_char[NK_TEXTEDIT_UNDOCHARCOUNT];
@@ -4331,6 +5099,7 @@ struct nk_text_undo_state {
    short redo_point;
    short undo_char_point;
    short redo_char_point;
+   struct nk_text_undo_journal journal;
 };
 
 enum nk_text_edit_type {
@@ -4344,6 +5113,23 @@ enum nk_text_edit_mode {
     NK_TEXT_EDIT_MODE_REPLACE
 };
 
+struct nk_text_edit_line {
+    int begin;   /**!< rune offset of the first glyph of the line */
+    float width; /**!< width of the line without the line break, negative if it needs measuring */
+};
+
+struct nk_text_edit_lines {
+    struct nk_buffer buffer;          /**!< array of `nk_text_edit_line`, only used if it has an allocator */
+    const struct nk_user_font *font;  /**!< font the widths were measured with */
+    float font_height;                /**!< font height the widths were measured with */
+    int count;                        /**!< number of lines, zero if the table has to be rebuilt */
+    int len;                          /**!< number of runes in the text the table describes */
+    int size;                         /**!< number of bytes in the text the table describes */
+    nk_bool dirty;                    /**!< some lines need to be measured again */
+    float wrap;                       /**!< width to wrap rows at, zero to only end rows at line breaks */
+    float wrapped;                    /**!< `wrap` the rows were built for */
+};
+
 struct nk_text_edit {
     struct nk_clipboard clip;
     struct nk_str string;
@@ -4362,6 +5148,7 @@ struct nk_text_edit {
     unsigned char padding1;
     float preferred_x;
     struct nk_text_undo_state undo;
+    struct nk_text_edit_lines lines;
 };
 
 /** filter function */
@@ -4380,6 +5167,8 @@ NK_API void nk_textedit_init_default(struct nk_text_edit*);
 NK_API void nk_textedit_init(struct nk_text_edit*, const struct nk_allocator*, nk_size size);
 NK_API void nk_textedit_init_fixed(struct nk_text_edit*, void *memory, nk_size size);
 NK_API void nk_textedit_free(struct nk_text_edit*);
+NK_API void nk_textedit_set_gap_buffer(struct nk_text_edit*, nk_bool enable);
+NK_API void nk_textedit_set_undo_journal(struct nk_text_edit*, nk_bool enable);
 NK_API void nk_textedit_text(struct nk_text_edit*, const char*, int total_len);
 NK_API void nk_textedit_delete(struct nk_text_edit*, int where, int len);
 NK_API void nk_textedit_delete_selection(struct nk_text_edit*);
@@ -4462,7 +5251,8 @@ enum nk_command_type {
     NK_COMMAND_POLYLINE,
     NK_COMMAND_TEXT,
     NK_COMMAND_IMAGE,
-    NK_COMMAND_CUSTOM
+    NK_COMMAND_CUSTOM,
+    NK_COMMAND_TEXT_REF
 };
 
  /** command base and header of every command inside the buffer */
@@ -4626,17 +5416,34 @@ struct nk_command_text {
     char string[2];
 };
 
+/** text command that points at a string the caller keeps unchanged until the frame is drawn */
+struct nk_command_text_ref {
+    struct nk_command header;
+    const struct nk_user_font *font;
+    struct nk_color background;
+    struct nk_color foreground;
+    short x, y;
+    unsigned short w, h;
+    float height;
+    int length;
+    nk_hash hash; /**!< hash of the referenced bytes so equal commands mean equal text */
+    const char *string;
+};
+
 enum nk_command_clipping {
     NK_CLIPPING_OFF = nk_false,
     NK_CLIPPING_ON = nk_true
 };
 
+struct nk_text_cache;
 struct nk_command_buffer {
     struct nk_buffer *base;
     struct nk_rect clip;
     int use_clipping;
+    int use_text_ref; /**!< text is pushed as `NK_COMMAND_TEXT_REF` instead of being copied */
     nk_handle userdata;
     nk_size begin, end, last;
+    struct nk_text_cache *text_cache; /**!< optional context text cache used by text widgets */
 };
 
 /** shape outlines */
@@ -4661,6 +5468,7 @@ NK_API void nk_fill_polygon(struct nk_command_buffer*, const float *points, int
 NK_API void nk_draw_image(struct nk_command_buffer*, struct nk_rect, const struct nk_image*, struct nk_color);
 NK_API void nk_draw_nine_slice(struct nk_command_buffer*, struct nk_rect, const struct nk_nine_slice*, struct nk_color);
 NK_API void nk_draw_text(struct nk_command_buffer*, struct nk_rect, const char *text, int len, const struct nk_user_font*, struct nk_color, struct nk_color);
+NK_API void nk_draw_text_ref(struct nk_command_buffer*, struct nk_rect, const char *text, int len, const struct nk_user_font*, struct nk_color, struct nk_color);
 NK_API void nk_push_scissor(struct nk_command_buffer*, struct nk_rect);
 NK_API void nk_push_custom(struct nk_command_buffer*, struct nk_rect, nk_command_custom_callback, nk_handle usr);
 
@@ -5525,6 +6333,15 @@ struct nk_edit_state {
     unsigned char single_line;
 };
 
+/** line table of one `nk_edit_string` widget, kept by its window */
+struct nk_edit_lines {
+    nk_hash name;     /**!< id of the widget, its position among the edit widgets of the window */
+    unsigned int seq; /**!< context `seq` of the last frame the widget was built in */
+    const char *memory; /**!< buffer the widget edited in that frame */
+    struct nk_text_edit_lines lines;
+    struct nk_edit_lines *next;
+};
+
 struct nk_property_state {
     int active, prev;
     char buffer[NK_MAX_NUMBER_BUFFER];
@@ -5554,13 +6371,17 @@ struct nk_window {
     struct nk_property_state property;
     struct nk_popup_state popup;
     struct nk_edit_state edit;
+    struct nk_edit_lines *edit_lines; /**!< line tables of the `nk_edit_string` widgets */
     unsigned int scrolled;
     nk_bool widgets_disabled;
 
-    struct nk_table *tables;
+    struct nk_table *tables;       /**!< tables used since the last `nk_clear` */
+    struct nk_table *stale_tables; /**!< tables not used since, freed by the next `nk_clear` */
     unsigned int table_count;
+    struct nk_table_index *table_index;
 
     /* window list hooks */
+    int z; /**!< position in the window list when the window grid was last built */
     struct nk_window *next;
     struct nk_window *prev;
     struct nk_window *parent;
@@ -5675,8 +6496,34 @@ struct nk_table {
     struct nk_table *next, *prev;
 };
 
+/* Hash index over the value pages of a window. Values never move once
+ * added, so pointers returned by `nk_add_value`/`nk_find_value` stay valid
+ * for the frame while the index is grown and rehashed. Each slot references
+ * a value by page and position, and the slots are spread over page elements
+ * listed in `nk_table_index`. */
+#define NK_TABLE_INDEX_PAGE_SLOTS \
+    (sizeof(struct nk_table) / (sizeof(struct nk_table*) + sizeof(nk_byte)))
+#define NK_TABLE_INDEX_MAX_PAGES \
+    ((sizeof(struct nk_table) - 3 * sizeof(unsigned int)) / sizeof(void*))
+NK_STATIC_ASSERT(NK_VALUE_PAGE_CAPACITY <= 255);
+
+struct nk_table_index_page {
+    struct nk_table *tables[NK_TABLE_INDEX_PAGE_SLOTS]; /**!< value page or zero if the slot is empty */
+    nk_byte entries[NK_TABLE_INDEX_PAGE_SLOTS];         /**!< position inside the value page */
+};
+
+struct nk_table_index {
+    unsigned int count;      /**!< values in the slots */
+    unsigned int unindexed;  /**!< values that did not fit into the slots */
+    unsigned int page_count;
+    struct nk_table_index_page *pages[NK_TABLE_INDEX_MAX_PAGES];
+};
+
 union nk_page_data {
     struct nk_table tbl;
+    struct nk_table_index idx;
+    struct nk_table_index_page idx_page;
+    struct nk_edit_lines lines;
     struct nk_panel pan;
     struct nk_window win;
 };
@@ -5704,6 +6551,220 @@ struct nk_pool {
     nk_size cap;
 };
 
+/** memoized text measurements shared by all windows of a context with an
+ * allocator. The cache starts with NK_TEXT_CACHE_SIZE entries and doubles at
+ * the end of a frame that evicted too many entries it used, up to
+ * NK_TEXT_CACHE_MAX_SIZE. Each entry keeps a copy of its text, which is
+ * compared on a hit. */
+#ifndef NK_TEXT_CACHE_SIZE
+#define NK_TEXT_CACHE_SIZE 64 /* entries to start with, must be a power of two */
+#endif
+
+#ifndef NK_TEXT_CACHE_MAX_SIZE
+#define NK_TEXT_CACHE_MAX_SIZE 4096 /* entries the cache grows to at most, must be a power of two */
+#endif
+
+#ifndef NK_TEXT_CACHE_GROW_RATIO
+#define NK_TEXT_CACHE_GROW_RATIO 16 /* grow once more than one in this many lookups of a frame evict a recently used entry */
+#endif
+
+#ifndef NK_TEXT_CACHE_MAX_LINES
+#define NK_TEXT_CACHE_MAX_LINES 256 /* line breaks kept per paragraph, later lines are wrapped every frame */
+#endif
+
+enum nk_text_cache_kind {
+    NK_TEXT_CACHE_LABEL, /**!< full width and clamped length of a single line label */
+    NK_TEXT_CACHE_WRAP   /**!< line breaks of a wrapped paragraph */
+};
+
+struct nk_text_cache_entry {
+    const struct nk_user_font *font;
+    float font_height;
+    nk_hash hash;    /**!< hash of the text content */
+    int len;         /**!< text length in bytes */
+    int kind;        /**!< `nk_text_cache_kind` */
+    nk_uint stamp;   /**!< last access, used to pick an entry to evict */
+    float width;     /**!< full text width or negative if not measured yet */
+    float space;     /**!< available width the fitting/lines were computed for */
+    int fitting;     /**!< bytes fitting into `space` */
+    int line_count;  /**!< number of valid entries in `lines` and `line_widths` */
+    int line_capacity; /**!< number of entries `lines` and `line_widths` have room for */
+    char *text;      /**!< copy of the text, followed by `lines` and `line_widths` in the same block */
+    int *lines;
+    float *line_widths;
+};
+
+struct nk_text_cache {
+    struct nk_allocator alloc; /**!< no caching without an allocator */
+    struct nk_text_cache_entry *entries;
+    int capacity;    /**!< number of `entries`, zero until the first lookup */
+    nk_uint stamp;
+    nk_uint frame;   /**!< `stamp` at the start of the current frame */
+    nk_uint last_frame; /**!< `stamp` at the start of the last frame */
+    int conflicts;   /**!< entries of this or the last frame evicted in this frame */
+};
+
+/** hash index over the window list used by `nk_find_window` */
+#ifndef NK_WINDOW_INDEX_SIZE
+#define NK_WINDOW_INDEX_SIZE 512 /* number of slots, must be a power of two */
+#endif
+
+struct nk_window_index {
+    struct nk_window *slots[NK_WINDOW_INDEX_SIZE]; /**!< open addressing, probed linearly from the window name hash */
+    int count;     /**!< number of windows in `slots` */
+    int unindexed; /**!< windows in the list that did not fit into `slots` */
+};
+
+/** uniform grid over the window bounds used to find overlapping windows */
+#ifndef NK_WINDOW_GRID_CELL_SIZE
+#define NK_WINDOW_GRID_CELL_SIZE 64 /* smallest cell edge in pixels */
+#endif
+#ifndef NK_WINDOW_GRID_CELLS
+#define NK_WINDOW_GRID_CELLS 1024 /* most cells, larger cells are used beyond */
+#endif
+
+struct nk_window_grid {
+    unsigned int seq; /**!< frame the grid memory was taken from the frame arena in */
+    nk_bool valid;    /**!< cleared whenever window bounds or order change */
+    float x, y;       /**!< origin of the first cell */
+    float cell;       /**!< cell edge, `0` if windows are searched linearly */
+    float header;     /**!< height assumed for minimized windows */
+    int cols, rows;
+    int *starts;      /**!< `cols*rows + 1` offsets into `entries` */
+    struct nk_window **entries; /**!< windows overlapping each cell with ascending `z` */
+    struct nk_window **popups;  /**!< windows owning a popup with ascending `z` */
+    int popup_count;
+    nk_size capacity; /**!< bytes at `starts` */
+};
+
+/** linear scratch memory handed out by `nk_frame_alloc` until `nk_clear` */
+#ifndef NK_FRAME_BLOCK_SIZE
+#define NK_FRAME_BLOCK_SIZE (4*1024) /* smallest block allocated for the arena */
+#endif
+
+#ifndef NK_FRAME_ALIGNMENT
+#define NK_FRAME_ALIGNMENT 16
+#endif
+
+struct nk_frame_block {
+    struct nk_frame_block *next;
+    nk_size size; /**!< usable bytes following the block header */
+};
+
+struct nk_frame_arena {
+    struct nk_allocator alloc;     /**!< block allocator, without callbacks for a fixed block */
+    struct nk_frame_block *blocks; /**!< block allocations come from, older blocks of the frame follow */
+    nk_size used;       /**!< bytes taken from the first block */
+    nk_size allocated;  /**!< bytes taken from all blocks this frame */
+    nk_size high_water; /**!< most bytes taken in a single frame */
+};
+
+/** state of `NK_COMMAND_ENCODING_COMPACT` */
+#define NK_COMMAND_PALETTE_SIZE 255
+#define NK_COMMAND_PALETTE_SLOTS 512
+
+#ifndef NK_COMMAND_INTERN_SIZE
+#define NK_COMMAND_INTERN_SIZE 32 /* distinct font and userdata pointers indexed per frame */
+#endif
+
+struct nk_command_encoder {
+    enum nk_command_encoding encoding;
+    struct nk_buffer stream;  /**!< compact encoding of the frame */
+    struct nk_buffer decoded; /**!< command last returned by `nk__begin`/`nk__next` */
+    nk_bool fallback;         /**!< encoding the frame failed, it is handed out raw instead */
+    struct nk_color palette[NK_COMMAND_PALETTE_SIZE];
+    unsigned short palette_slots[NK_COMMAND_PALETTE_SLOTS]; /**!< color hash to palette index + 1 */
+    int palette_count;
+    const void *pointers[NK_COMMAND_INTERN_SIZE];
+    int pointer_count;
+};
+
+/** state of `nk_command_serialize` and `nk_command_deserialize` */
+#ifndef NK_COMMAND_SERIAL_FONTS
+#define NK_COMMAND_SERIAL_FONTS 16 /* fonts with an id per (de)serializer */
+#endif
+#ifndef NK_COMMAND_SERIAL_IMAGES
+#define NK_COMMAND_SERIAL_IMAGES 64 /* image handles with an id per (de)serializer */
+#endif
+#ifndef NK_COMMAND_SERIAL_LOOKAHEAD
+#define NK_COMMAND_SERIAL_LOOKAHEAD 64 /* records of the previous frame searched for a changed command */
+#endif
+
+struct nk_command_serial_font {
+    const struct nk_user_font *font;
+    nk_uint id;
+};
+
+struct nk_command_serial_image {
+    nk_handle handle;
+    nk_uint id;
+};
+
+struct nk_command_serial_frame {
+    struct nk_buffer records; /**!< pointer free record of each command */
+    struct nk_buffer offsets; /**!< `nk_size` offset of each record and of their end */
+};
+
+struct nk_command_serializer {
+    struct nk_command_serial_frame frames[2]; /**!< previous and current frame */
+    int current;
+    struct nk_buffer stream; /**!< last serialized frame */
+    nk_uint seq;             /**!< number of the last serialized frame */
+    nk_bool key;             /**!< next frame does not refer to the previous one */
+    struct nk_command_serial_font fonts[NK_COMMAND_SERIAL_FONTS];
+    int font_count;
+    struct nk_command_serial_image images[NK_COMMAND_SERIAL_IMAGES];
+    int image_count;
+};
+
+struct nk_command_deserializer {
+    struct nk_command_serial_frame frames[2]; /**!< previous and current frame */
+    int current;
+    nk_uint seq; /**!< number of the last applied frame, `0` before the first */
+    nk_command_custom_callback custom; /**!< callback of deserialized custom commands */
+    struct nk_command_serial_font fonts[NK_COMMAND_SERIAL_FONTS];
+    int font_count;
+    struct nk_command_serial_image images[NK_COMMAND_SERIAL_IMAGES];
+    int image_count;
+};
+
+/*==============================================================
+ *                          CACHED REGION
+ * =============================================================*/
+#ifndef NK_CACHE_REGIONS
+#define NK_CACHE_REGIONS 16
+#endif
+
+struct nk_cache_layout {
+    nk_flags flags;
+    struct nk_rect bounds;
+    struct nk_rect clip;
+    struct nk_rect buffer_clip;
+    float at_x, at_y, max_x;
+    nk_uint offset_x, offset_y;
+    struct nk_row_layout row;
+};
+
+struct nk_cache_region {
+    nk_hash window;   /**!< name hash of the window the region belongs to */
+    nk_hash key;
+    nk_uint version;
+    unsigned int seq; /**!< frame the region was last recorded or replayed in */
+    struct nk_cache_layout begin;
+    struct nk_cache_layout end;
+    struct nk_rect bounds;     /**!< area covered by the region for input checks */
+    unsigned int property_seq; /**!< property ids used up inside the region */
+    unsigned int edit_seq;     /**!< edit ids used up inside the region */
+    int nested;           /**!< regions begun while recording this one */
+    int use_text_ref;     /**!< text reference setting of the window before recording */
+    nk_size begin_offset; /**!< command buffer offset while recording */
+    nk_size last;   /**!< last command relative to the first */
+    nk_size end_offset; /**!< aligned end of the commands relative to the first */
+    nk_size size;   /**!< bytes of recorded commands with `next` relative to the first */
+    nk_size capacity;
+    void *commands;
+};
+
 struct nk_context {
 /* public: can be accessed freely */
     struct nk_input input;
@@ -5714,6 +6775,8 @@ struct nk_context {
     enum nk_button_behavior button_behavior;
     struct nk_configuration_stacks stacks;
     float delta_time_seconds;
+    /** most window state tables `nk_clear` frees per frame, 0 for no limit */
+    nk_size gc_budget;
 
 /* private:
     should only be accessed if you
@@ -5731,6 +6794,25 @@ struct nk_context {
     struct nk_text_edit text_edit;
     /** draw buffer used for overlay drawing operation like cursor */
     struct nk_command_buffer overlay;
+    /** text fit and wrap results reused across frames */
+    struct nk_text_cache text_cache;
+    /** scratch memory for the frame being built */
+    struct nk_frame_arena frame;
+    /** alternative encoding of the draw command list */
+    struct nk_command_encoder encoder;
+    /** regions replayed by `nk_cache_begin` and the one being recorded */
+    struct nk_cache_region *regions;
+    struct nk_cache_region *recording;
+    /** contexts attached by `nk_attach_worker` for this frame and the
+     * range of commands in `memory` that belong to no window: copied from
+     * the workers by `nk_build` or written by `nk_command_deserialize` */
+    struct nk_context *workers;
+    struct nk_context *next_worker;
+    nk_size spliced_begin, spliced_end;
+    /** the one of this context and its workers that gets keyboard and text
+     * input, `0` for this context */
+    struct nk_context *keyboard;
+    nk_bool editing; /**!< had an active text field in the last frame */
 
     /** windows */
     int build;
@@ -5741,6 +6823,8 @@ struct nk_context {
     struct nk_window *active;
     struct nk_window *current;
     struct nk_page_element *freelist;
+    struct nk_window_index windows;
+    struct nk_window_grid grid;
     unsigned int count;
     unsigned int seq;
 };
@@ -14,6 +14,9 @@ extern "C"
 #define NK_INCLUDE_STANDARD_VARARGS
 #define NK_INCLUDE_STANDARD_LIB
 #define NK_INCLUDE_DEFAULT_ALLOCATOR
+// #define NK_INCLUDE_VIRTUAL_MEMORY
+// #define NK_INCLUDE_INPUT_QUEUE
+// #define NK_INCLUDE_STRING_INDEX
 // #define NK_INCLUDE_FONT_BAKING
 // #define NK_INCLUDE_DEFAULT_FONT
 // #define NK_INCLUDE_SOFTWARE_FONT
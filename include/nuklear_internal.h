@@ -13,6 +13,20 @@
 #define NK_BUFFER_DEFAULT_INITIAL_SIZE (4*1024)
 #endif
 
+#ifndef NK_STR_GAP_SIZE
+#define NK_STR_GAP_SIZE 64
+#endif
+
+#ifdef NK_INCLUDE_STRING_INDEX
+#ifndef NK_STR_INDEX_STRIDE
+#define NK_STR_INDEX_STRIDE 64
+#endif
+#endif
+
+#ifndef NK_TEXT_ADVANCE_BATCH
+#define NK_TEXT_ADVANCE_BATCH 128
+#endif
+
 /* standard library headers */
 #ifdef NK_INCLUDE_DEFAULT_ALLOCATOR
 #include <stdlib.h> /* malloc, free */
@@ -140,6 +154,7 @@ NK_LIB void* nk_memcopy(void *dst, const void *src, nk_size n);
 #define NK_MEMSET nk_memset
 NK_LIB void nk_memset(void *ptr, int c0, nk_size size);
 #endif
+NK_LIB void nk_simd_init(void);
 NK_LIB void nk_zero(void *ptr, nk_size size);
 NK_LIB char *nk_itoa(char *s, long n);
 NK_LIB int nk_string_float_limit(char *string, int prec);
@@ -149,6 +164,16 @@ NK_LIB char *nk_dtoa(char *s, double n);
 #endif
 NK_LIB int nk_text_clamp(const struct nk_user_font *font, const char *text, int text_len, float space, int *glyphs, float *text_width, nk_rune *sep_list, int sep_count);
 NK_LIB struct nk_vec2 nk_text_calculate_text_bounds(const struct nk_user_font *font, const char *begin, int byte_len, float row_height, const char **remaining, struct nk_vec2 *out_offset, int *glyphs, int op);
+struct nk_text_advancer {
+    const struct nk_user_font *font;
+    const char *text;
+    int len;
+    int pos; /* byte offset of the next buffered glyph */
+    int count, index;
+    float advances[NK_TEXT_ADVANCE_BATCH];
+};
+NK_LIB void nk_text_advancer_init(struct nk_text_advancer *a, const struct nk_user_font *font, const char *text, int len);
+NK_LIB float nk_text_advancer_next(struct nk_text_advancer *a, int offset, int glyph_len);
 #ifdef NK_INCLUDE_STANDARD_VARARGS
 NK_LIB int nk_strfmt(char *buf, int buf_size, const char *fmt, va_list args);
 #endif
@@ -156,6 +181,10 @@ NK_LIB int nk_strfmt(char *buf, int buf_size, const char *fmt, va_list args);
 NK_LIB char *nk_file_load(const char* path, nk_size* siz, const struct nk_allocator *alloc);
 #endif
 
+/* utf-8 */
+NK_LIB int nk_utf_ascii_len(const char *str, int len);
+NK_LIB int nk_utf_decode_run(const char *str, int len, nk_rune *runes, int max_runes, int *count);
+
 /* buffer */
 #ifdef NK_INCLUDE_DEFAULT_ALLOCATOR
 NK_LIB void* nk_malloc(nk_handle unused, void *old,nk_size size);
@@ -164,12 +193,21 @@ NK_LIB void nk_mfree(nk_handle unused, void *ptr);
 NK_LIB void* nk_buffer_align(void *unaligned, nk_size align, nk_size *alignment, enum nk_buffer_allocation_type type);
 NK_LIB void* nk_buffer_alloc(struct nk_buffer *b, enum nk_buffer_allocation_type type, nk_size size, nk_size align);
 NK_LIB void* nk_buffer_realloc(struct nk_buffer *b, nk_size capacity, nk_size *size);
+NK_LIB nk_size nk_buffer_trim(struct nk_buffer *b);
+
+/* string */
+NK_LIB void nk_str_close_gap(struct nk_str *s);
+NK_LIB int nk_str_decode_runes(const struct nk_str *s, int pos, nk_rune *runes, int count);
+NK_LIB int nk_str_copy_text(const struct nk_str *s, int pos, int count, char *dst);
+NK_LIB int nk_str_rune_offset(struct nk_str *s, int pos);
 
 /* draw */
 NK_LIB void nk_command_buffer_init(struct nk_command_buffer *cb, struct nk_buffer *b, enum nk_command_clipping clip);
 NK_LIB void nk_command_buffer_reset(struct nk_command_buffer *b);
 NK_LIB void* nk_command_buffer_push(struct nk_command_buffer* b, enum nk_command_type t, nk_size size);
 NK_LIB void nk_draw_symbol(struct nk_command_buffer *out, enum nk_symbol_type type, struct nk_rect content, struct nk_color background, struct nk_color foreground, float border_width, const struct nk_user_font *font);
+NK_LIB nk_bool nk_draw_culled(const struct nk_command_buffer *b, struct nk_rect r);
+NK_LIB void nk_draw_text_measured(struct nk_command_buffer *b, struct nk_rect r, const char *string, int length, const struct nk_user_font *font, float text_width, struct nk_color bg, struct nk_color fg);
 
 /* buffering */
 NK_LIB void nk_start_buffer(struct nk_context *ctx, struct nk_command_buffer *b);
@@ -179,12 +217,48 @@ NK_LIB void nk_finish_popup(struct nk_context *ctx, struct nk_window*);
 NK_LIB void nk_finish_buffer(struct nk_context *ctx, struct nk_command_buffer *b);
 NK_LIB void nk_finish(struct nk_context *ctx, struct nk_window *w);
 NK_LIB void nk_build(struct nk_context *ctx);
+NK_LIB const struct nk_command *nk_command_list_begin(const struct nk_context *ctx);
+NK_LIB const struct nk_command *nk_command_list_next(const struct nk_context *ctx, const struct nk_command *cmd);
+
+/* command encoding */
+union nk_command_any {
+    struct nk_command header;
+    struct nk_command_scissor scissor;
+    struct nk_command_line line;
+    struct nk_command_curve curve;
+    struct nk_command_rect rect;
+    struct nk_command_rect_filled rect_filled;
+    struct nk_command_rect_multi_color rect_multi_color;
+    struct nk_command_triangle triangle;
+    struct nk_command_triangle_filled triangle_filled;
+    struct nk_command_circle circle;
+    struct nk_command_circle_filled circle_filled;
+    struct nk_command_arc arc;
+    struct nk_command_arc_filled arc_filled;
+    struct nk_command_polygon polygon;
+    struct nk_command_polygon_filled polygon_filled;
+    struct nk_command_polyline polyline;
+    struct nk_command_image image;
+    struct nk_command_custom custom;
+    struct nk_command_text text;
+    struct nk_command_text_ref text_ref;
+};
+NK_LIB nk_byte *nk_command_put_uint(nk_byte *p, nk_uint v);
+NK_LIB nk_byte *nk_command_put_int(nk_byte *p, int v);
+NK_LIB nk_byte *nk_command_put_rect(nk_byte *p, short x, short y, unsigned short w, unsigned short h);
+NK_LIB nk_byte *nk_command_put_points(nk_byte *p, const struct nk_vec2i *points, int count);
+NK_LIB nk_bool nk_command_encode(struct nk_context *ctx);
+NK_LIB const struct nk_command *nk_command_decode(struct nk_context *ctx, nk_size offset);
 
 /* text editor */
 NK_LIB void nk_textedit_clear_state(struct nk_text_edit *state, enum nk_text_edit_type type, nk_plugin_filter filter);
 NK_LIB void nk_textedit_click(struct nk_text_edit *state, float x, float y, const struct nk_user_font *font, float row_height);
 NK_LIB void nk_textedit_drag(struct nk_text_edit *state, float x, float y, const struct nk_user_font *font, float row_height);
 NK_LIB void nk_textedit_key(struct nk_text_edit *state, enum nk_keys key, int shift_mod, const struct nk_user_font *font, float row_height);
+NK_LIB int nk_textedit_lines_sync(struct nk_text_edit *state, const struct nk_user_font *font);
+NK_LIB int nk_textedit_lines_find(const struct nk_text_edit *state, int pos);
+NK_LIB nk_bool nk_textedit_lines_wrapped(const struct nk_text_edit *state, int pos);
+NK_LIB float nk_textedit_measure(const struct nk_str *s, int begin, int end, const struct nk_user_font *font, int *glyphs, nk_bool *newline);
 
 /* window */
 enum nk_window_insert_location {
@@ -197,11 +271,25 @@ NK_LIB void nk_free_window(struct nk_context *ctx, struct nk_window *win);
 NK_LIB struct nk_window *nk_find_window(const struct nk_context *ctx, nk_hash hash, const char *name);
 NK_LIB void nk_insert_window(struct nk_context *ctx, struct nk_window *win, enum nk_window_insert_location loc);
 
+/* window grid */
+NK_LIB void nk_window_grid_invalidate(struct nk_context *ctx);
+NK_LIB struct nk_window *nk_window_grid_find(struct nk_context *ctx, const struct nk_window *above, struct nk_rect area, nk_bool point, float header_height);
+NK_LIB struct nk_window *nk_window_grid_find_popup(struct nk_context *ctx, const struct nk_window *above, const struct nk_window *below, struct nk_rect area, nk_bool point);
+NK_LIB nk_bool nk_window_grid_any(const struct nk_context *ctx, struct nk_rect area, nk_bool point, float header_height);
+
 /* pool */
 NK_LIB void nk_pool_init(struct nk_pool *pool, const struct nk_allocator *alloc, unsigned int capacity);
 NK_LIB void nk_pool_free(struct nk_pool *pool);
 NK_LIB void nk_pool_init_fixed(struct nk_pool *pool, void *memory, nk_size size);
 NK_LIB struct nk_page_element *nk_pool_alloc(struct nk_pool *pool);
+NK_LIB nk_size nk_pool_trim(struct nk_pool *pool, struct nk_page_element **freelist);
+
+/* frame */
+NK_LIB void nk_frame_reset(struct nk_frame_arena *arena);
+NK_LIB nk_size nk_frame_trim(struct nk_frame_arena *arena);
+
+/* cache */
+NK_LIB void nk_cache_free(struct nk_context *ctx);
 
 /* page-element */
 NK_LIB struct nk_page_element* nk_create_page_element(struct nk_context *ctx);
@@ -213,8 +301,12 @@ NK_LIB struct nk_table* nk_create_table(struct nk_context *ctx);
 NK_LIB void nk_remove_table(struct nk_window *win, struct nk_table *tbl);
 NK_LIB void nk_free_table(struct nk_context *ctx, struct nk_table *tbl);
 NK_LIB void nk_push_table(struct nk_window *win, struct nk_table *tbl);
+NK_LIB void nk_free_table_index(struct nk_context *ctx, struct nk_window *win);
 NK_LIB nk_uint *nk_add_value(struct nk_context *ctx, struct nk_window *win, nk_hash name, nk_uint value);
-NK_LIB nk_uint *nk_find_value(const struct nk_window *win, nk_hash name);
+NK_LIB nk_uint *nk_find_value(struct nk_window *win, nk_hash name);
+NK_LIB nk_size nk_collect_tables(struct nk_context *ctx, struct nk_window *win, nk_size budget);
+NK_LIB void nk_age_tables(struct nk_window *win);
+NK_LIB void nk_keep_tables(struct nk_window *win);
 
 /* panel */
 NK_LIB void *nk_create_panel(struct nk_context *ctx);
@@ -247,8 +339,16 @@ struct nk_text {
     struct nk_color text;
 };
 NK_LIB void nk_widget_text(struct nk_command_buffer *o, struct nk_rect b, const char *string, int len, const struct nk_text *t, nk_flags a, const struct nk_user_font *f);
+NK_LIB void nk_widget_text_measured(struct nk_command_buffer *o, struct nk_rect b, const char *string, int len, const struct nk_text *t, nk_flags a, const struct nk_user_font *f, float string_width, struct nk_text_cache_entry *cached);
 NK_LIB void nk_widget_text_wrap(struct nk_command_buffer *o, struct nk_rect b, const char *string, int len, const struct nk_text *t, const struct nk_user_font *f);
 
+/* text cache */
+NK_LIB void nk_text_cache_clear(struct nk_text_cache *cache);
+NK_LIB void nk_text_cache_free(struct nk_text_cache *cache);
+NK_LIB void nk_text_cache_frame(struct nk_text_cache *cache);
+NK_LIB struct nk_text_cache_entry *nk_text_cache_get(struct nk_text_cache *cache, const struct nk_user_font *font, const char *text, int len, enum nk_text_cache_kind kind);
+NK_LIB nk_bool nk_text_cache_push_line(struct nk_text_cache *cache, struct nk_text_cache_entry *e, int fitting, float width);
+
 /* button */
 NK_LIB nk_bool nk_button_behavior(nk_flags *state, struct nk_rect r, const struct nk_input *i, enum nk_button_behavior behavior);
 NK_LIB const struct nk_style_item* nk_draw_button(struct nk_command_buffer *out, const struct nk_rect *bounds, nk_flags state, const struct nk_style_button *style);
@@ -296,7 +396,9 @@ NK_LIB nk_bool nk_do_selectable(nk_flags *state, struct nk_command_buffer *out,
 NK_LIB nk_bool nk_do_selectable_image(nk_flags *state, struct nk_command_buffer *out, struct nk_rect bounds, const char *str, int len, nk_flags align, nk_bool *value, const struct nk_image *img, const struct nk_style_selectable *style, const struct nk_input *in, const struct nk_user_font *font);
 
 /* edit */
-NK_LIB void nk_edit_draw_text(struct nk_command_buffer *out, const struct nk_style_edit *style, float pos_x, float pos_y, float x_offset, const char *text, int byte_len, float row_height, const struct nk_user_font *font, struct nk_color background, struct nk_color foreground, nk_bool is_selected);
+NK_LIB struct nk_vec2 nk_edit_draw_text(struct nk_command_buffer *out, const struct nk_style_edit *style, float pos_x, float pos_y, float x_offset, const char *text, int byte_len, float row_height, const struct nk_user_font *font, struct nk_color background, struct nk_color foreground, nk_bool is_selected);
+NK_LIB void nk_collect_edit_lines(struct nk_context *ctx, struct nk_window *win);
+NK_LIB void nk_free_edit_lines(struct nk_context *ctx, struct nk_window *win);
 NK_LIB nk_flags nk_do_edit(nk_flags *state, struct nk_command_buffer *out, struct nk_rect bounds, nk_flags flags, nk_plugin_filter filter, struct nk_text_edit *edit, const struct nk_style_edit *style, struct nk_input *in, const struct nk_user_font *font);
 
 /* color-picker */
@@ -1,6 +1,26 @@
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+  #define _DEFAULT_SOURCE /* MAP_ANONYMOUS under strict -std=c* */
+#endif
 #include "nuklear.h"
 #include "nuklear_internal.h"
 
+#ifdef NK_INCLUDE_VIRTUAL_MEMORY
+  #ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+      #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+  #else
+    #include <sys/mman.h>
+    #if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+      #define MAP_ANONYMOUS MAP_ANON
+    #endif
+    #ifndef MAP_NORESERVE
+      #define MAP_NORESERVE 0
+    #endif
+  #endif
+#endif
+
 /* ==============================================================
  *
  *                          BUFFER
@@ -62,6 +82,116 @@ nk_buffer_init_fixed(struct nk_buffer *b, void *m, nk_size size)
     b->memory.size = size;
     b->size = size;
 }
+#ifdef NK_INCLUDE_VIRTUAL_MEMORY
+NK_INTERN void*
+nk_vm_reserve(nk_size size)
+{
+#ifdef _WIN32
+    return VirtualAlloc(0, size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    void *memory = mmap(0, size, PROT_NONE,
+        MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+    return (memory == MAP_FAILED) ? 0: memory;
+#endif
+}
+NK_INTERN nk_bool
+nk_vm_commit(void *memory, nk_size size)
+{
+#ifdef _WIN32
+    return VirtualAlloc(memory, size, MEM_COMMIT, PAGE_READWRITE) != 0;
+#else
+    return mprotect(memory, size, PROT_READ|PROT_WRITE) == 0;
+#endif
+}
+NK_INTERN void
+nk_vm_release(void *memory, nk_size size)
+{
+#ifdef _WIN32
+    NK_UNUSED(size);
+    VirtualFree(memory, 0, MEM_RELEASE);
+#else
+    munmap(memory, size);
+#endif
+}
+NK_INTERN void
+nk_vm_decommit(void *memory, nk_size size)
+{
+#ifdef _WIN32
+    VirtualFree(memory, size, MEM_DECOMMIT);
+#else
+    /* mapping fresh inaccessible pages over the range drops its contents */
+    mmap(memory, size, PROT_NONE, MAP_FIXED|MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+#endif
+}
+NK_INTERN nk_bool
+nk_buffer_commit(struct nk_buffer *b, enum nk_buffer_allocation_type type,
+    nk_size size)
+{
+    /* commit whole chunks from either end of the reserved range; pages that
+     * are already committed are never touched again until the buffer is freed */
+    nk_size committed = b->committed[type];
+    size = (size + NK_BUFFER_VIRTUAL_COMMIT_SIZE - 1) & ~(nk_size)(NK_BUFFER_VIRTUAL_COMMIT_SIZE - 1);
+    size = NK_MIN(size, b->memory.size);
+    if (size <= committed) return nk_true;
+    if (type == NK_BUFFER_FRONT) {
+        if (!nk_vm_commit(nk_ptr_add(void, b->memory.ptr, committed), size - committed))
+            return nk_false;
+    } else if (!nk_vm_commit(nk_ptr_add(void, b->memory.ptr, b->memory.size - size), size - committed))
+        return nk_false;
+    b->committed[type] = size;
+    return nk_true;
+}
+NK_INTERN nk_size
+nk_buffer_decommit(struct nk_buffer *b)
+{
+    /* keep the chunks in use; a chunk committed by both ends belongs to the
+     * back once the front gives it up, so never decommit past the other end */
+    const nk_size chunk = NK_BUFFER_VIRTUAL_COMMIT_SIZE;
+    nk_size released = 0;
+    nk_size front = (b->allocated + chunk - 1) & ~(nk_size)(chunk - 1);
+    nk_size back = (b->memory.size - b->size + chunk - 1) & ~(nk_size)(chunk - 1);
+
+    if (front < b->committed[NK_BUFFER_FRONT]) {
+        nk_size end = NK_MIN(b->committed[NK_BUFFER_FRONT],
+            b->memory.size - b->committed[NK_BUFFER_BACK]);
+        if (front < end) {
+            nk_vm_decommit(nk_ptr_add(void, b->memory.ptr, front), end - front);
+            released += end - front;
+        }
+        b->committed[NK_BUFFER_FRONT] = front;
+    }
+    if (back < b->committed[NK_BUFFER_BACK]) {
+        nk_size begin = NK_MAX(b->memory.size - b->committed[NK_BUFFER_BACK],
+            b->committed[NK_BUFFER_FRONT]);
+        nk_size end = b->memory.size - back;
+        if (begin < end) {
+            nk_vm_decommit(nk_ptr_add(void, b->memory.ptr, begin), end - begin);
+            released += end - begin;
+        }
+        b->committed[NK_BUFFER_BACK] = back;
+    }
+    return released;
+}
+NK_API nk_bool
+nk_buffer_init_virtual(struct nk_buffer *b, nk_size reserve)
+{
+    void *memory;
+    NK_ASSERT(b);
+    NK_ASSERT(reserve);
+    if (!b || !reserve) return 0;
+
+    reserve = (reserve + NK_BUFFER_VIRTUAL_COMMIT_SIZE - 1) & ~(nk_size)(NK_BUFFER_VIRTUAL_COMMIT_SIZE - 1);
+    memory = nk_vm_reserve(reserve);
+    if (!memory) return 0;
+
+    nk_zero(b, sizeof(*b));
+    b->type = NK_BUFFER_VIRTUAL;
+    b->memory.ptr = memory;
+    b->memory.size = reserve;
+    b->size = reserve;
+    return 1;
+}
+#endif
 NK_LIB void*
 nk_buffer_align(void *unaligned,
     nk_size align, nk_size *alignment,
@@ -166,8 +296,9 @@ nk_buffer_alloc(struct nk_buffer *b, enum nk_buffer_allocation_type type,
         /* buffer is full so allocate bigger buffer if dynamic */
         capacity = (nk_size)((float)b->memory.size * b->grow_factor);
         capacity = NK_MAX(capacity, nk_round_up_pow2((nk_uint)(b->allocated + size)));
-        b->memory.ptr = nk_buffer_realloc(b, capacity, &b->memory.size);
-        if (!b->memory.ptr) return 0;
+        memory = nk_buffer_realloc(b, capacity, &b->memory.size);
+        if (!memory) return 0; /* the old memory is still there */
+        b->memory.ptr = memory;
 
         /* align newly allocated pointer */
         if (type == NK_BUFFER_FRONT)
@@ -175,6 +306,12 @@ nk_buffer_alloc(struct nk_buffer *b, enum nk_buffer_allocation_type type,
         else unaligned = nk_ptr_add(void, b->memory.ptr, b->size - size);
         memory = nk_buffer_align(unaligned, align, &alignment, type);
     }
+#ifdef NK_INCLUDE_VIRTUAL_MEMORY
+    if (b->type == NK_BUFFER_VIRTUAL && !nk_buffer_commit(b, type,
+        (type == NK_BUFFER_FRONT) ? b->allocated + size + alignment:
+        b->memory.size - b->size + size + alignment))
+        return 0;
+#endif
     if (type == NK_BUFFER_FRONT)
         b->allocated += size + alignment;
     else b->size -= (size + alignment);
@@ -237,10 +374,29 @@ nk_buffer_free(struct nk_buffer *b)
     NK_ASSERT(b);
     if (!b || !b->memory.ptr) return;
     if (b->type == NK_BUFFER_FIXED) return;
+#ifdef NK_INCLUDE_VIRTUAL_MEMORY
+    if (b->type == NK_BUFFER_VIRTUAL) {
+        nk_vm_release(b->memory.ptr, b->memory.size);
+        b->memory.ptr = 0;
+        b->memory.size = 0;
+        return;
+    }
+#endif
     if (!b->pool.free) return;
     NK_ASSERT(b->pool.free);
     b->pool.free(b->pool.userdata, b->memory.ptr);
 }
+NK_LIB nk_size
+nk_buffer_trim(struct nk_buffer *b)
+{
+    NK_ASSERT(b);
+    if (!b || !b->memory.ptr) return 0;
+#ifdef NK_INCLUDE_VIRTUAL_MEMORY
+    if (b->type == NK_BUFFER_VIRTUAL)
+        return nk_buffer_decommit(b);
+#endif
+    return 0;
+}
 NK_API void
 nk_buffer_info(struct nk_memory_status *s, const struct nk_buffer *b)
 {
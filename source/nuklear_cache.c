@@ -0,0 +1,264 @@
+#include "nuklear.h"
+#include "nuklear_internal.h"
+
+/* ===============================================================
+ *
+ *                          CACHED REGIONS
+ *
+ * ===============================================================*/
+NK_INTERN void
+nk_cache_snapshot(struct nk_cache_layout *state, const struct nk_window *win)
+{
+    const struct nk_panel *layout = win->layout;
+    state->flags = layout->flags;
+    state->bounds = layout->bounds;
+    state->clip = layout->clip;
+    state->buffer_clip = win->buffer.clip;
+    state->at_x = layout->at_x;
+    state->at_y = layout->at_y;
+    state->max_x = layout->max_x;
+    state->offset_x = (layout->offset_x) ? *layout->offset_x: 0;
+    state->offset_y = (layout->offset_y) ? *layout->offset_y: 0;
+    state->row = layout->row;
+}
+NK_INTERN nk_bool
+nk_cache_rect_equal(struct nk_rect a, struct nk_rect b)
+{
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+NK_INTERN nk_bool
+nk_cache_snapshot_equal(const struct nk_cache_layout *a,
+    const struct nk_cache_layout *b)
+{
+    const struct nk_row_layout *r = &a->row;
+    const struct nk_row_layout *s = &b->row;
+    int i;
+
+    if (a->flags != b->flags || a->at_x != b->at_x || a->at_y != b->at_y ||
+        a->max_x != b->max_x || a->offset_x != b->offset_x ||
+        a->offset_y != b->offset_y || !nk_cache_rect_equal(a->bounds, b->bounds) ||
+        !nk_cache_rect_equal(a->clip, b->clip) ||
+        !nk_cache_rect_equal(a->buffer_clip, b->buffer_clip))
+        return nk_false;
+    if (r->type != s->type || r->index != s->index || r->height != s->height ||
+        r->min_height != s->min_height || r->columns != s->columns ||
+        r->ratio != s->ratio || r->item_width != s->item_width ||
+        r->item_height != s->item_height || r->item_offset != s->item_offset ||
+        r->filled != s->filled || r->tree_depth != s->tree_depth ||
+        !nk_cache_rect_equal(r->item, s->item))
+        return nk_false;
+    for (i = 0; i < NK_MAX_LAYOUT_ROW_TEMPLATE_COLUMNS; ++i)
+        if (r->templates[i] != s->templates[i]) return nk_false;
+    return nk_true;
+}
+NK_INTERN nk_bool
+nk_cache_input_inside(const struct nk_context *ctx, const struct nk_window *win,
+    struct nk_rect bounds)
+{
+    const struct nk_input *in = &ctx->input;
+    int i;
+
+    /* keyboard input goes to the active window */
+    if (win == ctx->active) {
+        if (in->keyboard.text_len) return nk_true;
+        for (i = 0; i < NK_KEY_MAX; ++i)
+            if (in->keyboard.keys[i].down || in->keyboard.keys[i].clicked)
+                return nk_true;
+    }
+    /* widgets inside change state on hover, on leaving hover and while
+     * a button press that started inside is held or released */
+    if (NK_INBOX(in->mouse.pos.x, in->mouse.pos.y, bounds.x, bounds.y, bounds.w, bounds.h) ||
+        NK_INBOX(in->mouse.prev.x, in->mouse.prev.y, bounds.x, bounds.y, bounds.w, bounds.h))
+        return nk_true;
+    for (i = 0; i < NK_BUTTON_MAX; ++i) {
+        const struct nk_mouse_button *btn = &in->mouse.buttons[i];
+        if ((btn->down || btn->clicked) && NK_INBOX(btn->clicked_pos.x,
+            btn->clicked_pos.y, bounds.x, bounds.y, bounds.w, bounds.h))
+            return nk_true;
+    }
+    return nk_false;
+}
+NK_INTERN struct nk_cache_region*
+nk_cache_find(struct nk_context *ctx, nk_hash window, nk_hash key)
+{
+    struct nk_cache_region *oldest;
+    int i;
+
+    if (!ctx->regions) {
+        nk_size size = sizeof(struct nk_cache_region) * NK_CACHE_REGIONS;
+        if (!ctx->frame.alloc.alloc) return 0;
+        ctx->regions = (struct nk_cache_region*)
+            ctx->frame.alloc.alloc(ctx->frame.alloc.userdata, 0, size);
+        if (!ctx->regions) return 0;
+        nk_zero(ctx->regions, size);
+    }
+    /* reuse the matching entry or the least recently used one */
+    oldest = &ctx->regions[0];
+    for (i = 0; i < NK_CACHE_REGIONS; ++i) {
+        struct nk_cache_region *region = &ctx->regions[i];
+        if (region->window == window && region->key == key)
+            return region;
+        if (region->seq < oldest->seq)
+            oldest = region;
+    }
+    oldest->window = window;
+    oldest->key = key;
+    oldest->seq = ctx->seq;
+    oldest->size = 0;
+    return oldest;
+}
+NK_INTERN nk_bool
+nk_cache_replay(struct nk_context *ctx, struct nk_window *win,
+    struct nk_cache_region *region)
+{
+    struct nk_panel *layout = win->layout;
+
+    if (region->size) {
+        nk_byte *memory;
+        nk_size begin, offset;
+
+        memory = (nk_byte*)nk_buffer_alloc(&ctx->memory, NK_BUFFER_FRONT,
+            region->size, NK_ALIGNOF(struct nk_command));
+        if (!memory) return nk_false;
+        NK_MEMCPY(memory, region->commands, region->size);
+
+        /* commands link to each other by absolute offsets, the recording
+         * keeps them relative to its first command */
+        begin = (nk_size)(memory - (nk_byte*)ctx->memory.memory.ptr);
+        offset = 0;
+        while (offset < region->end_offset) {
+            struct nk_command *cmd = (struct nk_command*)(memory + offset);
+            offset = cmd->next;
+            cmd->next = begin + offset;
+        }
+        win->buffer.last = begin + region->last;
+        win->buffer.end = begin + region->end_offset;
+    }
+    win->buffer.clip = region->end.buffer_clip;
+    layout->at_x = region->end.at_x;
+    layout->at_y = region->end.at_y;
+    layout->max_x = region->end.max_x;
+    layout->row = region->end.row;
+
+    /* keep ids and state of the skipped widgets alive */
+    win->property.seq += region->property_seq;
+    win->edit.seq += region->edit_seq;
+    nk_keep_tables(win);
+    region->seq = ctx->seq;
+    return nk_true;
+}
+NK_API nk_bool
+nk_cache_begin(struct nk_context *ctx, nk_hash key, nk_uint version)
+{
+    struct nk_cache_layout state;
+    struct nk_cache_region *region;
+    struct nk_window *win;
+
+    NK_ASSERT(ctx);
+    NK_ASSERT(ctx->current);
+    NK_ASSERT(ctx->current->layout);
+    if (!ctx || !ctx->current || !ctx->current->layout)
+        return nk_true;
+    if (ctx->recording) {
+        ctx->recording->nested++;
+        return nk_true;
+    }
+    win = ctx->current;
+    region = nk_cache_find(ctx, win->name, key);
+    if (!region) return nk_true;
+
+    nk_cache_snapshot(&state, win);
+    if (region->version == version && region->seq + 1 == ctx->seq &&
+        nk_cache_snapshot_equal(&state, &region->begin) &&
+        !nk_cache_input_inside(ctx, win, region->bounds) &&
+        nk_cache_replay(ctx, win, region))
+        return nk_false;
+
+    /* record the region while the caller runs it. Text is copied into the
+     * commands since referenced strings may be gone once it is replayed */
+    region->version = version;
+    region->begin = state;
+    region->begin_offset = win->buffer.end;
+    region->property_seq = win->property.seq;
+    region->edit_seq = win->edit.seq;
+    region->nested = 0;
+    region->use_text_ref = win->buffer.use_text_ref;
+    win->buffer.use_text_ref = nk_false;
+    ctx->recording = region;
+    return nk_true;
+}
+NK_API void
+nk_cache_end(struct nk_context *ctx)
+{
+    struct nk_cache_region *region;
+    struct nk_window *win;
+    nk_size size = 0;
+
+    NK_ASSERT(ctx);
+    NK_ASSERT(ctx->current);
+    if (!ctx || !ctx->current || !ctx->recording)
+        return;
+    region = ctx->recording;
+    if (region->nested) {
+        region->nested--;
+        return;
+    }
+    win = ctx->current;
+    ctx->recording = 0;
+    win->buffer.use_text_ref = region->use_text_ref;
+
+    if (win->buffer.end > region->begin_offset)
+        size = ctx->memory.allocated - region->begin_offset;
+    if (size > region->capacity) {
+        void *commands;
+        NK_ASSERT(ctx->frame.alloc.alloc);
+        commands = ctx->frame.alloc.alloc(ctx->frame.alloc.userdata,
+            region->commands, size);
+        if (!commands) {
+            nk_zero_struct(region->begin);
+            region->seq = 0;
+            return;
+        }
+        if (region->commands && ctx->frame.alloc.free)
+            ctx->frame.alloc.free(ctx->frame.alloc.userdata, region->commands);
+        region->commands = commands;
+        region->capacity = size;
+    }
+    region->size = size;
+    if (size) {
+        const nk_byte *memory = (const nk_byte*)ctx->memory.memory.ptr;
+        nk_size offset = 0;
+        NK_MEMCPY(region->commands, memory + region->begin_offset, size);
+        region->last = win->buffer.last - region->begin_offset;
+        region->end_offset = win->buffer.end - region->begin_offset;
+        while (offset < region->end_offset) {
+            struct nk_command *cmd = (struct nk_command*)((nk_byte*)region->commands + offset);
+            offset = cmd->next - region->begin_offset;
+            cmd->next = offset;
+        }
+    }
+    nk_cache_snapshot(&region->end, win);
+    region->property_seq = win->property.seq - region->property_seq;
+    region->edit_seq = win->edit.seq - region->edit_seq;
+    region->bounds.x = win->layout->bounds.x;
+    region->bounds.w = win->layout->bounds.w;
+    region->bounds.y = region->begin.at_y;
+    region->bounds.h = region->end.at_y + region->end.row.height - region->begin.at_y;
+    region->seq = ctx->seq;
+}
+NK_LIB void
+nk_cache_free(struct nk_context *ctx)
+{
+    int i;
+    NK_ASSERT(ctx);
+    if (!ctx) return;
+    ctx->recording = 0;
+    if (!ctx->regions) return;
+    if (ctx->frame.alloc.free) {
+        for (i = 0; i < NK_CACHE_REGIONS; ++i)
+            if (ctx->regions[i].commands)
+                ctx->frame.alloc.free(ctx->frame.alloc.userdata, ctx->regions[i].commands);
+        ctx->frame.alloc.free(ctx->frame.alloc.userdata, ctx->regions);
+    }
+    ctx->regions = 0;
+}
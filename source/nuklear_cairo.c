@@ -78,6 +78,47 @@ NK_INTERN float nk_cairo_text_width(nk_handle handle, float height, const char *
     return (float)w;
 }
 
+NK_INTERN void nk_cairo_text_advances(nk_handle handle, float height, const char *text, int len, float *advances)
+{
+    ENT();
+    struct nk_cairo_font *font = (struct nk_cairo_font*)handle.ptr;
+    int glyphs = nk_utf_len(text, len);
+    int n = 0;
+
+    // Lay out the whole run once and read back per character extents
+    PangoLayout *layout = pango_layout_new(font->pctx);
+    pango_layout_set_text(layout, text, len);
+    pango_layout_set_font_description(layout, font->desc);
+
+    PangoLayoutIter *iter = pango_layout_get_iter(layout);
+    do {
+        PangoRectangle rect;
+        pango_layout_iter_get_char_extents(iter, &rect);
+        advances[n++] = (float)abs(rect.width) / PANGO_SCALE;
+    } while (n < glyphs && pango_layout_iter_next_char(iter));
+    pango_layout_iter_free(iter);
+    g_object_unref(layout);
+
+    while (n < glyphs)
+        advances[n++] = 0.0f;
+    EXT();
+}
+
+NK_INTERN void nk_cairo_draw_text(cairo_t *cr, const struct nk_user_font *nkufont, struct nk_color color, short x, short y, const char *text, int len)
+{
+    const struct nk_cairo_font *font = (struct nk_cairo_font *)nkufont->userdata.ptr;
+    cairo_set_source_rgba(cr, NK_TO_CAIRO(color.r), NK_TO_CAIRO(color.g), NK_TO_CAIRO(color.b), NK_TO_CAIRO(color.a));
+
+    cairo_save(cr);
+    cairo_move_to(cr, x, y);
+    // Build Pango layout
+    PangoLayout *layout = pango_cairo_create_layout(cr);
+    pango_layout_set_text(layout, text, len);
+    pango_layout_set_font_description(layout,  font->desc);
+    pango_cairo_show_layout(cr, layout);
+    g_object_unref(layout);
+    cairo_restore(cr);
+}
 
 NK_API struct nk_user_font *nk_cairo_get_font(struct nk_cairo_context *cairo_ctx, const char *font_family, float font_size)
 {
@@ -110,6 +151,7 @@ NK_API struct nk_user_font *nk_cairo_get_font(struct nk_cairo_context *cairo_ctx
     font->nkufont.userdata = nk_handle_ptr(font);
     font->nkufont.height = font_size * 1.5f;
     font->nkufont.width = nk_cairo_text_width;
+    font->nkufont.advances = nk_cairo_text_advances;
 
     EXT();
     return &(font->nkufont);
@@ -125,6 +167,7 @@ NK_API void nk_cairo_put_font(struct nk_user_font *nkufont)
         font->desc = NULL;
         font->nkufont.userdata.ptr = NULL;
         font->nkufont.width = NULL;
+        font->nkufont.advances = NULL;
         free(font);
     } else  {
         nkufont->userdata.ptr = NULL;
@@ -253,10 +296,13 @@ NK_API bool nk_cairo_render(struct nk_cairo_context *cairo_ctx)
     ENT();
     struct nk_context *nk_ctx = cairo_ctx->nk_ctx;
     const struct nk_command *cmd = NULL;
-    void *cmds = nk_buffer_memory(&nk_ctx->memory);
+    nk_size size = 0;
+    /* compare the frame in the context's command encoding, which is far
+     * smaller than the command buffer with NK_COMMAND_ENCODING_COMPACT */
+    const void *cmds = nk_command_stream(nk_ctx, &size);
 
-    if (cairo_ctx->last_buffer_size != nk_ctx->memory.allocated) {
-        cairo_ctx->last_buffer_size = nk_ctx->memory.allocated;
+    if (cairo_ctx->last_buffer_size != size) {
+        cairo_ctx->last_buffer_size = size;
         cairo_ctx->last_buffer_addr = realloc(cairo_ctx->last_buffer_addr, cairo_ctx->last_buffer_size);
         memcpy(cairo_ctx->last_buffer_addr, cmds, cairo_ctx->last_buffer_size);
     }
@@ -484,21 +530,16 @@ NK_API bool nk_cairo_render(struct nk_cairo_context *cairo_ctx)
             break;
             case NK_COMMAND_TEXT: {
                 const struct nk_command_text *t = (const struct nk_command_text *)cmd;
-                const struct nk_cairo_font *font = (struct nk_cairo_font *)t->font->userdata.ptr;
-                cairo_set_source_rgba(cr, NK_TO_CAIRO(t->foreground.r), NK_TO_CAIRO(t->foreground.g), NK_TO_CAIRO(t->foreground.b), NK_TO_CAIRO(t->foreground.a));
-                
-                cairo_save(cr);
-                cairo_move_to(cr, t->x, t->y);
-                // Build Pango layout
-                PangoLayout *layout = pango_cairo_create_layout(cr);
-                pango_layout_set_text(layout, t->string, t->length);
-                pango_layout_set_font_description(layout,  font->desc);
-                pango_cairo_show_layout(cr, layout);
-                g_object_unref(layout);
-                cairo_restore(cr);
+                nk_cairo_draw_text(cr, t->font, t->foreground, t->x, t->y, t->string, t->length);
                 break;
             }
             break;
+        case NK_COMMAND_TEXT_REF:
+            {
+                const struct nk_command_text_ref *t = (const struct nk_command_text_ref *)cmd;
+                nk_cairo_draw_text(cr, t->font, t->foreground, t->x, t->y, t->string, t->length);
+            }
+            break;
         case NK_COMMAND_IMAGE:
             {
                 /* from https://github.com/taiwins/twidgets/blob/master/src/nk_wl_cairo.c */
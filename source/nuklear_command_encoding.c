@@ -0,0 +1,540 @@
+#include "nuklear.h"
+#include "nuklear_internal.h"
+
+/* ===============================================================
+ *
+ *                          COMMAND ENCODING
+ *
+ * ===============================================================*/
+/*  Every command is stored as its type byte followed by its fields:
+ *  coordinates and sizes as variable length integers (zigzag for signed
+ *  values), colors as a palette byte and font/userdata pointers as an intern
+ *  byte. Palette and intern byte 0 is followed by the literal value, which
+ *  also adds it to the table, any other byte N refers to entry N-1. Floats,
+ *  images and custom callbacks are copied as they are. The size of a record
+ *  follows from its fields, so there is no `next` offset to store. */
+#define NK_COMMAND_RECORD_SIZE (128 + sizeof(struct nk_image) + sizeof(nk_handle) + sizeof(nk_command_custom_callback))
+
+NK_LIB nk_byte*
+nk_command_put_uint(nk_byte *p, nk_uint v)
+{
+    while (v >= 0x80) {
+        *p++ = (nk_byte)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (nk_byte)v;
+    return p;
+}
+NK_LIB nk_byte*
+nk_command_put_int(nk_byte *p, int v)
+{
+    return nk_command_put_uint(p, ((nk_uint)v << 1) ^ (nk_uint)-(v < 0));
+}
+NK_INTERN nk_byte*
+nk_command_put_raw(nk_byte *p, const void *data, nk_size size)
+{
+    NK_MEMCPY(p, data, size);
+    return p + size;
+}
+NK_INTERN nk_byte*
+nk_command_put_color(struct nk_command_encoder *enc, nk_byte *p, struct nk_color c)
+{
+    nk_uint key = (nk_uint)c.r | (nk_uint)c.g << 8 | (nk_uint)c.b << 16 | (nk_uint)c.a << 24;
+    nk_uint slot = (key * 2654435761u) >> 23;
+    while (enc->palette_slots[slot]) {
+        const struct nk_color *e = &enc->palette[enc->palette_slots[slot]-1];
+        if (e->r == c.r && e->g == c.g && e->b == c.b && e->a == c.a) {
+            *p++ = (nk_byte)enc->palette_slots[slot];
+            return p;
+        }
+        slot = (slot + 1) & (NK_COMMAND_PALETTE_SLOTS-1);
+    }
+    if (enc->palette_count < NK_COMMAND_PALETTE_SIZE) {
+        enc->palette[enc->palette_count++] = c;
+        enc->palette_slots[slot] = (unsigned short)enc->palette_count;
+    }
+    *p++ = 0;
+    return nk_command_put_raw(p, &c, sizeof(c));
+}
+NK_INTERN nk_byte*
+nk_command_put_pointer(struct nk_command_encoder *enc, nk_byte *p, const void *ptr)
+{
+    int i;
+    for (i = 0; i < enc->pointer_count; ++i) {
+        if (enc->pointers[i] != ptr) continue;
+        *p++ = (nk_byte)(i + 1);
+        return p;
+    }
+    if (enc->pointer_count < NK_COMMAND_INTERN_SIZE)
+        enc->pointers[enc->pointer_count++] = ptr;
+    *p++ = 0;
+    return nk_command_put_raw(p, &ptr, sizeof(ptr));
+}
+NK_LIB nk_byte*
+nk_command_put_rect(nk_byte *p, short x, short y, unsigned short w, unsigned short h)
+{
+    p = nk_command_put_int(p, x);
+    p = nk_command_put_int(p, y);
+    p = nk_command_put_uint(p, w);
+    return nk_command_put_uint(p, h);
+}
+NK_LIB nk_byte*
+nk_command_put_points(nk_byte *p, const struct nk_vec2i *points, int count)
+{
+    int i;
+    for (i = 0; i < count; ++i) {
+        p = nk_command_put_int(p, points[i].x);
+        p = nk_command_put_int(p, points[i].y);
+    }
+    return p;
+}
+NK_INTERN nk_byte*
+nk_command_encode_one(struct nk_command_encoder *enc, nk_byte *p,
+    const struct nk_command *cmd)
+{
+    const union nk_command_any *c = (const union nk_command_any*)(const void*)cmd;
+    *p++ = (nk_byte)cmd->type;
+#ifdef NK_INCLUDE_COMMAND_USERDATA
+    p = nk_command_put_pointer(enc, p, cmd->userdata.ptr);
+#endif
+    switch (cmd->type) {
+    case NK_COMMAND_NOP: break;
+    case NK_COMMAND_SCISSOR:
+        p = nk_command_put_rect(p, c->scissor.x, c->scissor.y, c->scissor.w, c->scissor.h);
+        break;
+    case NK_COMMAND_LINE:
+        p = nk_command_put_uint(p, c->line.line_thickness);
+        p = nk_command_put_points(p, &c->line.begin, 1);
+        p = nk_command_put_points(p, &c->line.end, 1);
+        p = nk_command_put_color(enc, p, c->line.color);
+        break;
+    case NK_COMMAND_CURVE:
+        p = nk_command_put_uint(p, c->curve.line_thickness);
+        p = nk_command_put_points(p, &c->curve.begin, 1);
+        p = nk_command_put_points(p, &c->curve.end, 1);
+        p = nk_command_put_points(p, c->curve.ctrl, 2);
+        p = nk_command_put_color(enc, p, c->curve.color);
+        break;
+    case NK_COMMAND_RECT:
+        p = nk_command_put_uint(p, c->rect.rounding);
+        p = nk_command_put_uint(p, c->rect.line_thickness);
+        p = nk_command_put_rect(p, c->rect.x, c->rect.y, c->rect.w, c->rect.h);
+        p = nk_command_put_color(enc, p, c->rect.color);
+        break;
+    case NK_COMMAND_RECT_FILLED:
+        p = nk_command_put_uint(p, c->rect_filled.rounding);
+        p = nk_command_put_rect(p, c->rect_filled.x, c->rect_filled.y, c->rect_filled.w, c->rect_filled.h);
+        p = nk_command_put_color(enc, p, c->rect_filled.color);
+        break;
+    case NK_COMMAND_RECT_MULTI_COLOR:
+        p = nk_command_put_rect(p, c->rect_multi_color.x, c->rect_multi_color.y,
+            c->rect_multi_color.w, c->rect_multi_color.h);
+        p = nk_command_put_color(enc, p, c->rect_multi_color.left);
+        p = nk_command_put_color(enc, p, c->rect_multi_color.top);
+        p = nk_command_put_color(enc, p, c->rect_multi_color.bottom);
+        p = nk_command_put_color(enc, p, c->rect_multi_color.right);
+        break;
+    case NK_COMMAND_CIRCLE:
+        p = nk_command_put_uint(p, c->circle.line_thickness);
+        p = nk_command_put_rect(p, c->circle.x, c->circle.y, c->circle.w, c->circle.h);
+        p = nk_command_put_color(enc, p, c->circle.color);
+        break;
+    case NK_COMMAND_CIRCLE_FILLED:
+        p = nk_command_put_rect(p, c->circle_filled.x, c->circle_filled.y, c->circle_filled.w, c->circle_filled.h);
+        p = nk_command_put_color(enc, p, c->circle_filled.color);
+        break;
+    case NK_COMMAND_ARC:
+        p = nk_command_put_uint(p, c->arc.line_thickness);
+        p = nk_command_put_int(p, c->arc.cx);
+        p = nk_command_put_int(p, c->arc.cy);
+        p = nk_command_put_uint(p, c->arc.r);
+        p = nk_command_put_raw(p, c->arc.a, sizeof(c->arc.a));
+        p = nk_command_put_color(enc, p, c->arc.color);
+        break;
+    case NK_COMMAND_ARC_FILLED:
+        p = nk_command_put_int(p, c->arc_filled.cx);
+        p = nk_command_put_int(p, c->arc_filled.cy);
+        p = nk_command_put_uint(p, c->arc_filled.r);
+        p = nk_command_put_raw(p, c->arc_filled.a, sizeof(c->arc_filled.a));
+        p = nk_command_put_color(enc, p, c->arc_filled.color);
+        break;
+    case NK_COMMAND_TRIANGLE:
+        p = nk_command_put_uint(p, c->triangle.line_thickness);
+        p = nk_command_put_points(p, &c->triangle.a, 1);
+        p = nk_command_put_points(p, &c->triangle.b, 1);
+        p = nk_command_put_points(p, &c->triangle.c, 1);
+        p = nk_command_put_color(enc, p, c->triangle.color);
+        break;
+    case NK_COMMAND_TRIANGLE_FILLED:
+        p = nk_command_put_points(p, &c->triangle_filled.a, 1);
+        p = nk_command_put_points(p, &c->triangle_filled.b, 1);
+        p = nk_command_put_points(p, &c->triangle_filled.c, 1);
+        p = nk_command_put_color(enc, p, c->triangle_filled.color);
+        break;
+    case NK_COMMAND_POLYGON:
+    case NK_COMMAND_POLYLINE:
+        /* polygon and polyline share their layout */
+        p = nk_command_put_color(enc, p, c->polygon.color);
+        p = nk_command_put_uint(p, c->polygon.line_thickness);
+        p = nk_command_put_uint(p, c->polygon.point_count);
+        p = nk_command_put_points(p, c->polygon.points, c->polygon.point_count);
+        break;
+    case NK_COMMAND_POLYGON_FILLED:
+        p = nk_command_put_color(enc, p, c->polygon_filled.color);
+        p = nk_command_put_uint(p, c->polygon_filled.point_count);
+        p = nk_command_put_points(p, c->polygon_filled.points, c->polygon_filled.point_count);
+        break;
+    case NK_COMMAND_TEXT:
+        p = nk_command_put_pointer(enc, p, c->text.font);
+        p = nk_command_put_color(enc, p, c->text.background);
+        p = nk_command_put_color(enc, p, c->text.foreground);
+        p = nk_command_put_rect(p, c->text.x, c->text.y, c->text.w, c->text.h);
+        p = nk_command_put_raw(p, &c->text.height, sizeof(c->text.height));
+        p = nk_command_put_uint(p, (nk_uint)c->text.length);
+        p = nk_command_put_raw(p, c->text.string, (nk_size)c->text.length);
+        break;
+    case NK_COMMAND_TEXT_REF:
+        p = nk_command_put_pointer(enc, p, c->text_ref.font);
+        p = nk_command_put_color(enc, p, c->text_ref.background);
+        p = nk_command_put_color(enc, p, c->text_ref.foreground);
+        p = nk_command_put_rect(p, c->text_ref.x, c->text_ref.y, c->text_ref.w, c->text_ref.h);
+        p = nk_command_put_raw(p, &c->text_ref.height, sizeof(c->text_ref.height));
+        p = nk_command_put_uint(p, (nk_uint)c->text_ref.length);
+        p = nk_command_put_raw(p, &c->text_ref.hash, sizeof(c->text_ref.hash));
+        p = nk_command_put_raw(p, (const void*)&c->text_ref.string, sizeof(c->text_ref.string));
+        break;
+    case NK_COMMAND_IMAGE:
+        p = nk_command_put_rect(p, c->image.x, c->image.y, c->image.w, c->image.h);
+        p = nk_command_put_raw(p, &c->image.img, sizeof(c->image.img));
+        p = nk_command_put_color(enc, p, c->image.col);
+        break;
+    case NK_COMMAND_CUSTOM:
+        p = nk_command_put_rect(p, c->custom.x, c->custom.y, c->custom.w, c->custom.h);
+        p = nk_command_put_raw(p, &c->custom.callback_data, sizeof(c->custom.callback_data));
+        p = nk_command_put_raw(p, &c->custom.callback, sizeof(c->custom.callback));
+        break;
+    }
+    return p;
+}
+NK_LIB nk_bool
+nk_command_encode(struct nk_context *ctx)
+{
+    /* returns `nk_false` if the stream could not hold the whole frame */
+    struct nk_command_encoder *enc;
+    const struct nk_command *cmd;
+
+    NK_ASSERT(ctx);
+    if (!ctx) return nk_false;
+    enc = &ctx->encoder;
+    nk_buffer_clear(&enc->stream);
+    nk_zero(enc->palette_slots, sizeof(enc->palette_slots));
+    enc->palette_count = 0;
+    enc->pointer_count = 0;
+
+    for (cmd = nk_command_list_begin(ctx); cmd; cmd = nk_command_list_next(ctx, cmd)) {
+        /* reserve the largest record this command can take and give back
+         * what it did not use */
+        nk_size size = NK_COMMAND_RECORD_SIZE;
+        nk_byte *begin, *end;
+        if (cmd->type == NK_COMMAND_TEXT)
+            size += (nk_size)((const struct nk_command_text*)cmd)->length;
+        else if (cmd->type == NK_COMMAND_POLYGON || cmd->type == NK_COMMAND_POLYLINE ||
+            cmd->type == NK_COMMAND_POLYGON_FILLED)
+            size += 6 * (nk_size)(cmd->type == NK_COMMAND_POLYGON_FILLED ?
+                ((const struct nk_command_polygon_filled*)cmd)->point_count:
+                ((const struct nk_command_polygon*)cmd)->point_count);
+        begin = (nk_byte*)nk_buffer_alloc(&enc->stream, NK_BUFFER_FRONT, size, 1);
+        if (!begin) {
+            nk_buffer_clear(&enc->stream);
+            return nk_false;
+        }
+        end = nk_command_encode_one(enc, begin, cmd);
+        enc->stream.allocated -= size - (nk_size)(end - begin);
+        enc->stream.needed = enc->stream.allocated;
+    }
+    return nk_true;
+}
+
+NK_INTERN nk_uint
+nk_command_get_uint(const nk_byte **p)
+{
+    nk_uint v = 0;
+    int shift = 0;
+    nk_byte b;
+    do {
+        b = *(*p)++;
+        v |= (nk_uint)(b & 0x7F) << shift;
+        shift += 7;
+    } while ((b & 0x80) && shift < 32);
+    return v;
+}
+NK_INTERN int
+nk_command_get_int(const nk_byte **p)
+{
+    nk_uint v = nk_command_get_uint(p);
+    return (int)(v >> 1) ^ -(int)(v & 1);
+}
+NK_INTERN void
+nk_command_get_raw(const nk_byte **p, void *data, nk_size size)
+{
+    NK_MEMCPY(data, *p, size);
+    *p += size;
+}
+NK_INTERN struct nk_color
+nk_command_get_color(const struct nk_command_encoder *enc, const nk_byte **p)
+{
+    struct nk_color c;
+    nk_byte index = *(*p)++;
+    if (index) return enc->palette[index-1];
+    nk_command_get_raw(p, &c, sizeof(c));
+    return c;
+}
+NK_INTERN const void*
+nk_command_get_pointer(const struct nk_command_encoder *enc, const nk_byte **p)
+{
+    const void *ptr;
+    nk_byte index = *(*p)++;
+    if (index) return enc->pointers[index-1];
+    nk_command_get_raw(p, (void*)&ptr, sizeof(ptr));
+    return ptr;
+}
+NK_INTERN void
+nk_command_get_rect(const nk_byte **p, short *x, short *y, unsigned short *w, unsigned short *h)
+{
+    *x = (short)nk_command_get_int(p);
+    *y = (short)nk_command_get_int(p);
+    *w = (unsigned short)nk_command_get_uint(p);
+    *h = (unsigned short)nk_command_get_uint(p);
+}
+NK_INTERN void
+nk_command_get_points(const nk_byte **p, struct nk_vec2i *points, int count)
+{
+    int i;
+    for (i = 0; i < count; ++i) {
+        points[i].x = (short)nk_command_get_int(p);
+        points[i].y = (short)nk_command_get_int(p);
+    }
+}
+NK_LIB const struct nk_command*
+nk_command_decode(struct nk_context *ctx, nk_size offset)
+{
+    NK_STORAGE const nk_size align = NK_ALIGNOF(union nk_command_any);
+    struct nk_command_encoder *enc;
+    union nk_command_any c;
+    const nk_byte *p;
+    const void *tail = 0;
+    nk_size size = 0, tail_size = 0;
+    union nk_command_any *out;
+
+    NK_ASSERT(ctx);
+    if (!ctx) return 0;
+    enc = &ctx->encoder;
+    if (offset >= enc->stream.allocated) return 0;
+
+    p = (const nk_byte*)enc->stream.memory.ptr + offset;
+    nk_zero_struct(c);
+    c.header.type = (enum nk_command_type)*p++;
+#ifdef NK_INCLUDE_COMMAND_USERDATA
+    c.header.userdata.ptr = (void*)nk_command_get_pointer(enc, &p);
+#endif
+    switch (c.header.type) {
+    case NK_COMMAND_NOP: size = sizeof(c.header); break;
+    case NK_COMMAND_SCISSOR:
+        nk_command_get_rect(&p, &c.scissor.x, &c.scissor.y, &c.scissor.w, &c.scissor.h);
+        size = sizeof(c.scissor);
+        break;
+    case NK_COMMAND_LINE:
+        c.line.line_thickness = (unsigned short)nk_command_get_uint(&p);
+        nk_command_get_points(&p, &c.line.begin, 1);
+        nk_command_get_points(&p, &c.line.end, 1);
+        c.line.color = nk_command_get_color(enc, &p);
+        size = sizeof(c.line);
+        break;
+    case NK_COMMAND_CURVE:
+        c.curve.line_thickness = (unsigned short)nk_command_get_uint(&p);
+        nk_command_get_points(&p, &c.curve.begin, 1);
+        nk_command_get_points(&p, &c.curve.end, 1);
+        nk_command_get_points(&p, c.curve.ctrl, 2);
+        c.curve.color = nk_command_get_color(enc, &p);
+        size = sizeof(c.curve);
+        break;
+    case NK_COMMAND_RECT:
+        c.rect.rounding = (unsigned short)nk_command_get_uint(&p);
+        c.rect.line_thickness = (unsigned short)nk_command_get_uint(&p);
+        nk_command_get_rect(&p, &c.rect.x, &c.rect.y, &c.rect.w, &c.rect.h);
+        c.rect.color = nk_command_get_color(enc, &p);
+        size = sizeof(c.rect);
+        break;
+    case NK_COMMAND_RECT_FILLED:
+        c.rect_filled.rounding = (unsigned short)nk_command_get_uint(&p);
+        nk_command_get_rect(&p, &c.rect_filled.x, &c.rect_filled.y, &c.rect_filled.w, &c.rect_filled.h);
+        c.rect_filled.color = nk_command_get_color(enc, &p);
+        size = sizeof(c.rect_filled);
+        break;
+    case NK_COMMAND_RECT_MULTI_COLOR:
+        nk_command_get_rect(&p, &c.rect_multi_color.x, &c.rect_multi_color.y,
+            &c.rect_multi_color.w, &c.rect_multi_color.h);
+        c.rect_multi_color.left = nk_command_get_color(enc, &p);
+        c.rect_multi_color.top = nk_command_get_color(enc, &p);
+        c.rect_multi_color.bottom = nk_command_get_color(enc, &p);
+        c.rect_multi_color.right = nk_command_get_color(enc, &p);
+        size = sizeof(c.rect_multi_color);
+        break;
+    case NK_COMMAND_CIRCLE:
+        c.circle.line_thickness = (unsigned short)nk_command_get_uint(&p);
+        nk_command_get_rect(&p, &c.circle.x, &c.circle.y, &c.circle.w, &c.circle.h);
+        c.circle.color = nk_command_get_color(enc, &p);
+        size = sizeof(c.circle);
+        break;
+    case NK_COMMAND_CIRCLE_FILLED:
+        nk_command_get_rect(&p, &c.circle_filled.x, &c.circle_filled.y, &c.circle_filled.w, &c.circle_filled.h);
+        c.circle_filled.color = nk_command_get_color(enc, &p);
+        size = sizeof(c.circle_filled);
+        break;
+    case NK_COMMAND_ARC:
+        c.arc.line_thickness = (unsigned short)nk_command_get_uint(&p);
+        c.arc.cx = (short)nk_command_get_int(&p);
+        c.arc.cy = (short)nk_command_get_int(&p);
+        c.arc.r = (unsigned short)nk_command_get_uint(&p);
+        nk_command_get_raw(&p, c.arc.a, sizeof(c.arc.a));
+        c.arc.color = nk_command_get_color(enc, &p);
+        size = sizeof(c.arc);
+        break;
+    case NK_COMMAND_ARC_FILLED:
+        c.arc_filled.cx = (short)nk_command_get_int(&p);
+        c.arc_filled.cy = (short)nk_command_get_int(&p);
+        c.arc_filled.r = (unsigned short)nk_command_get_uint(&p);
+        nk_command_get_raw(&p, c.arc_filled.a, sizeof(c.arc_filled.a));
+        c.arc_filled.color = nk_command_get_color(enc, &p);
+        size = sizeof(c.arc_filled);
+        break;
+    case NK_COMMAND_TRIANGLE:
+        c.triangle.line_thickness = (unsigned short)nk_command_get_uint(&p);
+        nk_command_get_points(&p, &c.triangle.a, 1);
+        nk_command_get_points(&p, &c.triangle.b, 1);
+        nk_command_get_points(&p, &c.triangle.c, 1);
+        c.triangle.color = nk_command_get_color(enc, &p);
+        size = sizeof(c.triangle);
+        break;
+    case NK_COMMAND_TRIANGLE_FILLED:
+        nk_command_get_points(&p, &c.triangle_filled.a, 1);
+        nk_command_get_points(&p, &c.triangle_filled.b, 1);
+        nk_command_get_points(&p, &c.triangle_filled.c, 1);
+        c.triangle_filled.color = nk_command_get_color(enc, &p);
+        size = sizeof(c.triangle_filled);
+        break;
+    case NK_COMMAND_POLYGON:
+    case NK_COMMAND_POLYLINE:
+        c.polygon.color = nk_command_get_color(enc, &p);
+        c.polygon.line_thickness = (unsigned short)nk_command_get_uint(&p);
+        c.polygon.point_count = (unsigned short)nk_command_get_uint(&p);
+        size = sizeof(c.polygon) + sizeof(struct nk_vec2i) * c.polygon.point_count;
+        break;
+    case NK_COMMAND_POLYGON_FILLED:
+        c.polygon_filled.color = nk_command_get_color(enc, &p);
+        c.polygon_filled.point_count = (unsigned short)nk_command_get_uint(&p);
+        size = sizeof(c.polygon_filled) + sizeof(struct nk_vec2i) * c.polygon_filled.point_count;
+        break;
+    case NK_COMMAND_TEXT:
+        c.text.font = (const struct nk_user_font*)nk_command_get_pointer(enc, &p);
+        c.text.background = nk_command_get_color(enc, &p);
+        c.text.foreground = nk_command_get_color(enc, &p);
+        nk_command_get_rect(&p, &c.text.x, &c.text.y, &c.text.w, &c.text.h);
+        nk_command_get_raw(&p, &c.text.height, sizeof(c.text.height));
+        c.text.length = (int)nk_command_get_uint(&p);
+        tail = p;
+        tail_size = (nk_size)c.text.length;
+        p += tail_size;
+        size = sizeof(c.text) + tail_size + 1;
+        break;
+    case NK_COMMAND_TEXT_REF:
+        c.text_ref.font = (const struct nk_user_font*)nk_command_get_pointer(enc, &p);
+        c.text_ref.background = nk_command_get_color(enc, &p);
+        c.text_ref.foreground = nk_command_get_color(enc, &p);
+        nk_command_get_rect(&p, &c.text_ref.x, &c.text_ref.y, &c.text_ref.w, &c.text_ref.h);
+        nk_command_get_raw(&p, &c.text_ref.height, sizeof(c.text_ref.height));
+        c.text_ref.length = (int)nk_command_get_uint(&p);
+        nk_command_get_raw(&p, &c.text_ref.hash, sizeof(c.text_ref.hash));
+        nk_command_get_raw(&p, (void*)&c.text_ref.string, sizeof(c.text_ref.string));
+        size = sizeof(c.text_ref);
+        break;
+    case NK_COMMAND_IMAGE:
+        nk_command_get_rect(&p, &c.image.x, &c.image.y, &c.image.w, &c.image.h);
+        nk_command_get_raw(&p, &c.image.img, sizeof(c.image.img));
+        c.image.col = nk_command_get_color(enc, &p);
+        size = sizeof(c.image);
+        break;
+    case NK_COMMAND_CUSTOM:
+        nk_command_get_rect(&p, &c.custom.x, &c.custom.y, &c.custom.w, &c.custom.h);
+        nk_command_get_raw(&p, &c.custom.callback_data, sizeof(c.custom.callback_data));
+        nk_command_get_raw(&p, &c.custom.callback, sizeof(c.custom.callback));
+        size = sizeof(c.custom);
+        break;
+    }
+    c.header.next = (nk_size)(p - (const nk_byte*)enc->stream.memory.ptr);
+
+    /* hand the command out from a buffer so variable sized commands fit */
+    nk_buffer_clear(&enc->decoded);
+    out = (union nk_command_any*)nk_buffer_alloc(&enc->decoded, NK_BUFFER_FRONT,
+        NK_MAX(size, sizeof(c)), align);
+    if (!out) return 0;
+    *out = c;
+    if (c.header.type == NK_COMMAND_TEXT) {
+        NK_MEMCPY(out->text.string, tail, tail_size);
+        out->text.string[tail_size] = '\0';
+    } else if (c.header.type == NK_COMMAND_POLYGON || c.header.type == NK_COMMAND_POLYLINE) {
+        nk_command_get_points(&p, out->polygon.points, out->polygon.point_count);
+        out->header.next = (nk_size)(p - (const nk_byte*)enc->stream.memory.ptr);
+    } else if (c.header.type == NK_COMMAND_POLYGON_FILLED) {
+        nk_command_get_points(&p, out->polygon_filled.points, out->polygon_filled.point_count);
+        out->header.next = (nk_size)(p - (const nk_byte*)enc->stream.memory.ptr);
+    }
+    return &out->header;
+}
+NK_API nk_bool
+nk_set_command_encoding(struct nk_context *ctx, enum nk_command_encoding encoding)
+{
+    struct nk_command_encoder *enc;
+    NK_ASSERT(ctx);
+    if (!ctx) return nk_false;
+    enc = &ctx->encoder;
+    if (enc->encoding == encoding) return nk_true;
+
+    if (encoding == NK_COMMAND_ENCODING_COMPACT) {
+        if (!ctx->frame.alloc.alloc) return nk_false;
+        nk_buffer_init(&enc->stream, &ctx->frame.alloc, NK_DEFAULT_COMMAND_BUFFER_SIZE);
+        nk_buffer_init(&enc->decoded, &ctx->frame.alloc, sizeof(union nk_command_any) + 256);
+    } else {
+        nk_buffer_free(&enc->stream);
+        nk_buffer_free(&enc->decoded);
+        nk_zero_struct(enc->stream);
+        nk_zero_struct(enc->decoded);
+    }
+    enc->encoding = encoding;
+    enc->fallback = nk_false;
+    /* a frame that is already built is encoded right away */
+    if (ctx->build && encoding == NK_COMMAND_ENCODING_COMPACT)
+        enc->fallback = !nk_command_encode(ctx);
+    return nk_true;
+}
+NK_API const void*
+nk_command_stream(struct nk_context *ctx, nk_size *size)
+{
+    NK_ASSERT(ctx);
+    NK_ASSERT(size);
+    if (!ctx || !size) return 0;
+    *size = 0;
+    if (!ctx->count && !ctx->workers && ctx->spliced_end == ctx->spliced_begin)
+        return 0;
+
+    if (!ctx->build) {
+        nk_build(ctx);
+        ctx->build = nk_true;
+    }
+    if (ctx->encoder.encoding == NK_COMMAND_ENCODING_COMPACT && !ctx->encoder.fallback) {
+        *size = ctx->encoder.stream.allocated;
+        return ctx->encoder.stream.memory.ptr;
+    }
+    *size = ctx->memory.allocated;
+    return ctx->memory.memory.ptr;
+}
@@ -0,0 +1,899 @@
+#include "nuklear.h"
+#include "nuklear_internal.h"
+
+/* ===============================================================
+ *
+ *                          COMMAND SERIALIZATION
+ *
+ * ===============================================================*/
+/*  A frame starts with the bytes 'N' 'K', the format version, flags and the
+ *  numbers of the frame and of the frame it refers to (0 for a key frame) as
+ *  variable length integers. Ops follow until the end of the frame:
+ *
+ *      NK_COMMAND_SERIAL_COPY n   copy the next n records of the previous frame
+ *      NK_COMMAND_SERIAL_SKIP n   drop the next n records of the previous frame
+ *      any other byte             a record of a command that changed
+ *
+ *  A record is the command type followed by its fields like the compact
+ *  encoding, but without anything that depends on the process or on records
+ *  before it: colors are four bytes, floats four little endian bytes, fonts,
+ *  images and userdata ids and text is always copied. Fonts and images have
+ *  to be registered on both sides, a frame using others is not sent and not
+ *  applied. Equal commands give equal records, which is what the ops compare. */
+#define NK_COMMAND_SERIAL_VERSION 1
+#define NK_COMMAND_SERIAL_RECORD_SIZE 128
+
+enum {
+    NK_COMMAND_SERIAL_USERDATA = 0x01,
+    NK_COMMAND_SERIAL_COPY = 0xFE,
+    NK_COMMAND_SERIAL_SKIP = 0xFF
+};
+#ifdef NK_INCLUDE_COMMAND_USERDATA
+#define NK_COMMAND_SERIAL_FLAGS NK_COMMAND_SERIAL_USERDATA
+#else
+#define NK_COMMAND_SERIAL_FLAGS 0
+#endif
+
+struct nk_command_serial_reader {
+    const nk_byte *p;
+    const nk_byte *end;
+    nk_bool error;
+};
+
+NK_INTERN void
+nk_command_serial_frame_init(struct nk_command_serial_frame *frame,
+    const struct nk_allocator *alloc)
+{
+    nk_buffer_init(&frame->records, alloc, NK_BUFFER_DEFAULT_INITIAL_SIZE);
+    nk_buffer_init(&frame->offsets, alloc, NK_BUFFER_DEFAULT_INITIAL_SIZE);
+}
+NK_INTERN void
+nk_command_serial_frame_clear(struct nk_command_serial_frame *frame)
+{
+    nk_buffer_clear(&frame->records);
+    nk_buffer_clear(&frame->offsets);
+}
+NK_INTERN int
+nk_command_serial_frame_count(const struct nk_command_serial_frame *frame)
+{
+    /* the offsets end with the one past the last record */
+    nk_size count = frame->offsets.allocated / sizeof(nk_size);
+    return (count) ? (int)count - 1: 0;
+}
+NK_INTERN const nk_size*
+nk_command_serial_frame_offsets(const struct nk_command_serial_frame *frame)
+{
+    return (const nk_size*)frame->offsets.memory.ptr;
+}
+NK_INTERN nk_bool
+nk_command_serial_push(struct nk_buffer *buffer, const void *memory, nk_size size)
+{
+    void *dst = nk_buffer_alloc(buffer, NK_BUFFER_FRONT, size, 1);
+    if (!dst) return nk_false;
+    NK_MEMCPY(dst, memory, size);
+    return nk_true;
+}
+NK_INTERN nk_bool
+nk_command_serial_frame_mark(struct nk_command_serial_frame *frame)
+{
+    /* ends the record written last and starts the next one */
+    nk_size *offset = (nk_size*)nk_buffer_alloc(&frame->offsets, NK_BUFFER_FRONT,
+        sizeof(nk_size), NK_ALIGNOF(nk_size));
+    if (!offset) return nk_false;
+    *offset = frame->records.allocated;
+    return nk_true;
+}
+
+/* ---------------------------------------------------------------
+ *                          SERIALIZER
+ * ---------------------------------------------------------------*/
+NK_INTERN nk_byte*
+nk_command_serial_put_color(nk_byte *p, struct nk_color c)
+{
+    *p++ = c.r;
+    *p++ = c.g;
+    *p++ = c.b;
+    *p++ = c.a;
+    return p;
+}
+NK_INTERN nk_byte*
+nk_command_serial_put_float(nk_byte *p, float f)
+{
+    nk_uint bits;
+    NK_MEMCPY(&bits, &f, sizeof(bits));
+    *p++ = (nk_byte)(bits & 0xFF);
+    *p++ = (nk_byte)((bits >> 8) & 0xFF);
+    *p++ = (nk_byte)((bits >> 16) & 0xFF);
+    *p++ = (nk_byte)((bits >> 24) & 0xFF);
+    return p;
+}
+NK_INTERN nk_byte*
+nk_command_serial_put_text(nk_byte *p, const struct nk_command_serializer *ser,
+    const struct nk_user_font *font, struct nk_color background,
+    struct nk_color foreground, short x, short y, unsigned short w,
+    unsigned short h, float height, const char *string, int length)
+{
+    int i;
+    for (i = 0; i < ser->font_count; ++i)
+        if (ser->fonts[i].font == font) break;
+    if (i == ser->font_count) return 0;
+    p = nk_command_put_uint(p, ser->fonts[i].id);
+    p = nk_command_serial_put_color(p, background);
+    p = nk_command_serial_put_color(p, foreground);
+    p = nk_command_put_rect(p, x, y, w, h);
+    p = nk_command_serial_put_float(p, height);
+    p = nk_command_put_uint(p, (nk_uint)length);
+    NK_MEMCPY(p, string, (nk_size)length);
+    return p + length;
+}
+NK_INTERN nk_byte*
+nk_command_serial_write(const struct nk_command_serializer *ser, nk_byte *p,
+    const struct nk_command *cmd)
+{
+    const union nk_command_any *c = (const union nk_command_any*)(const void*)cmd;
+    int i;
+
+    /* referenced text is sent as a copy, the receiver has no strings */
+    *p++ = (nk_byte)((cmd->type == NK_COMMAND_TEXT_REF) ? NK_COMMAND_TEXT: cmd->type);
+#ifdef NK_INCLUDE_COMMAND_USERDATA
+    p = nk_command_put_int(p, cmd->userdata.id);
+#endif
+    switch (cmd->type) {
+    case NK_COMMAND_NOP: break;
+    case NK_COMMAND_SCISSOR:
+        p = nk_command_put_rect(p, c->scissor.x, c->scissor.y, c->scissor.w, c->scissor.h);
+        break;
+    case NK_COMMAND_LINE:
+        p = nk_command_put_uint(p, c->line.line_thickness);
+        p = nk_command_put_points(p, &c->line.begin, 1);
+        p = nk_command_put_points(p, &c->line.end, 1);
+        p = nk_command_serial_put_color(p, c->line.color);
+        break;
+    case NK_COMMAND_CURVE:
+        p = nk_command_put_uint(p, c->curve.line_thickness);
+        p = nk_command_put_points(p, &c->curve.begin, 1);
+        p = nk_command_put_points(p, &c->curve.end, 1);
+        p = nk_command_put_points(p, c->curve.ctrl, 2);
+        p = nk_command_serial_put_color(p, c->curve.color);
+        break;
+    case NK_COMMAND_RECT:
+        p = nk_command_put_uint(p, c->rect.rounding);
+        p = nk_command_put_uint(p, c->rect.line_thickness);
+        p = nk_command_put_rect(p, c->rect.x, c->rect.y, c->rect.w, c->rect.h);
+        p = nk_command_serial_put_color(p, c->rect.color);
+        break;
+    case NK_COMMAND_RECT_FILLED:
+        p = nk_command_put_uint(p, c->rect_filled.rounding);
+        p = nk_command_put_rect(p, c->rect_filled.x, c->rect_filled.y, c->rect_filled.w, c->rect_filled.h);
+        p = nk_command_serial_put_color(p, c->rect_filled.color);
+        break;
+    case NK_COMMAND_RECT_MULTI_COLOR:
+        p = nk_command_put_rect(p, c->rect_multi_color.x, c->rect_multi_color.y,
+            c->rect_multi_color.w, c->rect_multi_color.h);
+        p = nk_command_serial_put_color(p, c->rect_multi_color.left);
+        p = nk_command_serial_put_color(p, c->rect_multi_color.top);
+        p = nk_command_serial_put_color(p, c->rect_multi_color.bottom);
+        p = nk_command_serial_put_color(p, c->rect_multi_color.right);
+        break;
+    case NK_COMMAND_CIRCLE:
+        p = nk_command_put_uint(p, c->circle.line_thickness);
+        p = nk_command_put_rect(p, c->circle.x, c->circle.y, c->circle.w, c->circle.h);
+        p = nk_command_serial_put_color(p, c->circle.color);
+        break;
+    case NK_COMMAND_CIRCLE_FILLED:
+        p = nk_command_put_rect(p, c->circle_filled.x, c->circle_filled.y, c->circle_filled.w, c->circle_filled.h);
+        p = nk_command_serial_put_color(p, c->circle_filled.color);
+        break;
+    case NK_COMMAND_ARC:
+        p = nk_command_put_uint(p, c->arc.line_thickness);
+        p = nk_command_put_int(p, c->arc.cx);
+        p = nk_command_put_int(p, c->arc.cy);
+        p = nk_command_put_uint(p, c->arc.r);
+        p = nk_command_serial_put_float(p, c->arc.a[0]);
+        p = nk_command_serial_put_float(p, c->arc.a[1]);
+        p = nk_command_serial_put_color(p, c->arc.color);
+        break;
+    case NK_COMMAND_ARC_FILLED:
+        p = nk_command_put_int(p, c->arc_filled.cx);
+        p = nk_command_put_int(p, c->arc_filled.cy);
+        p = nk_command_put_uint(p, c->arc_filled.r);
+        p = nk_command_serial_put_float(p, c->arc_filled.a[0]);
+        p = nk_command_serial_put_float(p, c->arc_filled.a[1]);
+        p = nk_command_serial_put_color(p, c->arc_filled.color);
+        break;
+    case NK_COMMAND_TRIANGLE:
+        p = nk_command_put_uint(p, c->triangle.line_thickness);
+        p = nk_command_put_points(p, &c->triangle.a, 1);
+        p = nk_command_put_points(p, &c->triangle.b, 1);
+        p = nk_command_put_points(p, &c->triangle.c, 1);
+        p = nk_command_serial_put_color(p, c->triangle.color);
+        break;
+    case NK_COMMAND_TRIANGLE_FILLED:
+        p = nk_command_put_points(p, &c->triangle_filled.a, 1);
+        p = nk_command_put_points(p, &c->triangle_filled.b, 1);
+        p = nk_command_put_points(p, &c->triangle_filled.c, 1);
+        p = nk_command_serial_put_color(p, c->triangle_filled.color);
+        break;
+    case NK_COMMAND_POLYGON:
+    case NK_COMMAND_POLYLINE:
+        p = nk_command_serial_put_color(p, c->polygon.color);
+        p = nk_command_put_uint(p, c->polygon.line_thickness);
+        p = nk_command_put_uint(p, c->polygon.point_count);
+        p = nk_command_put_points(p, c->polygon.points, c->polygon.point_count);
+        break;
+    case NK_COMMAND_POLYGON_FILLED:
+        p = nk_command_serial_put_color(p, c->polygon_filled.color);
+        p = nk_command_put_uint(p, c->polygon_filled.point_count);
+        p = nk_command_put_points(p, c->polygon_filled.points, c->polygon_filled.point_count);
+        break;
+    case NK_COMMAND_TEXT:
+        /* fonts and images only exist in this process, without an id the
+         * record can not be sent */
+        p = nk_command_serial_put_text(p, ser, c->text.font, c->text.background,
+            c->text.foreground, c->text.x, c->text.y, c->text.w, c->text.h,
+            c->text.height, c->text.string, c->text.length);
+        break;
+    case NK_COMMAND_TEXT_REF:
+        p = nk_command_serial_put_text(p, ser, c->text_ref.font, c->text_ref.background,
+            c->text_ref.foreground, c->text_ref.x, c->text_ref.y, c->text_ref.w,
+            c->text_ref.h, c->text_ref.height, c->text_ref.string, c->text_ref.length);
+        break;
+    case NK_COMMAND_IMAGE: {
+        for (i = 0; i < ser->image_count; ++i)
+            if (ser->images[i].handle.ptr == c->image.img.handle.ptr) break;
+        if (i == ser->image_count) return 0;
+        p = nk_command_put_rect(p, c->image.x, c->image.y, c->image.w, c->image.h);
+        p = nk_command_put_uint(p, ser->images[i].id);
+        p = nk_command_put_uint(p, c->image.img.w);
+        p = nk_command_put_uint(p, c->image.img.h);
+        for (i = 0; i < 4; ++i)
+            p = nk_command_put_uint(p, c->image.img.region[i]);
+        p = nk_command_serial_put_color(p, c->image.col);
+    } break;
+    case NK_COMMAND_CUSTOM:
+        p = nk_command_put_rect(p, c->custom.x, c->custom.y, c->custom.w, c->custom.h);
+        p = nk_command_put_int(p, c->custom.callback_data.id);
+        break;
+    }
+    return p;
+}
+NK_INTERN nk_bool
+nk_command_serial_put_op(struct nk_buffer *stream, nk_byte op, int n)
+{
+    nk_byte *begin, *end;
+    if (!n) return nk_true;
+    begin = (nk_byte*)nk_buffer_alloc(stream, NK_BUFFER_FRONT, 6, 1);
+    if (!begin) return nk_false;
+    *begin = op;
+    end = nk_command_put_uint(begin + 1, (nk_uint)n);
+    stream->allocated -= 6 - (nk_size)(end - begin);
+    stream->needed = stream->allocated;
+    return nk_true;
+}
+NK_INTERN nk_bool
+nk_command_serial_record(struct nk_command_serializer *ser,
+    struct nk_command_serial_frame *frame, const struct nk_command *cmd)
+{
+    /* reserve the largest record this command can take and give back what
+     * it did not use */
+    nk_size size = NK_COMMAND_SERIAL_RECORD_SIZE;
+    nk_byte *begin, *end;
+
+    if (cmd->type == NK_COMMAND_TEXT)
+        size += (nk_size)((const struct nk_command_text*)cmd)->length;
+    else if (cmd->type == NK_COMMAND_TEXT_REF)
+        size += (nk_size)((const struct nk_command_text_ref*)cmd)->length;
+    else if (cmd->type == NK_COMMAND_POLYGON || cmd->type == NK_COMMAND_POLYLINE)
+        size += 6 * (nk_size)((const struct nk_command_polygon*)cmd)->point_count;
+    else if (cmd->type == NK_COMMAND_POLYGON_FILLED)
+        size += 6 * (nk_size)((const struct nk_command_polygon_filled*)cmd)->point_count;
+    begin = (nk_byte*)nk_buffer_alloc(&frame->records, NK_BUFFER_FRONT, size, 1);
+    if (!begin) return nk_false;
+    end = nk_command_serial_write(ser, begin, cmd);
+    if (!end) end = begin;
+    frame->records.allocated -= size - (nk_size)(end - begin);
+    frame->records.needed = frame->records.allocated;
+    if (end == begin) return nk_false;
+    return nk_command_serial_frame_mark(frame);
+}
+NK_INTERN nk_bool
+nk_command_serial_equal(const struct nk_command_serial_frame *a, int i,
+    const struct nk_command_serial_frame *b, int j)
+{
+    const nk_size *ao = nk_command_serial_frame_offsets(a);
+    const nk_size *bo = nk_command_serial_frame_offsets(b);
+    const nk_byte *x = (const nk_byte*)a->records.memory.ptr + ao[i];
+    const nk_byte *y = (const nk_byte*)b->records.memory.ptr + bo[j];
+    nk_size size = ao[i+1] - ao[i];
+    if (size != bo[j+1] - bo[j]) return nk_false;
+    while (size--)
+        if (*x++ != *y++) return nk_false;
+    return nk_true;
+}
+#ifdef NK_INCLUDE_DEFAULT_ALLOCATOR
+NK_API void
+nk_command_serializer_init_default(struct nk_command_serializer *ser)
+{
+    struct nk_allocator alloc;
+    alloc.userdata.ptr = 0;
+    alloc.alloc = nk_malloc;
+    alloc.free = nk_mfree;
+    nk_command_serializer_init(ser, &alloc);
+}
+#endif
+NK_API void
+nk_command_serializer_init(struct nk_command_serializer *ser,
+    const struct nk_allocator *alloc)
+{
+    NK_ASSERT(ser);
+    NK_ASSERT(alloc);
+    if (!ser || !alloc) return;
+    nk_zero_struct(*ser);
+    nk_command_serial_frame_init(&ser->frames[0], alloc);
+    nk_command_serial_frame_init(&ser->frames[1], alloc);
+    nk_buffer_init(&ser->stream, alloc, NK_BUFFER_DEFAULT_INITIAL_SIZE);
+    ser->key = nk_true;
+}
+NK_API void
+nk_command_serializer_free(struct nk_command_serializer *ser)
+{
+    NK_ASSERT(ser);
+    if (!ser) return;
+    nk_buffer_free(&ser->frames[0].records);
+    nk_buffer_free(&ser->frames[0].offsets);
+    nk_buffer_free(&ser->frames[1].records);
+    nk_buffer_free(&ser->frames[1].offsets);
+    nk_buffer_free(&ser->stream);
+    nk_zero_struct(*ser);
+}
+NK_API void
+nk_command_serializer_reset(struct nk_command_serializer *ser)
+{
+    NK_ASSERT(ser);
+    if (!ser) return;
+    ser->key = nk_true;
+}
+NK_API nk_bool
+nk_command_serializer_font(struct nk_command_serializer *ser,
+    const struct nk_user_font *font, nk_uint id)
+{
+    int i;
+    NK_ASSERT(ser);
+    NK_ASSERT(font);
+    if (!ser || !font) return nk_false;
+    for (i = 0; i < ser->font_count; ++i) {
+        if (ser->fonts[i].font != font) continue;
+        ser->fonts[i].id = id;
+        ser->key = nk_true;
+        return nk_true;
+    }
+    if (ser->font_count >= NK_COMMAND_SERIAL_FONTS) return nk_false;
+    ser->fonts[ser->font_count].font = font;
+    ser->fonts[ser->font_count++].id = id;
+    return nk_true;
+}
+NK_API nk_bool
+nk_command_serializer_image(struct nk_command_serializer *ser,
+    nk_handle handle, nk_uint id)
+{
+    int i;
+    NK_ASSERT(ser);
+    if (!ser) return nk_false;
+    for (i = 0; i < ser->image_count; ++i) {
+        if (ser->images[i].handle.ptr != handle.ptr) continue;
+        ser->images[i].id = id;
+        ser->key = nk_true;
+        return nk_true;
+    }
+    if (ser->image_count >= NK_COMMAND_SERIAL_IMAGES) return nk_false;
+    ser->images[ser->image_count].handle = handle;
+    ser->images[ser->image_count++].id = id;
+    return nk_true;
+}
+NK_API const void*
+nk_command_serialize(struct nk_command_serializer *ser, struct nk_context *ctx,
+    nk_size *size)
+{
+    struct nk_command_serial_frame *prev, *frame;
+    const struct nk_command *cmd;
+    nk_byte *header, *end;
+    int prev_count, cursor = 0, run = 0, count = 0;
+
+    NK_ASSERT(ser);
+    NK_ASSERT(ctx);
+    NK_ASSERT(size);
+    if (!ser || !ctx || !size) return 0;
+    *size = 0;
+
+    prev = &ser->frames[ser->current];
+    frame = &ser->frames[!ser->current];
+    prev_count = (ser->key) ? 0: nk_command_serial_frame_count(prev);
+    nk_command_serial_frame_clear(frame);
+    nk_buffer_clear(&ser->stream);
+    if (!nk_command_serial_frame_mark(frame)) goto fail;
+
+    header = (nk_byte*)nk_buffer_alloc(&ser->stream, NK_BUFFER_FRONT, 14, 1);
+    if (!header) goto fail;
+    header[0] = 'N';
+    header[1] = 'K';
+    header[2] = NK_COMMAND_SERIAL_VERSION;
+    header[3] = NK_COMMAND_SERIAL_FLAGS;
+    end = nk_command_put_uint(header + 4, (ser->seq + 1) ? ser->seq + 1: 1);
+    end = nk_command_put_uint(end, (ser->key) ? 0: ser->seq);
+    ser->stream.allocated -= 14 - (nk_size)(end - header);
+
+    nk_foreach(cmd, ctx) {
+        int ahead;
+        if (!nk_command_serial_record(ser, frame, cmd)) goto fail;
+        if (cursor < prev_count && nk_command_serial_equal(frame, count, prev, cursor)) {
+            cursor++; run++; count++;
+            continue;
+        }
+        if (!nk_command_serial_put_op(&ser->stream, NK_COMMAND_SERIAL_COPY, run)) goto fail;
+        run = 0;
+
+        /* a command that is neither next nor shortly after in the previous
+         * frame is sent as a record. The cursor stays, so the commands after
+         * a changed one are found again one record ahead */
+        for (ahead = cursor + 1; ahead < prev_count &&
+            ahead <= cursor + NK_COMMAND_SERIAL_LOOKAHEAD; ++ahead)
+            if (nk_command_serial_equal(frame, count, prev, ahead)) break;
+        if (ahead < prev_count && ahead <= cursor + NK_COMMAND_SERIAL_LOOKAHEAD) {
+            if (!nk_command_serial_put_op(&ser->stream, NK_COMMAND_SERIAL_SKIP, ahead - cursor))
+                goto fail;
+            cursor = ahead + 1;
+            run = 1;
+        } else {
+            const nk_size *offsets = nk_command_serial_frame_offsets(frame);
+            if (!nk_command_serial_push(&ser->stream,
+                (const nk_byte*)frame->records.memory.ptr + offsets[count],
+                offsets[count+1] - offsets[count])) goto fail;
+        }
+        count++;
+    }
+    if (!nk_command_serial_put_op(&ser->stream, NK_COMMAND_SERIAL_COPY, run)) goto fail;
+
+    ser->current = !ser->current;
+    ser->seq = (ser->seq + 1) ? ser->seq + 1: 1;
+    ser->key = nk_false;
+    *size = ser->stream.allocated;
+    return ser->stream.memory.ptr;
+
+fail:
+    /* out of memory or an unregistered font or image: the receiver did not
+     * get this frame, start over with the next */
+    ser->key = nk_true;
+    return 0;
+}
+
+/* ---------------------------------------------------------------
+ *                          DESERIALIZER
+ * ---------------------------------------------------------------*/
+NK_INTERN nk_byte
+nk_command_serial_byte(struct nk_command_serial_reader *r)
+{
+    if (r->p >= r->end) {
+        r->error = nk_true;
+        return 0;
+    }
+    return *r->p++;
+}
+NK_INTERN nk_uint
+nk_command_serial_uint(struct nk_command_serial_reader *r)
+{
+    nk_uint v = 0;
+    int shift = 0;
+    nk_byte b;
+    do {
+        b = nk_command_serial_byte(r);
+        v |= (nk_uint)(b & 0x7F) << shift;
+        shift += 7;
+    } while ((b & 0x80) && shift < 32);
+    return v;
+}
+NK_INTERN int
+nk_command_serial_int(struct nk_command_serial_reader *r)
+{
+    nk_uint v = nk_command_serial_uint(r);
+    return (int)(v >> 1) ^ -(int)(v & 1);
+}
+NK_INTERN struct nk_color
+nk_command_serial_color(struct nk_command_serial_reader *r)
+{
+    struct nk_color c;
+    c.r = nk_command_serial_byte(r);
+    c.g = nk_command_serial_byte(r);
+    c.b = nk_command_serial_byte(r);
+    c.a = nk_command_serial_byte(r);
+    return c;
+}
+NK_INTERN float
+nk_command_serial_float(struct nk_command_serial_reader *r)
+{
+    nk_uint bits;
+    float f;
+    bits = (nk_uint)nk_command_serial_byte(r);
+    bits |= (nk_uint)nk_command_serial_byte(r) << 8;
+    bits |= (nk_uint)nk_command_serial_byte(r) << 16;
+    bits |= (nk_uint)nk_command_serial_byte(r) << 24;
+    NK_MEMCPY(&f, &bits, sizeof(f));
+    return f;
+}
+NK_INTERN void
+nk_command_serial_rect(struct nk_command_serial_reader *r, short *x, short *y,
+    unsigned short *w, unsigned short *h)
+{
+    *x = (short)nk_command_serial_int(r);
+    *y = (short)nk_command_serial_int(r);
+    *w = (unsigned short)nk_command_serial_uint(r);
+    *h = (unsigned short)nk_command_serial_uint(r);
+}
+NK_INTERN void
+nk_command_serial_points(struct nk_command_serial_reader *r,
+    struct nk_vec2i *points, int count)
+{
+    int i;
+    for (i = 0; i < count; ++i) {
+        struct nk_vec2i point;
+        point.x = (short)nk_command_serial_int(r);
+        point.y = (short)nk_command_serial_int(r);
+        if (points) points[i] = point;
+    }
+}
+NK_INTERN nk_size
+nk_command_serial_read(const struct nk_command_deserializer *des,
+    struct nk_command_serial_reader *r, union nk_command_any *c,
+    struct nk_command_serial_reader *tail)
+{
+    nk_size size = 0;
+    nk_uint id;
+    int i;
+
+    nk_zero_struct(*c);
+    *tail = *r;
+    c->header.type = (enum nk_command_type)nk_command_serial_byte(r);
+#ifdef NK_INCLUDE_COMMAND_USERDATA
+    c->header.userdata.id = nk_command_serial_int(r);
+#endif
+    switch (c->header.type) {
+    case NK_COMMAND_NOP: size = sizeof(c->header); break;
+    case NK_COMMAND_SCISSOR:
+        nk_command_serial_rect(r, &c->scissor.x, &c->scissor.y, &c->scissor.w, &c->scissor.h);
+        size = sizeof(c->scissor);
+        break;
+    case NK_COMMAND_LINE:
+        c->line.line_thickness = (unsigned short)nk_command_serial_uint(r);
+        nk_command_serial_points(r, &c->line.begin, 1);
+        nk_command_serial_points(r, &c->line.end, 1);
+        c->line.color = nk_command_serial_color(r);
+        size = sizeof(c->line);
+        break;
+    case NK_COMMAND_CURVE:
+        c->curve.line_thickness = (unsigned short)nk_command_serial_uint(r);
+        nk_command_serial_points(r, &c->curve.begin, 1);
+        nk_command_serial_points(r, &c->curve.end, 1);
+        nk_command_serial_points(r, c->curve.ctrl, 2);
+        c->curve.color = nk_command_serial_color(r);
+        size = sizeof(c->curve);
+        break;
+    case NK_COMMAND_RECT:
+        c->rect.rounding = (unsigned short)nk_command_serial_uint(r);
+        c->rect.line_thickness = (unsigned short)nk_command_serial_uint(r);
+        nk_command_serial_rect(r, &c->rect.x, &c->rect.y, &c->rect.w, &c->rect.h);
+        c->rect.color = nk_command_serial_color(r);
+        size = sizeof(c->rect);
+        break;
+    case NK_COMMAND_RECT_FILLED:
+        c->rect_filled.rounding = (unsigned short)nk_command_serial_uint(r);
+        nk_command_serial_rect(r, &c->rect_filled.x, &c->rect_filled.y, &c->rect_filled.w, &c->rect_filled.h);
+        c->rect_filled.color = nk_command_serial_color(r);
+        size = sizeof(c->rect_filled);
+        break;
+    case NK_COMMAND_RECT_MULTI_COLOR:
+        nk_command_serial_rect(r, &c->rect_multi_color.x, &c->rect_multi_color.y,
+            &c->rect_multi_color.w, &c->rect_multi_color.h);
+        c->rect_multi_color.left = nk_command_serial_color(r);
+        c->rect_multi_color.top = nk_command_serial_color(r);
+        c->rect_multi_color.bottom = nk_command_serial_color(r);
+        c->rect_multi_color.right = nk_command_serial_color(r);
+        size = sizeof(c->rect_multi_color);
+        break;
+    case NK_COMMAND_CIRCLE:
+        c->circle.line_thickness = (unsigned short)nk_command_serial_uint(r);
+        nk_command_serial_rect(r, &c->circle.x, &c->circle.y, &c->circle.w, &c->circle.h);
+        c->circle.color = nk_command_serial_color(r);
+        size = sizeof(c->circle);
+        break;
+    case NK_COMMAND_CIRCLE_FILLED:
+        nk_command_serial_rect(r, &c->circle_filled.x, &c->circle_filled.y, &c->circle_filled.w, &c->circle_filled.h);
+        c->circle_filled.color = nk_command_serial_color(r);
+        size = sizeof(c->circle_filled);
+        break;
+    case NK_COMMAND_ARC:
+        c->arc.line_thickness = (unsigned short)nk_command_serial_uint(r);
+        c->arc.cx = (short)nk_command_serial_int(r);
+        c->arc.cy = (short)nk_command_serial_int(r);
+        c->arc.r = (unsigned short)nk_command_serial_uint(r);
+        c->arc.a[0] = nk_command_serial_float(r);
+        c->arc.a[1] = nk_command_serial_float(r);
+        c->arc.color = nk_command_serial_color(r);
+        size = sizeof(c->arc);
+        break;
+    case NK_COMMAND_ARC_FILLED:
+        c->arc_filled.cx = (short)nk_command_serial_int(r);
+        c->arc_filled.cy = (short)nk_command_serial_int(r);
+        c->arc_filled.r = (unsigned short)nk_command_serial_uint(r);
+        c->arc_filled.a[0] = nk_command_serial_float(r);
+        c->arc_filled.a[1] = nk_command_serial_float(r);
+        c->arc_filled.color = nk_command_serial_color(r);
+        size = sizeof(c->arc_filled);
+        break;
+    case NK_COMMAND_TRIANGLE:
+        c->triangle.line_thickness = (unsigned short)nk_command_serial_uint(r);
+        nk_command_serial_points(r, &c->triangle.a, 1);
+        nk_command_serial_points(r, &c->triangle.b, 1);
+        nk_command_serial_points(r, &c->triangle.c, 1);
+        c->triangle.color = nk_command_serial_color(r);
+        size = sizeof(c->triangle);
+        break;
+    case NK_COMMAND_TRIANGLE_FILLED:
+        nk_command_serial_points(r, &c->triangle_filled.a, 1);
+        nk_command_serial_points(r, &c->triangle_filled.b, 1);
+        nk_command_serial_points(r, &c->triangle_filled.c, 1);
+        c->triangle_filled.color = nk_command_serial_color(r);
+        size = sizeof(c->triangle_filled);
+        break;
+    case NK_COMMAND_POLYGON:
+    case NK_COMMAND_POLYLINE:
+        c->polygon.color = nk_command_serial_color(r);
+        c->polygon.line_thickness = (unsigned short)nk_command_serial_uint(r);
+        c->polygon.point_count = (unsigned short)nk_command_serial_uint(r);
+        *tail = *r;
+        nk_command_serial_points(r, 0, c->polygon.point_count);
+        size = sizeof(c->polygon) + sizeof(struct nk_vec2i) * c->polygon.point_count;
+        break;
+    case NK_COMMAND_POLYGON_FILLED:
+        c->polygon_filled.color = nk_command_serial_color(r);
+        c->polygon_filled.point_count = (unsigned short)nk_command_serial_uint(r);
+        *tail = *r;
+        nk_command_serial_points(r, 0, c->polygon_filled.point_count);
+        size = sizeof(c->polygon_filled) + sizeof(struct nk_vec2i) * c->polygon_filled.point_count;
+        break;
+    case NK_COMMAND_TEXT:
+        id = nk_command_serial_uint(r);
+        for (i = 0; i < des->font_count; ++i)
+            if (des->fonts[i].id == id) break;
+        if (i == des->font_count) {
+            r->error = nk_true;
+            break;
+        }
+        c->text.font = des->fonts[i].font;
+        c->text.background = nk_command_serial_color(r);
+        c->text.foreground = nk_command_serial_color(r);
+        nk_command_serial_rect(r, &c->text.x, &c->text.y, &c->text.w, &c->text.h);
+        c->text.height = nk_command_serial_float(r);
+        c->text.length = (int)nk_command_serial_uint(r);
+        if (c->text.length < 0 || (nk_size)(r->end - r->p) < (nk_size)c->text.length) {
+            r->error = nk_true;
+            break;
+        }
+        *tail = *r;
+        r->p += c->text.length;
+        size = sizeof(c->text) + (nk_size)c->text.length + 1;
+        break;
+    case NK_COMMAND_IMAGE:
+        nk_command_serial_rect(r, &c->image.x, &c->image.y, &c->image.w, &c->image.h);
+        id = nk_command_serial_uint(r);
+        for (i = 0; i < des->image_count; ++i)
+            if (des->images[i].id == id) break;
+        if (i == des->image_count) {
+            r->error = nk_true;
+            break;
+        }
+        c->image.img.handle = des->images[i].handle;
+        c->image.img.w = (nk_ushort)nk_command_serial_uint(r);
+        c->image.img.h = (nk_ushort)nk_command_serial_uint(r);
+        for (i = 0; i < 4; ++i)
+            c->image.img.region[i] = (nk_ushort)nk_command_serial_uint(r);
+        c->image.col = nk_command_serial_color(r);
+        size = sizeof(c->image);
+        break;
+    case NK_COMMAND_CUSTOM:
+        nk_command_serial_rect(r, &c->custom.x, &c->custom.y, &c->custom.w, &c->custom.h);
+        c->custom.callback_data = nk_handle_id(nk_command_serial_int(r));
+        c->custom.callback = des->custom;
+        size = sizeof(c->custom);
+        break;
+    default: r->error = nk_true; break;
+    }
+    return (r->error) ? 0: size;
+}
+NK_INTERN nk_bool
+nk_command_serial_emit(const struct nk_command_deserializer *des,
+    struct nk_context *ctx, const struct nk_command_serial_frame *frame)
+{
+    const nk_size *offsets = nk_command_serial_frame_offsets(frame);
+    const nk_byte *records = (const nk_byte*)frame->records.memory.ptr;
+    int i, count = nk_command_serial_frame_count(frame);
+    nk_size last = 0;
+
+    ctx->spliced_begin = ctx->spliced_end = ctx->memory.allocated;
+    for (i = 0; i < count; ++i) {
+        struct nk_command_serial_reader r, tail;
+        union nk_command_any c;
+        union nk_command_any *cmd;
+        nk_size size, offset;
+
+        r.p = records + offsets[i];
+        r.end = records + offsets[i+1];
+        r.error = nk_false;
+        size = nk_command_serial_read(des, &r, &c, &tail);
+        if (!size) return nk_false;
+        cmd = (union nk_command_any*)nk_buffer_alloc(&ctx->memory, NK_BUFFER_FRONT,
+            size, NK_ALIGNOF(struct nk_command));
+        if (!cmd) return nk_false;
+        NK_MEMCPY(cmd, &c, NK_MIN(size, sizeof(c)));
+
+        if (c.header.type == NK_COMMAND_TEXT) {
+            NK_MEMCPY(cmd->text.string, tail.p, (nk_size)c.text.length);
+            cmd->text.string[c.text.length] = '\0';
+        } else if (c.header.type == NK_COMMAND_POLYGON || c.header.type == NK_COMMAND_POLYLINE) {
+            nk_command_serial_points(&tail, cmd->polygon.points, c.polygon.point_count);
+        } else if (c.header.type == NK_COMMAND_POLYGON_FILLED) {
+            nk_command_serial_points(&tail, cmd->polygon_filled.points, c.polygon_filled.point_count);
+        }
+
+        /* link the previous command to this one */
+        offset = (nk_size)((nk_byte*)cmd - (nk_byte*)ctx->memory.memory.ptr);
+        if (i) nk_ptr_add(struct nk_command, ctx->memory.memory.ptr, last)->next = offset;
+        else ctx->spliced_begin = offset;
+        last = offset;
+    }
+    if (count) {
+        nk_ptr_add(struct nk_command, ctx->memory.memory.ptr, last)->next = ctx->memory.allocated;
+        ctx->spliced_end = ctx->memory.allocated;
+    }
+    return nk_true;
+}
+#ifdef NK_INCLUDE_DEFAULT_ALLOCATOR
+NK_API void
+nk_command_deserializer_init_default(struct nk_command_deserializer *des)
+{
+    struct nk_allocator alloc;
+    alloc.userdata.ptr = 0;
+    alloc.alloc = nk_malloc;
+    alloc.free = nk_mfree;
+    nk_command_deserializer_init(des, &alloc);
+}
+#endif
+NK_API void
+nk_command_deserializer_init(struct nk_command_deserializer *des,
+    const struct nk_allocator *alloc)
+{
+    NK_ASSERT(des);
+    NK_ASSERT(alloc);
+    if (!des || !alloc) return;
+    nk_zero_struct(*des);
+    nk_command_serial_frame_init(&des->frames[0], alloc);
+    nk_command_serial_frame_init(&des->frames[1], alloc);
+}
+NK_API void
+nk_command_deserializer_free(struct nk_command_deserializer *des)
+{
+    NK_ASSERT(des);
+    if (!des) return;
+    nk_buffer_free(&des->frames[0].records);
+    nk_buffer_free(&des->frames[0].offsets);
+    nk_buffer_free(&des->frames[1].records);
+    nk_buffer_free(&des->frames[1].offsets);
+    nk_zero_struct(*des);
+}
+NK_API nk_bool
+nk_command_deserializer_font(struct nk_command_deserializer *des, nk_uint id,
+    const struct nk_user_font *font)
+{
+    int i;
+    NK_ASSERT(des);
+    NK_ASSERT(font);
+    if (!des || !font) return nk_false;
+    for (i = 0; i < des->font_count; ++i) {
+        if (des->fonts[i].id != id) continue;
+        des->fonts[i].font = font;
+        return nk_true;
+    }
+    if (des->font_count >= NK_COMMAND_SERIAL_FONTS) return nk_false;
+    des->fonts[des->font_count].font = font;
+    des->fonts[des->font_count++].id = id;
+    return nk_true;
+}
+NK_API nk_bool
+nk_command_deserializer_image(struct nk_command_deserializer *des, nk_uint id,
+    nk_handle handle)
+{
+    int i;
+    NK_ASSERT(des);
+    if (!des) return nk_false;
+    for (i = 0; i < des->image_count; ++i) {
+        if (des->images[i].id != id) continue;
+        des->images[i].handle = handle;
+        return nk_true;
+    }
+    if (des->image_count >= NK_COMMAND_SERIAL_IMAGES) return nk_false;
+    des->images[des->image_count].handle = handle;
+    des->images[des->image_count++].id = id;
+    return nk_true;
+}
+NK_API nk_bool
+nk_command_deserialize(struct nk_command_deserializer *des, struct nk_context *ctx,
+    const void *data, nk_size size)
+{
+    struct nk_command_serial_frame *prev, *frame;
+    struct nk_command_serial_reader r;
+    const nk_size *prev_offsets;
+    nk_uint seq, base;
+    int prev_count, cursor = 0;
+
+    NK_ASSERT(des);
+    NK_ASSERT(ctx);
+    NK_ASSERT(!ctx->build);
+    if (!des || !ctx || !data || ctx->build) return nk_false;
+
+    r.p = (const nk_byte*)data;
+    r.end = r.p + size;
+    r.error = nk_false;
+    if (nk_command_serial_byte(&r) != 'N' || nk_command_serial_byte(&r) != 'K' ||
+        nk_command_serial_byte(&r) != NK_COMMAND_SERIAL_VERSION ||
+        nk_command_serial_byte(&r) != NK_COMMAND_SERIAL_FLAGS)
+        return nk_false;
+    seq = nk_command_serial_uint(&r);
+    base = nk_command_serial_uint(&r);
+    if (r.error || (base && base != des->seq)) return nk_false;
+
+    prev = &des->frames[des->current];
+    frame = &des->frames[!des->current];
+    prev_count = (base) ? nk_command_serial_frame_count(prev): 0;
+    prev_offsets = nk_command_serial_frame_offsets(prev);
+    nk_command_serial_frame_clear(frame);
+    if (!nk_command_serial_frame_mark(frame)) return nk_false;
+
+    while (r.p < r.end) {
+        const nk_byte *begin = r.p;
+        nk_byte op = *r.p;
+        if (op == NK_COMMAND_SERIAL_COPY || op == NK_COMMAND_SERIAL_SKIP) {
+            nk_uint n;
+            r.p++;
+            n = nk_command_serial_uint(&r);
+            if (r.error || n > (nk_uint)(prev_count - cursor)) return nk_false;
+            if (op == NK_COMMAND_SERIAL_COPY) {
+                int i;
+                for (i = cursor; i < cursor + (int)n; ++i) {
+                    if (!nk_command_serial_push(&frame->records,
+                        (const nk_byte*)prev->records.memory.ptr + prev_offsets[i],
+                        prev_offsets[i+1] - prev_offsets[i]) ||
+                        !nk_command_serial_frame_mark(frame)) return nk_false;
+                }
+            }
+            cursor += (int)n;
+        } else {
+            /* check records once when they arrive, copies of them are
+             * known to be fine */
+            struct nk_command_serial_reader tail;
+            union nk_command_any c;
+            if (!nk_command_serial_read(des, &r, &c, &tail))
+                return nk_false;
+            if (!nk_command_serial_push(&frame->records, begin, (nk_size)(r.p - begin)) ||
+                !nk_command_serial_frame_mark(frame)) return nk_false;
+        }
+    }
+    des->current = !des->current;
+    des->seq = seq;
+
+    if (!nk_command_serial_emit(des, ctx, frame)) {
+        ctx->spliced_begin = ctx->spliced_end = 0;
+        return nk_false;
+    }
+    ctx->build = nk_true;
+    if (ctx->encoder.encoding == NK_COMMAND_ENCODING_COMPACT)
+        ctx->encoder.fallback = !nk_command_encode(ctx);
+    return nk_true;
+}
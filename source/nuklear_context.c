@@ -11,6 +11,8 @@ nk_setup(struct nk_context *ctx, const struct nk_user_font *font)
 {
     NK_ASSERT(ctx);
     if (!ctx) return;
+    /* pick the memory copy before worker contexts use it on other threads */
+    nk_simd_init();
     nk_zero_struct(*ctx);
     nk_style_default(ctx);
     ctx->seq = 1;
@@ -41,6 +43,20 @@ nk_init_fixed(struct nk_context *ctx, void *memory, nk_size size,
     ctx->use_pool = nk_false;
     return 1;
 }
+#ifdef NK_INCLUDE_VIRTUAL_MEMORY
+NK_API nk_bool
+nk_init_virtual(struct nk_context *ctx, nk_size reserve,
+    const struct nk_user_font *font)
+{
+    NK_ASSERT(reserve);
+    if (!reserve) return 0;
+    nk_setup(ctx, font);
+    if (!nk_buffer_init_virtual(&ctx->memory, reserve))
+        return 0;
+    ctx->use_pool = nk_false;
+    return 1;
+}
+#endif
 NK_API nk_bool
 nk_init_custom(struct nk_context *ctx, struct nk_buffer *cmds,
     struct nk_buffer *pool, const struct nk_user_font *font)
@@ -48,6 +64,11 @@ nk_init_custom(struct nk_context *ctx, struct nk_buffer *cmds,
     NK_ASSERT(cmds);
     NK_ASSERT(pool);
     if (!cmds || !pool) return 0;
+#ifdef NK_INCLUDE_VIRTUAL_MEMORY
+    /* a virtual buffer has no allocator and no committed pages to carve a pool from */
+    NK_ASSERT(pool->type != NK_BUFFER_VIRTUAL);
+    if (pool->type == NK_BUFFER_VIRTUAL) return 0;
+#endif
 
     nk_setup(ctx, font);
     ctx->memory = *cmds;
@@ -58,6 +79,8 @@ nk_init_custom(struct nk_context *ctx, struct nk_buffer *cmds,
         /* create dynamic pool from buffer allocator */
         struct nk_allocator *alloc = &pool->pool;
         nk_pool_init(&ctx->pool, alloc, NK_POOL_DEFAULT_CAPACITY);
+        ctx->frame.alloc = *alloc;
+        ctx->text_cache.alloc = *alloc;
     }
     ctx->use_pool = nk_true;
     return 1;
@@ -71,6 +94,8 @@ nk_init(struct nk_context *ctx, const struct nk_allocator *alloc,
     nk_setup(ctx, font);
     nk_buffer_init(&ctx->memory, alloc, NK_DEFAULT_COMMAND_BUFFER_SIZE);
     nk_pool_init(&ctx->pool, alloc, NK_POOL_DEFAULT_CAPACITY);
+    ctx->frame.alloc = *alloc;
+    ctx->text_cache.alloc = *alloc;
     ctx->use_pool = nk_true;
     return 1;
 }
@@ -87,11 +112,24 @@ nk_set_user_data(struct nk_context *ctx, nk_handle handle)
 NK_API void
 nk_free(struct nk_context *ctx)
 {
+    struct nk_window *iter;
     NK_ASSERT(ctx);
     if (!ctx) return;
+    for (iter = ctx->begin; iter; iter = iter->next) {
+        /* line tables are the only window state outside of the pool */
+        nk_free_edit_lines(ctx, iter);
+        if (iter->popup.win)
+            nk_free_edit_lines(ctx, iter->popup.win);
+    }
     nk_buffer_free(&ctx->memory);
     if (ctx->use_pool)
         nk_pool_free(&ctx->pool);
+    nk_cache_free(ctx);
+    nk_frame_trim(&ctx->frame);
+    nk_zero_struct(ctx->frame);
+    nk_text_cache_free(&ctx->text_cache);
+    nk_zero_struct(ctx->text_cache);
+    nk_set_command_encoding(ctx, NK_COMMAND_ENCODING_RAW);
 
     nk_zero(&ctx->input, sizeof(ctx->input));
     nk_zero(&ctx->style, sizeof(ctx->style));
@@ -99,11 +137,15 @@ nk_free(struct nk_context *ctx)
 
     ctx->seq = 0;
     ctx->build = 0;
+    ctx->workers = 0;
+    ctx->next_worker = 0;
+    ctx->keyboard = 0;
     ctx->begin = 0;
     ctx->end = 0;
     ctx->active = 0;
     ctx->current = 0;
     ctx->freelist = 0;
+    nk_zero_struct(ctx->windows);
     ctx->count = 0;
 }
 NK_API void
@@ -111,6 +153,7 @@ nk_clear(struct nk_context *ctx)
 {
     struct nk_window *iter;
     struct nk_window *next;
+    nk_size budget;
     NK_ASSERT(ctx);
 
     if (!ctx) return;
@@ -119,12 +162,23 @@ nk_clear(struct nk_context *ctx)
     else nk_buffer_reset(&ctx->memory, NK_BUFFER_FRONT);
 
     ctx->build = 0;
+    ctx->recording = 0;
     ctx->memory.calls = 0;
+    while (ctx->workers) {
+        struct nk_context *worker = ctx->workers;
+        ctx->workers = worker->next_worker;
+        worker->next_worker = 0;
+        nk_clear(worker);
+    }
+    ctx->spliced_begin = ctx->spliced_end = 0;
     ctx->last_widget_state = 0;
+    nk_frame_reset(&ctx->frame);
+    nk_text_cache_frame(&ctx->text_cache);
     ctx->style.cursor_active = ctx->style.cursors[NK_CURSOR_ARROW];
     NK_MEMSET(&ctx->overlay, 0, sizeof(ctx->overlay));
 
     /* garbage collector */
+    budget = (ctx->gc_budget) ? ctx->gc_budget: ~(nk_size)0;
     iter = ctx->begin;
     while (iter) {
         /* make sure valid minimized windows do not get removed */
@@ -134,14 +188,13 @@ nk_clear(struct nk_context *ctx)
             iter = iter->next;
             continue;
         }
-        /* remove hotness from hidden or closed windows*/
+        /* remove hotness from hidden or closed windows. The window stays
+         * linked: detaching `begin`/`end` here would orphan it from the list
+         * while `nk_find_window` still finds it through the window index */
         if (((iter->flags & NK_WINDOW_HIDDEN) ||
             (iter->flags & NK_WINDOW_CLOSED)) &&
             iter == ctx->active) {
             ctx->active = iter->prev;
-            ctx->end = iter->prev;
-            if (!ctx->end)
-                ctx->begin = 0;
             if (ctx->active)
                 ctx->active->flags &= ~(unsigned)NK_WINDOW_ROM;
         }
@@ -150,18 +203,12 @@ nk_clear(struct nk_context *ctx)
             nk_free_window(ctx, iter->popup.win);
             iter->popup.win = 0;
         }
-        /* remove unused window state tables */
-        {struct nk_table *n, *it = iter->tables;
-        while (it) {
-            n = it->next;
-            if (it->seq != ctx->seq) {
-                nk_remove_table(iter, it);
-                nk_zero(it, sizeof(union nk_page_data));
-                nk_free_table(ctx, it);
-                if (it == iter->tables)
-                    iter->tables = n;
-            } it = n;
-        }}
+        /* remove window state tables no lookup used since the last frame.
+         * Tables move to the used list on lookup, so this only visits the
+         * stale ones and leaves them to later frames once over budget */
+        budget -= nk_collect_tables(ctx, iter, budget);
+        nk_age_tables(iter);
+        nk_collect_edit_lines(ctx, iter);
         /* window itself is not used anymore so free */
         if (iter->seq != ctx->seq || iter->flags & NK_WINDOW_CLOSED) {
             next = iter->next;
@@ -172,6 +219,145 @@ nk_clear(struct nk_context *ctx)
     }
     ctx->seq++;
 }
+NK_API nk_size
+nk_trim(struct nk_context *ctx)
+{
+    nk_size released = 0;
+    NK_ASSERT(ctx);
+    NK_ASSERT(!ctx->current && "nk_trim must not be called between `nk_begin` and `nk_end`");
+    if (!ctx || ctx->current) return 0;
+
+    if (ctx->use_pool) {
+        released += nk_pool_trim(&ctx->pool, &ctx->freelist);
+    } else {
+        /* give free elements adjoining the back of the fixed buffer back to
+         * it until the lowest back element is in use */
+        nk_bool found = nk_true;
+        while (found) {
+            struct nk_page_element **it = &ctx->freelist;
+            void *back_begin = (nk_byte*)ctx->memory.memory.ptr + ctx->memory.size;
+            found = nk_false;
+            for (; *it; it = &(*it)->next) {
+                if ((void*)*it != back_begin) continue;
+                *it = (*it)->next;
+                ctx->memory.size += sizeof(struct nk_page_element);
+                released += sizeof(struct nk_page_element);
+                found = nk_true;
+                break;
+            }
+        }
+    }
+    released += nk_buffer_trim(&ctx->memory);
+    /* scratch memory handed out this frame must stay valid until `nk_clear` */
+    if (!ctx->frame.allocated)
+        released += nk_frame_trim(&ctx->frame);
+    return released;
+}
+NK_INTERN nk_bool
+nk_input_has_events(const struct nk_input *in)
+{
+    int i;
+    if (in->mouse.pos.x != in->mouse.prev.x || in->mouse.pos.y != in->mouse.prev.y ||
+        in->mouse.scroll_delta.x != 0 || in->mouse.scroll_delta.y != 0 ||
+        in->keyboard.text_len || in->mouse.grab || in->mouse.ungrab)
+        return nk_true;
+    /* held buttons keep repeater buttons and drags going */
+    for (i = 0; i < NK_BUTTON_MAX; ++i)
+        if (in->mouse.buttons[i].clicked || in->mouse.buttons[i].down)
+            return nk_true;
+    for (i = 0; i < NK_KEY_MAX; ++i)
+        if (in->keyboard.keys[i].clicked)
+            return nk_true;
+    return nk_false;
+}
+NK_INTERN float
+nk_window_next_deadline(const struct nk_context *ctx, const struct nk_window *win,
+    nk_bool *redraw)
+{
+    float timer = win->scrollbar_hiding_timer;
+    if (!(win->flags & NK_WINDOW_SCROLL_AUTO_HIDE) ||
+        (win->flags & (NK_WINDOW_NO_SCROLLBAR|NK_WINDOW_MINIMIZED|NK_WINDOW_HIDDEN|NK_WINDOW_CLOSED)))
+        return -1.0f;
+    if (timer < NK_SCROLLBAR_HIDING_TIMEOUT)
+        return NK_SCROLLBAR_HIDING_TIMEOUT - timer;
+    /* the timer ran out during this frame but the scrollbar was drawn before */
+    if (timer - ctx->delta_time_seconds < NK_SCROLLBAR_HIDING_TIMEOUT)
+        *redraw = nk_true;
+    return -1.0f;
+}
+NK_INTERN float
+nk_next_deadline(const struct nk_context *ctx, nk_bool *redraw)
+{
+    const struct nk_window *iter;
+    float deadline = -1.0f;
+
+    *redraw = nk_input_has_events(&ctx->input);
+    for (iter = ctx->begin; iter; iter = iter->next) {
+        float d = nk_window_next_deadline(ctx, iter, redraw);
+        if (d >= 0 && (deadline < 0 || d < deadline)) deadline = d;
+        if (!iter->popup.win) continue;
+        d = nk_window_next_deadline(ctx, iter->popup.win, redraw);
+        if (d >= 0 && (deadline < 0 || d < deadline)) deadline = d;
+    }
+    return (*redraw) ? 0: deadline;
+}
+NK_API nk_bool
+nk_frame_needs_redraw(const struct nk_context *ctx)
+{
+    nk_bool redraw;
+    NK_ASSERT(ctx);
+    if (!ctx) return nk_false;
+    nk_next_deadline(ctx, &redraw);
+    return redraw;
+}
+NK_API float
+nk_next_deadline_seconds(const struct nk_context *ctx)
+{
+    nk_bool redraw;
+    NK_ASSERT(ctx);
+    if (!ctx) return -1.0f;
+    return nk_next_deadline(ctx, &redraw);
+}
+NK_API nk_size
+nk_collect(struct nk_context *ctx, nk_size budget)
+{
+    struct nk_window *iter;
+    nk_size freed = 0;
+    NK_ASSERT(ctx);
+    NK_ASSERT(!ctx->current && "nk_collect must not be called between `nk_begin` and `nk_end`");
+    if (!ctx || ctx->current) return 0;
+    if (!budget) budget = ~(nk_size)0;
+    for (iter = ctx->begin; iter && freed < budget; iter = iter->next)
+        freed += nk_collect_tables(ctx, iter, budget - freed);
+    return freed;
+}
+NK_API void
+nk_attach_worker(struct nk_context *ctx, struct nk_context *worker)
+{
+    struct nk_context **it;
+    NK_ASSERT(ctx);
+    NK_ASSERT(worker);
+    NK_ASSERT(ctx != worker);
+    if (!ctx || !worker || ctx == worker) return;
+
+    /* the worker builds from a snapshot so it never reads `ctx` while the
+     * UI thread keeps building */
+    worker->input = ctx->input;
+    worker->style = ctx->style;
+    worker->style.cursor_visible = nk_false;
+    worker->delta_time_seconds = ctx->delta_time_seconds;
+    worker->button_behavior = ctx->button_behavior;
+    /* keys and text only go to the context with the active text field */
+    if (ctx->keyboard == worker)
+        nk_zero_struct(ctx->input.keyboard);
+    else nk_zero_struct(worker->input.keyboard);
+
+    /* keep the order of attachment, it is the drawing order */
+    for (it = &ctx->workers; *it; it = &(*it)->next_worker)
+        if (*it == worker) return;
+    worker->next_worker = 0;
+    *it = worker;
+}
 NK_LIB void
 nk_start_buffer(struct nk_context *ctx, struct nk_command_buffer *buffer)
 {
@@ -182,6 +368,8 @@ nk_start_buffer(struct nk_context *ctx, struct nk_command_buffer *buffer)
     buffer->end = buffer->begin;
     buffer->last = buffer->begin;
     buffer->clip = nk_null_rect;
+    buffer->use_text_ref = nk_false;
+    buffer->text_cache = &ctx->text_cache;
 }
 NK_LIB void
 nk_start(struct nk_context *ctx, struct nk_window *win)
@@ -244,30 +432,13 @@ nk_finish(struct nk_context *ctx, struct nk_window *win)
     parent_last = nk_ptr_add(struct nk_command, memory, buf->parent);
     parent_last->next = buf->end;
 }
-NK_LIB void
-nk_build(struct nk_context *ctx)
+NK_INTERN struct nk_command*
+nk_build_windows(struct nk_context *ctx)
 {
     struct nk_window *it = 0;
     struct nk_command *cmd = 0;
     nk_byte *buffer = 0;
 
-    /* draw cursor overlay */
-    if (!ctx->style.cursor_active)
-        ctx->style.cursor_active = ctx->style.cursors[NK_CURSOR_ARROW];
-    if (ctx->style.cursor_active && !ctx->input.mouse.grabbed && ctx->style.cursor_visible) {
-        struct nk_rect mouse_bounds;
-        const struct nk_cursor *cursor = ctx->style.cursor_active;
-        nk_command_buffer_init(&ctx->overlay, &ctx->memory, NK_CLIPPING_OFF);
-        nk_start_buffer(ctx, &ctx->overlay);
-
-        mouse_bounds.x = ctx->input.mouse.pos.x - cursor->offset.x;
-        mouse_bounds.y = ctx->input.mouse.pos.y - cursor->offset.y;
-        mouse_bounds.w = cursor->size.x;
-        mouse_bounds.h = cursor->size.y;
-
-        nk_draw_image(&ctx->overlay, mouse_bounds, &cursor->img, nk_white);
-        nk_finish_buffer(ctx, &ctx->overlay);
-    }
     /* build one big draw command list out of all window buffers */
     it = ctx->begin;
     buffer = (nk_byte*)ctx->memory.memory.ptr;
@@ -299,46 +470,170 @@ nk_build(struct nk_context *ctx)
         buf->active = nk_false;
         skip: it = next;
     }
+    return cmd;
+}
+NK_INTERN nk_bool
+nk_splice_worker(struct nk_context *ctx, struct nk_context *worker, nk_size *tail)
+{
+    const struct nk_command *first;
+    struct nk_command *last;
+    nk_size offset, last_offset, base;
+    nk_byte *memory;
+
+    last = nk_build_windows(worker);
+    first = nk_command_list_begin(worker);
+    if (!last || !first) return nk_false;
+
+    /* copy the worker commands as one block and move the offsets of its
+     * list by the position of the block */
+    memory = (nk_byte*)nk_buffer_alloc(&ctx->memory, NK_BUFFER_FRONT,
+        worker->memory.allocated, NK_ALIGNOF(struct nk_command));
+    if (!memory) return nk_false;
+    NK_MEMCPY(memory, worker->memory.memory.ptr, worker->memory.allocated);
+    base = (nk_size)(memory - (nk_byte*)ctx->memory.memory.ptr);
+    offset = (nk_size)((const nk_byte*)first - (nk_byte*)worker->memory.memory.ptr);
+    last_offset = (nk_size)((nk_byte*)last - (nk_byte*)worker->memory.memory.ptr);
+
+    if (ctx->spliced_end != ctx->spliced_begin)
+        nk_ptr_add(struct nk_command, ctx->memory.memory.ptr, *tail)->next = base + offset;
+    else ctx->spliced_begin = base + offset;
+    while (offset != last_offset) {
+        struct nk_command *cmd = (struct nk_command*)(memory + offset);
+        offset = cmd->next;
+        cmd->next += base;
+    }
+    *tail = base + last_offset;
+    ctx->spliced_end = ctx->memory.allocated;
+
+    /* let widgets of the worker grab the mouse */
+    ctx->input.mouse.grab |= worker->input.mouse.grab;
+    ctx->input.mouse.ungrab |= worker->input.mouse.ungrab;
+    return nk_true;
+}
+NK_INTERN nk_bool
+nk_editing(const struct nk_context *ctx)
+{
+    /* only the active window reads the keyboard */
+    const struct nk_window *win = ctx->active;
+    if (!win || win->seq != ctx->seq) return nk_false;
+    return win->edit.active || (win->property.active &&
+        win->property.state == NK_PROPERTY_EDIT);
+}
+NK_INTERN void
+nk_keyboard_focus(struct nk_context *ctx)
+{
+    /* a context that starts editing takes the keyboard from the others, the
+     * owner keeps it while it is still editing */
+    struct nk_context *owner = (ctx->keyboard) ? ctx->keyboard: ctx;
+    struct nk_context *started = 0, *kept = 0, *it;
+    for (it = ctx; it; it = (it == ctx) ? ctx->workers: it->next_worker) {
+        nk_bool editing = nk_editing(it);
+        if (editing && !it->editing && !started) started = it;
+        if (editing && it == owner) kept = it;
+        it->editing = editing;
+    }
+    owner = (started) ? started: kept;
+    ctx->keyboard = (owner != ctx) ? owner: 0;
+}
+NK_LIB void
+nk_build(struct nk_context *ctx)
+{
+    struct nk_context *worker;
+    struct nk_command *cmd = 0;
+    nk_size tail = 0;
+
+    /* copy worker commands first, growing the buffer moves it */
+    ctx->spliced_begin = ctx->spliced_end = 0;
+    for (worker = ctx->workers; worker; worker = worker->next_worker)
+        nk_splice_worker(ctx, worker, &tail);
+    nk_keyboard_focus(ctx);
+
+    /* draw cursor overlay */
+    if (!ctx->style.cursor_active)
+        ctx->style.cursor_active = ctx->style.cursors[NK_CURSOR_ARROW];
+    if (ctx->style.cursor_active && !ctx->input.mouse.grabbed && ctx->style.cursor_visible) {
+        struct nk_rect mouse_bounds;
+        const struct nk_cursor *cursor = ctx->style.cursor_active;
+        nk_command_buffer_init(&ctx->overlay, &ctx->memory, NK_CLIPPING_OFF);
+        nk_start_buffer(ctx, &ctx->overlay);
+
+        mouse_bounds.x = ctx->input.mouse.pos.x - cursor->offset.x;
+        mouse_bounds.y = ctx->input.mouse.pos.y - cursor->offset.y;
+        mouse_bounds.w = cursor->size.x;
+        mouse_bounds.h = cursor->size.y;
+
+        nk_draw_image(&ctx->overlay, mouse_bounds, &cursor->img, nk_white);
+        nk_finish_buffer(ctx, &ctx->overlay);
+    }
+    cmd = nk_build_windows(ctx);
+    if (ctx->spliced_end != ctx->spliced_begin) {
+        /* worker windows go above the windows of the context */
+        if (cmd) cmd->next = ctx->spliced_begin;
+        cmd = nk_ptr_add(struct nk_command, ctx->memory.memory.ptr, tail);
+    }
     if (cmd) {
         /* append overlay commands */
         if (ctx->overlay.end != ctx->overlay.begin)
             cmd->next = ctx->overlay.begin;
         else cmd->next = ctx->memory.allocated;
     }
+    if (ctx->encoder.encoding == NK_COMMAND_ENCODING_COMPACT)
+        ctx->encoder.fallback = !nk_command_encode(ctx);
 }
-NK_API const struct nk_command*
-nk__begin(struct nk_context *ctx)
+NK_LIB const struct nk_command*
+nk_command_list_begin(const struct nk_context *ctx)
 {
     struct nk_window *iter;
     nk_byte *buffer;
     NK_ASSERT(ctx);
     if (!ctx) return 0;
-    if (!ctx->count) return 0;
 
     buffer = (nk_byte*)ctx->memory.memory.ptr;
-    if (!ctx->build) {
-        nk_build(ctx);
-        ctx->build = nk_true;
-    }
     iter = ctx->begin;
     while (iter && ((iter->buffer.begin == iter->buffer.end) ||
         (iter->flags & NK_WINDOW_HIDDEN) || iter->seq != ctx->seq))
         iter = iter->next;
-    if (!iter) return 0;
-    return nk_ptr_add_const(struct nk_command, buffer, iter->buffer.begin);
+    if (iter)
+        return nk_ptr_add_const(struct nk_command, buffer, iter->buffer.begin);
+    if (ctx->spliced_end != ctx->spliced_begin)
+        return nk_ptr_add_const(struct nk_command, buffer, ctx->spliced_begin);
+    return 0;
 }
-
-NK_API const struct nk_command*
-nk__next(struct nk_context *ctx, const struct nk_command *cmd)
+NK_LIB const struct nk_command*
+nk_command_list_next(const struct nk_context *ctx, const struct nk_command *cmd)
 {
     nk_byte *buffer;
-    const struct nk_command *next;
     NK_ASSERT(ctx);
-    if (!ctx || !cmd || !ctx->count) return 0;
+    if (!ctx || !cmd) return 0;
     if (cmd->next >= ctx->memory.allocated) return 0;
     buffer = (nk_byte*)ctx->memory.memory.ptr;
-    next = nk_ptr_add_const(struct nk_command, buffer, cmd->next);
-    return next;
+    return nk_ptr_add_const(struct nk_command, buffer, cmd->next);
+}
+NK_API const struct nk_command*
+nk__begin(struct nk_context *ctx)
+{
+    NK_ASSERT(ctx);
+    if (!ctx) return 0;
+    if (!ctx->count && !ctx->workers && ctx->spliced_end == ctx->spliced_begin)
+        return 0;
+
+    if (!ctx->build) {
+        nk_build(ctx);
+        ctx->build = nk_true;
+    }
+    if (ctx->encoder.encoding == NK_COMMAND_ENCODING_COMPACT && !ctx->encoder.fallback)
+        return nk_command_decode(ctx, 0);
+    return nk_command_list_begin(ctx);
+}
+
+NK_API const struct nk_command*
+nk__next(struct nk_context *ctx, const struct nk_command *cmd)
+{
+    NK_ASSERT(ctx);
+    if (!ctx || !cmd) return 0;
+    if (ctx->encoder.encoding == NK_COMMAND_ENCODING_COMPACT && !ctx->encoder.fallback)
+        return nk_command_decode(ctx, cmd->next);
+    return nk_command_list_next(ctx, cmd);
 }
 
 
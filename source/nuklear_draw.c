@@ -15,9 +15,19 @@ nk_command_buffer_init(struct nk_command_buffer *cb,
     if (!cb || !b) return;
     cb->base = b;
     cb->use_clipping = (int)clip;
+    cb->use_text_ref = nk_false;
     cb->begin = b->allocated;
     cb->end = b->allocated;
     cb->last = b->allocated;
+    cb->text_cache = 0;
+}
+NK_LIB nk_bool
+nk_draw_culled(const struct nk_command_buffer *b, struct nk_rect r)
+{
+    /* nothing of `r` is visible inside the clip rect of a clipping buffer */
+    const struct nk_rect *c = &b->clip;
+    if (!b->use_clipping) return nk_false;
+    return c->w == 0 || c->h == 0 || !NK_INTERSECT(r.x, r.y, r.w, r.h, c->x, c->y, c->w, c->h);
 }
 NK_LIB void
 nk_command_buffer_reset(struct nk_command_buffer *b)
@@ -398,11 +408,7 @@ nk_draw_image(struct nk_command_buffer *b, struct nk_rect r,
     struct nk_command_image *cmd;
     NK_ASSERT(b);
     if (!b) return;
-    if (b->use_clipping) {
-        const struct nk_rect *c = &b->clip;
-        if (c->w == 0 || c->h == 0 || !NK_INTERSECT(r.x, r.y, r.w, r.h, c->x, c->y, c->w, c->h))
-            return;
-    }
+    if (nk_draw_culled(b, r)) return;
 
     cmd = (struct nk_command_image*)
         nk_command_buffer_push(b, NK_COMMAND_IMAGE, sizeof(*cmd));
@@ -498,11 +504,7 @@ nk_push_custom(struct nk_command_buffer *b, struct nk_rect r,
     struct nk_command_custom *cmd;
     NK_ASSERT(b);
     if (!b) return;
-    if (b->use_clipping) {
-        const struct nk_rect *c = &b->clip;
-        if (c->w == 0 || c->h == 0 || !NK_INTERSECT(r.x, r.y, r.w, r.h, c->x, c->y, c->w, c->h))
-            return;
-    }
+    if (nk_draw_culled(b, r)) return;
 
     cmd = (struct nk_command_custom*)
         nk_command_buffer_push(b, NK_COMMAND_CUSTOM, sizeof(*cmd));
@@ -519,20 +521,39 @@ nk_draw_text(struct nk_command_buffer *b, struct nk_rect r,
     const char *string, int length, const struct nk_user_font *font,
     struct nk_color bg, struct nk_color fg)
 {
-    float text_width = 0;
+    NK_ASSERT(b);
+    NK_ASSERT(font);
+    if (!b || !string || !length || (bg.a == 0 && fg.a == 0)) return;
+    if (nk_draw_culled(b, r)) return;
+    nk_draw_text_measured(b, r, string, length, font,
+        font->width(font->userdata, font->height, string, length), bg, fg);
+}
+NK_API void
+nk_draw_text_ref(struct nk_command_buffer *b, struct nk_rect r,
+    const char *string, int length, const struct nk_user_font *font,
+    struct nk_color bg, struct nk_color fg)
+{
+    int use_text_ref;
+    NK_ASSERT(b);
+    if (!b) return;
+    use_text_ref = b->use_text_ref;
+    b->use_text_ref = nk_true;
+    nk_draw_text(b, r, string, length, font, bg, fg);
+    b->use_text_ref = use_text_ref;
+}
+NK_LIB void
+nk_draw_text_measured(struct nk_command_buffer *b, struct nk_rect r,
+    const char *string, int length, const struct nk_user_font *font,
+    float text_width, struct nk_color bg, struct nk_color fg)
+{
     struct nk_command_text *cmd;
 
     NK_ASSERT(b);
     NK_ASSERT(font);
     if (!b || !string || !length || (bg.a == 0 && fg.a == 0)) return;
-    if (b->use_clipping) {
-        const struct nk_rect *c = &b->clip;
-        if (c->w == 0 || c->h == 0 || !NK_INTERSECT(r.x, r.y, r.w, r.h, c->x, c->y, c->w, c->h))
-            return;
-    }
+    if (nk_draw_culled(b, r)) return;
 
     /* make sure text fits inside bounds */
-    text_width = font->width(font->userdata, font->height, string, length);
     if (text_width > r.w){
         int glyphs = 0;
         float txt_width = (float)text_width;
@@ -540,6 +561,23 @@ nk_draw_text(struct nk_command_buffer *b, struct nk_rect r,
     }
 
     if (!length) return;
+    if (b->use_text_ref) {
+        struct nk_command_text_ref *ref = (struct nk_command_text_ref*)
+            nk_command_buffer_push(b, NK_COMMAND_TEXT_REF, sizeof(*ref));
+        if (!ref) return;
+        ref->x = (short)r.x;
+        ref->y = (short)r.y;
+        ref->w = (unsigned short)r.w;
+        ref->h = (unsigned short)r.h;
+        ref->background = bg;
+        ref->foreground = fg;
+        ref->font = font;
+        ref->length = length;
+        ref->height = font->height;
+        ref->hash = nk_murmur_hash(string, length, 0);
+        ref->string = string;
+        return;
+    }
     cmd = (struct nk_command_text*)
         nk_command_buffer_push(b, NK_COMMAND_TEXT, sizeof(*cmd) + (nk_size)(length + 1));
     if (!cmd) return;
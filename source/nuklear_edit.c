@@ -68,27 +68,43 @@ nk_filter_binary(const struct nk_text_edit *box, nk_rune unicode)
  *                          EDIT
  *
  * ===============================================================*/
-NK_LIB void
+NK_INTERN void
+nk_edit_draw_line(struct nk_command_buffer *out, struct nk_rect label,
+    const char *line, int len, const struct nk_text *txt, nk_flags align,
+    const struct nk_user_font *font)
+{
+    /* edit lines change while typing so keep them out of the text cache */
+    float width = font->width(font->userdata, font->height, line, len);
+    nk_widget_text_measured(out, label, line, len, txt, align, font, width, 0);
+}
+NK_LIB struct nk_vec2
 nk_edit_draw_text(struct nk_command_buffer *out,
     const struct nk_style_edit *style, float pos_x, float pos_y,
     float x_offset, const char *text, int byte_len, float row_height,
     const struct nk_user_font *font, struct nk_color background,
     struct nk_color foreground, nk_bool is_selected)
 {
+    /* returns where text following `text` continues: x relative to `pos_x`
+     * and y relative to `pos_y` */
     NK_ASSERT(out);
     NK_ASSERT(font);
     NK_ASSERT(style);
-    if (!text || !byte_len || !out || !style) return;
+    if (!text || !byte_len || !out || !style) return nk_vec2(x_offset, 0);
 
     {int glyph_len = 0;
     nk_rune unicode = 0;
     int text_len = 0;
     float line_width = 0;
-    float glyph_width;
     const char *line = text;
     float line_offset = 0;
     int line_count = 0;
 
+    /* only lines overlapping the scissor rectangle are measured and drawn,
+     * with a font height of slack since text is centered inside its row */
+    float visible_top = out->clip.y - row_height - font->height;
+    float visible_bottom = out->clip.y + out->clip.h + font->height;
+
+    struct nk_text_advancer adv;
     struct nk_text txt;
     txt.padding = nk_vec2(0,0);
     txt.background = background;
@@ -97,10 +113,34 @@ nk_edit_draw_text(struct nk_command_buffer *out,
     foreground = nk_rgb_factor(foreground, style->color_factor);
     background = nk_rgb_factor(background, style->color_factor);
 
+    nk_text_advancer_init(&adv, font, text, byte_len);
     glyph_len = nk_utf_decode(text+text_len, &unicode, byte_len-text_len);
-    if (!glyph_len) return;
+    if (!glyph_len) return nk_vec2(x_offset, 0);
     while ((text_len < byte_len) && glyph_len)
     {
+        if (line == text + text_len) {
+            float y = pos_y + line_offset;
+            if (y >= visible_bottom) {
+                /* everything left is below the visible area */
+                line_width = 0;
+                break;
+            }
+            if (y <= visible_top) {
+                /* line is above the visible area: skip to the next line break */
+                while (text_len < byte_len && text[text_len] != '\n')
+                    text_len++;
+                if (text_len >= byte_len) {
+                    line_width = 0;
+                    break;
+                }
+                text_len++;
+                line_count++;
+                line = text + text_len;
+                line_offset += row_height;
+                glyph_len = nk_utf_decode(text + text_len, &unicode, byte_len-text_len);
+                continue;
+            }
+        }
         if (unicode == '\n') {
             /* new line separator so draw previous line */
             struct nk_rect label;
@@ -113,7 +153,7 @@ nk_edit_draw_text(struct nk_command_buffer *out,
 
             if (is_selected) /* selection needs to draw different background color */
                 nk_fill_rect(out, label, 0, background);
-            nk_widget_text(out, label, line, (int)((text + text_len) - line),
+            nk_edit_draw_line(out, label, line, (int)((text + text_len) - line),
                 &txt, NK_TEXT_CENTERED, font);
 
             text_len++;
@@ -129,8 +169,7 @@ nk_edit_draw_text(struct nk_command_buffer *out,
             glyph_len = nk_utf_decode(text + text_len, &unicode, byte_len-text_len);
             continue;
         }
-        glyph_width = font->width(font->userdata, font->height, text+text_len, glyph_len);
-        line_width += (float)glyph_width;
+        line_width += nk_text_advancer_next(&adv, text_len, glyph_len);
         text_len += glyph_len;
         glyph_len = nk_utf_decode(text + text_len, &unicode, byte_len-text_len);
         continue;
@@ -147,9 +186,140 @@ nk_edit_draw_text(struct nk_command_buffer *out,
 
         if (is_selected)
             nk_fill_rect(out, label, 0, background);
-        nk_widget_text(out, label, line, (int)((text + text_len) - line),
+        nk_edit_draw_line(out, label, line, (int)((text + text_len) - line),
             &txt, NK_TEXT_LEFT, font);
-    }}
+    }
+    return nk_vec2(((line_count) ? 0: x_offset) + line_width, line_offset);}
+}
+NK_INTERN void
+nk_edit_draw_str(struct nk_command_buffer *out,
+    const struct nk_style_edit *style, float pos_x, float pos_y,
+    float x_offset, const struct nk_str *str, int begin, int end,
+    float row_height, const struct nk_user_font *font,
+    struct nk_color background, struct nk_color foreground, nk_bool is_selected)
+{
+    /* draws the bytes [begin, end) of `str` one piece around the gap at a time */
+    while (begin < end) {
+        int n;
+        struct nk_vec2 next;
+        const char *text = nk_str_span(str, begin, &n);
+        if (!text) break;
+        n = NK_MIN(n, end - begin);
+        next = nk_edit_draw_text(out, style, pos_x, pos_y, x_offset, text, n,
+            row_height, font, background, foreground, is_selected);
+        pos_y += next.y;
+        x_offset = next.x;
+        begin += n;
+    }
+}
+NK_INTERN float
+nk_edit_str_width(const struct nk_user_font *font, const struct nk_str *str,
+    int begin, int end)
+{
+    float width = 0;
+    while (begin < end) {
+        int n;
+        const char *text = nk_str_span(str, begin, &n);
+        if (!text) break;
+        n = NK_MIN(n, end - begin);
+        width += font->width(font->userdata, font->height, text, n);
+        begin += n;
+    }
+    return width;
+}
+NK_INTERN int
+nk_edit_str_lines(const struct nk_str *str, int end, int *line_begin)
+{
+    /* counts the line breaks in front of byte `end`, line breaks are single
+     * bytes in utf-8. `line_begin` is set to the start of the last line */
+    int count = 0;
+    int at = 0;
+    if (line_begin) *line_begin = 0;
+    while (at < end) {
+        int n, i;
+        const char *text = nk_str_span(str, at, &n);
+        if (!text) break;
+        n = NK_MIN(n, end - at);
+        for (i = 0; i < n; ++i) {
+            if (text[i] != '\n') continue;
+            if (line_begin) *line_begin = at + i + 1;
+            count++;
+        }
+        at += n;
+    }
+    return count;
+}
+NK_INTERN void
+nk_edit_draw_rows(struct nk_command_buffer *out, const struct nk_style_edit *style,
+    struct nk_text_edit *edit, float pos_x, float pos_y, float row_height,
+    const struct nk_user_font *font, int sel_begin, int sel_end,
+    struct nk_color background, struct nk_color foreground,
+    struct nk_color sel_background, struct nk_color sel_foreground)
+{
+    /* draws wrapped text row by row from the line table, each row in up to
+     * three parts: before, inside and behind the selection [sel_begin, sel_end).
+     * Only rows overlapping the scissor rectangle are visited. */
+    const struct nk_text_edit_line *line;
+    struct nk_str *str = &edit->string;
+    int row, last, at;
+
+    if (!str->len || row_height <= 0 || !edit->lines.count) return;
+    line = (const struct nk_text_edit_line*)edit->lines.buffer.memory.ptr;
+    row = (int)((out->clip.y - font->height - pos_y) / row_height) - 1;
+    last = (int)((out->clip.y + out->clip.h + font->height - pos_y) / row_height) + 1;
+    row = NK_CLAMP(0, row, edit->lines.count-1);
+    last = NK_CLAMP(0, last, edit->lines.count-1);
+    at = nk_str_rune_offset(str, line[row].begin);
+
+    for (; at >= 0 && row <= last; ++row) {
+        float y = pos_y + (float)row * row_height;
+        int begin = line[row].begin;
+        int next = (row + 1 < edit->lines.count) ? line[row+1].begin: str->len;
+        int a = NK_CLAMP(begin, sel_begin, next);
+        int b = NK_CLAMP(begin, sel_end, next);
+        int row_end = nk_str_rune_offset(str, next);
+        int sel_a = (a == begin) ? at: (a == next) ? row_end: nk_str_rune_offset(str, a);
+        int sel_b = (b == a) ? sel_a: (b == next) ? row_end: nk_str_rune_offset(str, b);
+        if (row_end < 0 || sel_a < 0 || sel_b < 0) break;
+
+        if (sel_a > at)
+            nk_edit_draw_str(out, style, pos_x, y, 0, str, at, sel_a,
+                row_height, font, background, foreground, nk_false);
+        if (sel_b > sel_a) {
+            float x = (sel_a > at) ? nk_edit_str_width(font, str, at, sel_a): 0;
+            nk_edit_draw_str(out, style, pos_x, y, x, str, sel_a, sel_b,
+                row_height, font, sel_background, sel_foreground, nk_true);
+        }
+        if (row_end > sel_b) {
+            float x = (sel_b > at) ? nk_edit_str_width(font, str, at, sel_b): 0;
+            nk_edit_draw_str(out, style, pos_x, y, x, str, sel_b, row_end,
+                row_height, font, background, foreground, nk_false);
+        }
+        at = row_end;
+    }
+}
+NK_INTERN int
+nk_edit_text_position(struct nk_text_edit *edit, int pos, int has_lines,
+    const struct nk_user_font *font, float row_height, struct nk_vec2 *out)
+{
+    /* calculates the 2D position of rune `pos` and returns its byte offset */
+    int row = 0;
+    int glyphs = 0;
+    int row_begin = 0;
+    int end = nk_str_len_char(&edit->string);
+    int at = nk_str_rune_offset(&edit->string, pos);
+
+    if (at < 0) at = end;
+    if (has_lines) {
+        const struct nk_text_edit_line *line;
+        line = (const struct nk_text_edit_line*)edit->lines.buffer.memory.ptr;
+        row = nk_textedit_lines_find(edit, pos);
+        if (row) row_begin = nk_str_rune_offset(&edit->string, line[row].begin);
+        if (row_begin < 0) row_begin = at;
+    } else row = nk_edit_str_lines(&edit->string, at, &row_begin);
+    out->x = nk_textedit_measure(&edit->string, row_begin, at, font, &glyphs, 0);
+    out->y = (float)row * row_height;
+    return at;
 }
 NK_LIB nk_flags
 nk_do_edit(nk_flags *state, struct nk_command_buffer *out,
@@ -182,6 +352,11 @@ nk_do_edit(nk_flags *state, struct nk_command_buffer *out,
         area.w = NK_MAX(0, area.w - style->scrollbar_size.x);
     row_height = (flags & NK_EDIT_MULTILINE)? font->height + style->row_padding: area.h;
 
+    /* soft wrapping lives in the line table, without one rows only end at
+     * line breaks */
+    edit->lines.wrap = ((flags & NK_EDIT_WORD_WRAP) && (flags & NK_EDIT_MULTILINE)) ?
+        NK_MAX(area.w - style->cursor_size, 1.0f): 0;
+
     /* calculate clipping rectangle */
     old_clip = out->clip;
     nk_unify(&clip, &old_clip, area.x, area.y, area.x + area.w, area.y + area.h);
@@ -286,7 +461,8 @@ nk_do_edit(nk_flags *state, struct nk_command_buffer *out,
 
             int begin = NK_MIN(b, e);
             int end = NK_MAX(b, e);
-            text = nk_str_at_const(&edit->string, begin, &unicode, &glyph_len);
+            /* the clipboard wants one piece so this closes the gap */
+            text = nk_str_at_rune(&edit->string, begin, &unicode, &glyph_len);
             if (edit->clip.copy)
                 edit->clip.copy(edit->clip.userdata, text, end - begin);
             if (cut && !(flags & NK_EDIT_READ_ONLY)){
@@ -319,8 +495,7 @@ nk_do_edit(nk_flags *state, struct nk_command_buffer *out,
         *state |= NK_WIDGET_STATE_HOVERED;
 
     /* DRAW EDIT */
-    {const char *text = nk_str_get_const(&edit->string);
-    int len = nk_str_len_char(&edit->string);
+    {int len = nk_str_len_char(&edit->string);
 
     {/* select background colors/images  */
     const struct nk_style_item *background;
@@ -351,10 +526,9 @@ nk_do_edit(nk_flags *state, struct nk_command_buffer *out,
         int total_lines = 1;
         struct nk_vec2 text_size = nk_vec2(0,0);
 
-        /* text pointer positions */
-        const char *cursor_ptr = 0;
-        const char *select_begin_ptr = 0;
-        const char *select_end_ptr = 0;
+        /* text byte offsets */
+        int select_begin_at = 0;
+        int select_end_at = len;
 
         /* 2D pixel positions */
         struct nk_vec2 cursor_pos = nk_vec2(0,0);
@@ -363,113 +537,35 @@ nk_do_edit(nk_flags *state, struct nk_command_buffer *out,
 
         int selection_begin = NK_MIN(edit->select_start, edit->select_end);
         int selection_end = NK_MAX(edit->select_start, edit->select_end);
+        int has_lines = 0;
 
         /* calculate total line count + total space + cursor/selection position */
-        float line_width = 0.0f;
-        if (text && len)
+        if (len)
         {
-            /* utf8 encoding */
-            float glyph_width;
-            int glyph_len = 0;
-            nk_rune unicode = 0;
-            int text_len = 0;
-            int glyphs = 0;
-            int row_begin = 0;
-
-            glyph_len = nk_utf_decode(text, &unicode, len);
-            glyph_width = font->width(font->userdata, font->height, text, glyph_len);
-            line_width = 0;
-
-            /* iterate all lines */
-            while ((text_len < len) && glyph_len)
-            {
-                /* set cursor 2D position and line */
-                if (!cursor_ptr && glyphs == edit->cursor)
-                {
-                    int glyph_offset;
-                    struct nk_vec2 out_offset;
-                    struct nk_vec2 row_size;
-                    const char *remaining;
-
-                    /* calculate 2d position */
-                    cursor_pos.y = (float)(total_lines-1) * row_height;
-                    row_size = nk_text_calculate_text_bounds(font, text+row_begin,
-                                text_len-row_begin, row_height, &remaining,
-                                &out_offset, &glyph_offset, NK_STOP_ON_NEW_LINE);
-                    cursor_pos.x = row_size.x;
-                    cursor_ptr = text + text_len;
-                }
-
-                /* set start selection 2D position and line */
-                if (!select_begin_ptr && edit->select_start != edit->select_end &&
-                    glyphs == selection_begin)
-                {
-                    int glyph_offset;
-                    struct nk_vec2 out_offset;
-                    struct nk_vec2 row_size;
-                    const char *remaining;
-
-                    /* calculate 2d position */
-                    selection_offset_start.y = (float)(NK_MAX(total_lines-1,0)) * row_height;
-                    row_size = nk_text_calculate_text_bounds(font, text+row_begin,
-                                text_len-row_begin, row_height, &remaining,
-                                &out_offset, &glyph_offset, NK_STOP_ON_NEW_LINE);
-                    selection_offset_start.x = row_size.x;
-                    select_begin_ptr = text + text_len;
-                }
-
-                /* set end selection 2D position and line */
-                if (!select_end_ptr && edit->select_start != edit->select_end &&
-                    glyphs == selection_end)
-                {
-                    int glyph_offset;
-                    struct nk_vec2 out_offset;
-                    struct nk_vec2 row_size;
-                    const char *remaining;
-
-                    /* calculate 2d position */
-                    selection_offset_end.y = (float)(total_lines-1) * row_height;
-                    row_size = nk_text_calculate_text_bounds(font, text+row_begin,
-                                text_len-row_begin, row_height, &remaining,
-                                &out_offset, &glyph_offset, NK_STOP_ON_NEW_LINE);
-                    selection_offset_end.x = row_size.x;
-                    select_end_ptr = text + text_len;
-                }
-                if (unicode == '\n') {
-                    text_size.x = NK_MAX(text_size.x, line_width);
-                    total_lines++;
-                    line_width = 0;
-                    text_len++;
-                    glyphs++;
-                    row_begin = text_len;
-                    glyph_len = nk_utf_decode(text + text_len, &unicode, len-text_len);
-                    glyph_width = font->width(font->userdata, font->height, text+text_len, glyph_len);
-                    continue;
-                }
-
-                glyphs++;
-                text_len += glyph_len;
-                line_width += (float)glyph_width;
-
-                glyph_len = nk_utf_decode(text + text_len, &unicode, len-text_len);
-                glyph_width = font->width(font->userdata, font->height,
-                    text+text_len, glyph_len);
-                continue;
-            }
+            has_lines = nk_textedit_lines_sync(edit, font);
+            if (has_lines)
+                total_lines = edit->lines.count;
+            else total_lines += nk_edit_str_lines(&edit->string, len, 0);
             text_size.y = (float)total_lines * row_height;
 
-            /* handle case when cursor is at end of text buffer */
-            if (!cursor_ptr && edit->cursor == edit->string.len) {
-                cursor_pos.x = line_width;
-                cursor_pos.y = text_size.y - row_height;
+            nk_edit_text_position(edit, edit->cursor, has_lines,
+                font, row_height, &cursor_pos);
+            if (edit->select_start != edit->select_end) {
+                select_begin_at = nk_edit_text_position(edit, selection_begin,
+                    has_lines, font, row_height, &selection_offset_start);
+                select_end_at = nk_edit_text_position(edit, selection_end,
+                    has_lines, font, row_height, &selection_offset_end);
             }
         }
         {
             /* scrollbar */
+            int wrapped = has_lines && edit->lines.wrapped > 0;
+            if (wrapped) /* wrapped rows always fit horizontally */
+                edit->scrollbar.x = 0;
             if (cursor_follow)
             {
                 /* update scrollbar to follow cursor */
-                if (!(flags & NK_EDIT_NO_HORIZONTAL_SCROLL)) {
+                if (!(flags & NK_EDIT_NO_HORIZONTAL_SCROLL) && !wrapped) {
                     /* horizontal scroll */
                     const float scroll_increment = area.w * 0.25f;
                     if (cursor_pos.x < edit->scrollbar.x)
@@ -558,50 +654,58 @@ nk_do_edit(nk_flags *state, struct nk_command_buffer *out,
         cursor_color = nk_rgb_factor(cursor_color, style->color_factor);
         cursor_text_color = nk_rgb_factor(cursor_text_color, style->color_factor);
 
-        if (edit->select_start == edit->select_end) {
+        if (has_lines && edit->lines.wrapped > 0) {
+            /* soft wrapped text is drawn from the rows of the line table */
+            nk_edit_draw_rows(out, style, edit, area.x, area.y - edit->scrollbar.y,
+                row_height, font, selection_begin, selection_end,
+                background_color, text_color, sel_background_color, sel_text_color);
+        } else if (edit->select_start == edit->select_end) {
             /* no selection so just draw the complete text */
-            const char *begin = nk_str_get_const(&edit->string);
-            int l = nk_str_len_char(&edit->string);
-            nk_edit_draw_text(out, style, area.x - edit->scrollbar.x,
-                area.y - edit->scrollbar.y, 0, begin, l, row_height, font,
+            int begin = 0;
+            float y = area.y - edit->scrollbar.y;
+            if (has_lines && row_height > 0) {
+                /* start at the first visible line instead of scanning to it */
+                const struct nk_text_edit_line *line;
+                int row = (int)((clip.y - font->height - y) / row_height) - 1;
+                row = NK_CLAMP(0, row, edit->lines.count-1);
+                line = (const struct nk_text_edit_line*)edit->lines.buffer.memory.ptr;
+                if (row) {
+                    int first = nk_str_rune_offset(&edit->string, line[row].begin);
+                    if (first >= 0) {
+                        begin = first;
+                        y += (float)row * row_height;
+                    }
+                }
+            }
+            nk_edit_draw_str(out, style, area.x - edit->scrollbar.x,
+                y, 0, &edit->string, begin, len, row_height, font,
                 background_color, text_color, nk_false);
         } else {
             /* edit has selection so draw 1-3 text chunks */
             if (edit->select_start != edit->select_end && selection_begin > 0){
                 /* draw unselected text before selection */
-                const char *begin = nk_str_get_const(&edit->string);
-                NK_ASSERT(select_begin_ptr);
-                nk_edit_draw_text(out, style, area.x - edit->scrollbar.x,
-                    area.y - edit->scrollbar.y, 0, begin, (int)(select_begin_ptr - begin),
+                nk_edit_draw_str(out, style, area.x - edit->scrollbar.x,
+                    area.y - edit->scrollbar.y, 0, &edit->string, 0, select_begin_at,
                     row_height, font, background_color, text_color, nk_false);
             }
             if (edit->select_start != edit->select_end) {
                 /* draw selected text */
-                NK_ASSERT(select_begin_ptr);
-                if (!select_end_ptr) {
-                    const char *begin = nk_str_get_const(&edit->string);
-                    select_end_ptr = begin + nk_str_len_char(&edit->string);
-                }
-                nk_edit_draw_text(out, style,
+                nk_edit_draw_str(out, style,
                     area.x - edit->scrollbar.x,
                     area.y + selection_offset_start.y - edit->scrollbar.y,
                     selection_offset_start.x,
-                    select_begin_ptr, (int)(select_end_ptr - select_begin_ptr),
+                    &edit->string, select_begin_at, select_end_at,
                     row_height, font, sel_background_color, sel_text_color, nk_true);
             }
             if ((edit->select_start != edit->select_end &&
                 selection_end < edit->string.len))
             {
                 /* draw unselected text after selected text */
-                const char *begin = select_end_ptr;
-                const char *end = nk_str_get_const(&edit->string) +
-                                    nk_str_len_char(&edit->string);
-                NK_ASSERT(select_end_ptr);
-                nk_edit_draw_text(out, style,
+                nk_edit_draw_str(out, style,
                     area.x - edit->scrollbar.x,
                     area.y + selection_offset_end.y - edit->scrollbar.y,
                     selection_offset_end.x,
-                    begin, (int)(end - begin), row_height, font,
+                    &edit->string, select_end_at, len, row_height, font,
                     background_color, text_color, nk_true);
             }
         }
@@ -609,8 +713,12 @@ nk_do_edit(nk_flags *state, struct nk_command_buffer *out,
         /* cursor */
         if (edit->select_start == edit->select_end)
         {
-            if (edit->cursor >= nk_str_len(&edit->string) ||
-                (cursor_ptr && *cursor_ptr == '\n')) {
+            int glyph_len = 0;
+            nk_rune unicode = 0;
+            const char *glyph = 0;
+            if (edit->cursor < nk_str_len(&edit->string))
+                glyph = nk_str_at_const(&edit->string, edit->cursor, &unicode, &glyph_len);
+            if (!glyph || unicode == '\n') {
                 /* draw cursor at end of line */
                 struct nk_rect cursor;
                 cursor.w = style->cursor_size;
@@ -621,31 +729,24 @@ nk_do_edit(nk_flags *state, struct nk_command_buffer *out,
                 nk_fill_rect(out, cursor, 0, cursor_color);
             } else {
                 /* draw cursor inside text */
-                int glyph_len;
                 struct nk_rect label;
                 struct nk_text txt;
 
-                nk_rune unicode;
-                NK_ASSERT(cursor_ptr);
-                glyph_len = nk_utf_decode(cursor_ptr, &unicode, 4);
-
                 label.x = area.x + cursor_pos.x - edit->scrollbar.x;
                 label.y = area.y + cursor_pos.y - edit->scrollbar.y;
-                label.w = font->width(font->userdata, font->height, cursor_ptr, glyph_len);
+                label.w = font->width(font->userdata, font->height, glyph, glyph_len);
                 label.h = row_height;
 
                 txt.padding = nk_vec2(0,0);
                 txt.background = cursor_color;;
                 txt.text = cursor_text_color;
                 nk_fill_rect(out, label, 0, cursor_color);
-                nk_widget_text(out, label, cursor_ptr, glyph_len, &txt, NK_TEXT_LEFT, font);
+                nk_widget_text(out, label, glyph, glyph_len, &txt, NK_TEXT_LEFT, font);
             }
         }}
     } else {
         /* not active so just draw text */
-        int l = nk_str_len_char(&edit->string);
-        const char *begin = nk_str_get_const(&edit->string);
-
+        int l = len;
         const struct nk_style_item *background;
         struct nk_color background_color;
         struct nk_color text_color;
@@ -668,8 +769,17 @@ nk_do_edit(nk_flags *state, struct nk_command_buffer *out,
         background_color = nk_rgb_factor(background_color, style->color_factor);
         text_color = nk_rgb_factor(text_color, style->color_factor);
 
-        nk_edit_draw_text(out, style, area.x - edit->scrollbar.x,
-            area.y - edit->scrollbar.y, 0, begin, l, row_height, font,
+        if (edit->lines.wrap > 0 && l) {
+            /* wrapped text needs its rows even if nobody is typing */
+            if (nk_textedit_lines_sync(edit, font)) {
+                nk_edit_draw_rows(out, style, edit, area.x, area.y - edit->scrollbar.y,
+                    row_height, font, 0, 0, background_color, text_color,
+                    background_color, text_color);
+                l = 0;
+            }
+        }
+        if (l) nk_edit_draw_str(out, style, area.x - edit->scrollbar.x,
+            area.y - edit->scrollbar.y, 0, &edit->string, 0, l, row_height, font,
             background_color, text_color, nk_false);
     }
     nk_push_scissor(out, old_clip);}
@@ -704,6 +814,58 @@ nk_edit_unfocus(struct nk_context *ctx)
     win->edit.active = nk_false;
     win->edit.name = 0;
 }
+NK_INTERN struct nk_edit_lines*
+nk_edit_lines(struct nk_context *ctx, struct nk_window *win, nk_hash name)
+{
+    /* line table of the edit widget `name`, created on first use */
+    struct nk_page_element *elem;
+    struct nk_edit_lines *it;
+    for (it = win->edit_lines; it; it = it->next)
+        if (it->name == name) break;
+    if (!it) {
+        elem = nk_create_page_element(ctx);
+        if (!elem) return 0;
+        it = &elem->data.lines;
+        it->name = name;
+        nk_buffer_init(&it->lines.buffer, &ctx->memory.pool,
+            16 * sizeof(struct nk_text_edit_line));
+        it->next = win->edit_lines;
+        win->edit_lines = it;
+    }
+    it->seq = ctx->seq;
+    return it;
+}
+NK_INTERN void
+nk_edit_lines_release(struct nk_context *ctx, struct nk_edit_lines *lines)
+{
+    union nk_page_data *pd = NK_CONTAINER_OF(lines, union nk_page_data, lines);
+    nk_buffer_free(&lines->lines.buffer);
+    nk_free_page_element(ctx, NK_CONTAINER_OF(pd, struct nk_page_element, data));
+}
+NK_LIB void
+nk_collect_edit_lines(struct nk_context *ctx, struct nk_window *win)
+{
+    /* frees the line tables of widgets not built this frame */
+    struct nk_edit_lines **it = &win->edit_lines;
+    while (*it) {
+        struct nk_edit_lines *lines = *it;
+        if (lines->seq == ctx->seq) {
+            it = &lines->next;
+            continue;
+        }
+        *it = lines->next;
+        nk_edit_lines_release(ctx, lines);
+    }
+}
+NK_LIB void
+nk_free_edit_lines(struct nk_context *ctx, struct nk_window *win)
+{
+    while (win->edit_lines) {
+        struct nk_edit_lines *lines = win->edit_lines;
+        win->edit_lines = lines->next;
+        nk_edit_lines_release(ctx, lines);
+    }
+}
 NK_API nk_flags
 nk_edit_string(struct nk_context *ctx, nk_flags flags,
     char *memory, int *len, int max, nk_plugin_filter filter)
@@ -711,6 +873,7 @@ nk_edit_string(struct nk_context *ctx, nk_flags flags,
     nk_hash hash;
     nk_flags state;
     struct nk_text_edit *edit;
+    struct nk_edit_lines *lines = 0;
     struct nk_window *win;
 
     NK_ASSERT(ctx);
@@ -725,6 +888,16 @@ nk_edit_string(struct nk_context *ctx, nk_flags flags,
     edit = &ctx->text_edit;
     nk_textedit_clear_state(&ctx->text_edit, (flags & NK_EDIT_MULTILINE)?
         NK_TEXT_EDIT_MULTI_LINE: NK_TEXT_EDIT_SINGLE_LINE, filter);
+    /* every widget brings its own line table into the shared text editor */
+    if (ctx->memory.type == NK_BUFFER_DYNAMIC)
+        lines = nk_edit_lines(ctx, win, hash);
+    if (lines) {
+        /* another buffer is another text even if it has the same length */
+        if (lines->memory != memory)
+            lines->lines.count = 0;
+        lines->memory = memory;
+        edit->lines = lines->lines;
+    } else nk_zero_struct(edit->lines);
 
     if (win->edit.active && hash == win->edit.name) {
         if (flags & NK_EDIT_NO_CURSOR)
@@ -750,6 +923,8 @@ nk_edit_string(struct nk_context *ctx, nk_flags flags,
     edit->string.len = nk_utf_len(memory, *len);
     state = nk_edit_buffer(ctx, flags, edit, filter);
     *len = (int)edit->string.buffer.allocated;
+    if (lines) lines->lines = edit->lines;
+    nk_zero_struct(edit->lines);
 
     if (edit->active) {
         win->edit.cursor = edit->cursor;
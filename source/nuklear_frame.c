@@ -0,0 +1,170 @@
+#include "nuklear.h"
+#include "nuklear_internal.h"
+
+/* ===============================================================
+ *
+ *                          FRAME ARENA
+ *
+ * ===============================================================*/
+#define NK_FRAME_ROUND(s) (((s) + (NK_FRAME_ALIGNMENT-1)) & ~(nk_size)(NK_FRAME_ALIGNMENT-1))
+
+NK_INTERN nk_byte*
+nk_frame_block_memory(struct nk_frame_block *block)
+{
+    /* round the data up so every offset that is a multiple of the
+     * alignment gives an aligned address */
+    nk_byte *memory = (nk_byte*)(block + 1);
+    return (nk_byte*)NK_ALIGN_PTR(memory, NK_FRAME_ALIGNMENT);
+}
+NK_INTERN void*
+nk_frame_reserve(struct nk_frame_arena *arena, nk_size size)
+{
+    struct nk_frame_block *block;
+    nk_size capacity;
+
+    NK_ASSERT(arena);
+    if (!arena) return 0;
+    if (arena->blocks && arena->blocks->size - arena->used >= size)
+        return nk_frame_block_memory(arena->blocks) + arena->used;
+    if (!arena->alloc.alloc) return 0;
+
+    /* start a new block, sized so a frame like the busiest one so far fits
+     * a single block once `nk_frame_reset` folds them together */
+    capacity = NK_MAX(NK_FRAME_BLOCK_SIZE, NK_FRAME_ROUND(size));
+    capacity = NK_MAX(capacity, arena->high_water);
+    if (arena->blocks)
+        capacity = NK_MAX(capacity, arena->blocks->size * 2);
+    block = (struct nk_frame_block*)arena->alloc.alloc(arena->alloc.userdata, 0,
+        sizeof(struct nk_frame_block) + NK_FRAME_ALIGNMENT + capacity);
+    NK_ASSERT(block);
+    if (!block) return 0;
+    block->size = capacity;
+    block->next = arena->blocks;
+    arena->blocks = block;
+    arena->used = 0;
+    return nk_frame_block_memory(block);
+}
+NK_INTERN void
+nk_frame_commit(struct nk_frame_arena *arena, nk_size size)
+{
+    /* keep `used` a multiple of the alignment for the next allocation */
+    size = NK_MIN(NK_FRAME_ROUND(size), arena->blocks->size - arena->used);
+    arena->used += size;
+    arena->allocated += size;
+}
+NK_API void*
+nk_frame_alloc(struct nk_context *ctx, nk_size size)
+{
+    void *memory;
+    NK_ASSERT(ctx);
+    if (!ctx) return 0;
+    memory = nk_frame_reserve(&ctx->frame, size);
+    if (!memory) return 0;
+    nk_frame_commit(&ctx->frame, size);
+    return memory;
+}
+NK_API void
+nk_frame_init_fixed(struct nk_context *ctx, void *memory, nk_size size)
+{
+    struct nk_frame_arena *arena;
+    struct nk_frame_block *block;
+    nk_byte *begin;
+
+    NK_ASSERT(ctx);
+    NK_ASSERT(memory);
+    if (!ctx || !memory) return;
+    arena = &ctx->frame;
+    nk_frame_trim(arena);
+    nk_zero_struct(arena->alloc);
+
+    block = (struct nk_frame_block*)NK_ALIGN_PTR(memory, NK_ALIGNOF(struct nk_frame_block));
+    begin = nk_frame_block_memory(block);
+    NK_ASSERT(begin <= (nk_byte*)memory + size);
+    if (begin > (nk_byte*)memory + size) return;
+    block->next = 0;
+    block->size = (nk_size)((nk_byte*)memory + size - begin) & ~(nk_size)(NK_FRAME_ALIGNMENT-1);
+    arena->blocks = block;
+    arena->used = 0;
+    arena->allocated = 0;
+}
+NK_API nk_size
+nk_frame_high_water(const struct nk_context *ctx)
+{
+    NK_ASSERT(ctx);
+    if (!ctx) return 0;
+    return NK_MAX(ctx->frame.high_water, ctx->frame.allocated);
+}
+#ifdef NK_INCLUDE_STANDARD_VARARGS
+NK_API const char*
+nk_frame_vprintf(struct nk_context *ctx, const char *fmt, va_list args)
+{
+    struct nk_frame_arena *arena;
+    nk_size size;
+
+    NK_ASSERT(ctx);
+    NK_ASSERT(fmt);
+    if (!ctx || !fmt) return 0;
+    arena = &ctx->frame;
+
+    /* format into whatever is left of the current block and only ask for a
+     * bigger block if the string did not fit */
+    size = (arena->blocks) ? arena->blocks->size - arena->used: 0;
+    size = NK_CLAMP(64, size, 1024*1024);
+    while (size <= 0x3fffffff) {
+        char *buf = (char*)nk_frame_reserve(arena, size);
+        va_list copy;
+        int len;
+
+        if (!buf) return 0;
+        va_copy(copy, args);
+        len = nk_strfmt(buf, (int)size, fmt, copy);
+        va_end(copy);
+        if (len >= 0) {
+            nk_frame_commit(arena, (nk_size)len + 1);
+            return buf;
+        }
+        size *= 2;
+    }
+    return 0;
+}
+NK_API const char*
+nk_frame_printf(struct nk_context *ctx, const char *fmt, ...)
+{
+    const char *result;
+    va_list args;
+    va_start(args, fmt);
+    result = nk_frame_vprintf(ctx, fmt, args);
+    va_end(args);
+    return result;
+}
+#endif
+NK_LIB void
+nk_frame_reset(struct nk_frame_arena *arena)
+{
+    NK_ASSERT(arena);
+    if (!arena) return;
+    arena->high_water = NK_MAX(arena->high_water, arena->allocated);
+    if (arena->blocks && arena->blocks->next && arena->alloc.free) {
+        /* the frame spilled into more than one block: give them all back so
+         * the next frame allocates a single block of `high_water` bytes */
+        nk_frame_trim(arena);
+    }
+    arena->used = 0;
+    arena->allocated = 0;
+}
+NK_LIB nk_size
+nk_frame_trim(struct nk_frame_arena *arena)
+{
+    nk_size released = 0;
+    NK_ASSERT(arena);
+    if (!arena || !arena->alloc.free) return 0;
+    while (arena->blocks) {
+        struct nk_frame_block *next = arena->blocks->next;
+        released += arena->blocks->size;
+        arena->alloc.free(arena->alloc.userdata, arena->blocks);
+        arena->blocks = next;
+    }
+    arena->used = 0;
+    arena->allocated = 0;
+    return released;
+}
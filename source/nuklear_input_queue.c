@@ -0,0 +1,224 @@
+#include "nuklear.h"
+#include "nuklear_internal.h"
+
+#ifdef NK_INCLUDE_INPUT_QUEUE
+#if defined(__GNUC__) || defined(__clang__)
+  #define NK_ATOMIC_LOAD(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+  #define NK_ATOMIC_STORE(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+  #define NK_ATOMIC_CAS(p, expected, desired)\
+    __atomic_compare_exchange_n(p, expected, desired, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#elif defined(_MSC_VER)
+  #include <intrin.h>
+  #ifdef _WIN64
+    #define NK_ATOMIC_EXCHANGE(p, expected, desired) (nk_size)_InterlockedCompareExchange64(\
+        (volatile __int64*)(p), (__int64)(desired), (__int64)(expected))
+  #else
+    #define NK_ATOMIC_EXCHANGE(p, expected, desired) (nk_size)_InterlockedCompareExchange(\
+        (volatile long*)(p), (long)(desired), (long)(expected))
+  #endif
+  #define NK_ATOMIC_LOAD(p) NK_ATOMIC_EXCHANGE(p, 0, 0)
+  #define NK_ATOMIC_STORE(p, v) do {_ReadWriteBarrier(); *(volatile nk_size*)(p) = (v);} while (0)
+  NK_INTERN nk_bool
+  nk_atomic_cas(nk_size *p, nk_size *expected, nk_size desired)
+  {
+      nk_size previous = NK_ATOMIC_EXCHANGE(p, *expected, desired);
+      if (previous == *expected) return nk_true;
+      *expected = previous;
+      return nk_false;
+  }
+  #define NK_ATOMIC_CAS(p, expected, desired) nk_atomic_cas(p, expected, desired)
+#else
+  #error "NK_INCLUDE_INPUT_QUEUE needs atomic operations which are only provided for gcc, clang and msvc"
+#endif
+
+/* ===============================================================
+ *
+ *                          INPUT QUEUE
+ *
+ * ===============================================================*/
+NK_STATIC_ASSERT((NK_INPUT_QUEUE_SIZE & (NK_INPUT_QUEUE_SIZE - 1)) == 0);
+#define NK_INPUT_QUEUE_MASK ((nk_size)NK_INPUT_QUEUE_SIZE - 1)
+/* wrap safe `a < b` on the running slot counters */
+#define NK_INPUT_QUEUE_BEFORE(a, b) ((nk_size)((a) - (b)) > (~(nk_size)0 >> 1))
+
+NK_API void
+nk_input_queue_init(struct nk_input_queue *queue)
+{
+    nk_size i;
+    NK_ASSERT(queue);
+    if (!queue) return;
+    /* a slot can be written when its `seq` equals the position claiming it
+     * and read when it is one more than that */
+    for (i = 0; i < NK_INPUT_QUEUE_SIZE; ++i)
+        queue->slots[i].seq = i;
+    queue->head = 0;
+    queue->tail = 0;
+}
+NK_API nk_bool
+nk_input_queue_push(struct nk_input_queue *queue, const struct nk_input_event *event)
+{
+    struct nk_input_queue_slot *slot;
+    nk_size pos;
+
+    NK_ASSERT(queue);
+    NK_ASSERT(event);
+    if (!queue || !event) return nk_false;
+
+    pos = NK_ATOMIC_LOAD(&queue->head);
+    for (;;) {
+        nk_size seq;
+        slot = &queue->slots[pos & NK_INPUT_QUEUE_MASK];
+        seq = NK_ATOMIC_LOAD(&slot->seq);
+        if (seq == pos) {
+            /* claim the slot; on failure `pos` holds the new head */
+            if (NK_ATOMIC_CAS(&queue->head, &pos, pos + 1))
+                break;
+        } else if (NK_INPUT_QUEUE_BEFORE(seq, pos)) {
+            /* the slot still holds an event from the last lap */
+            return nk_false;
+        } else pos = NK_ATOMIC_LOAD(&queue->head);
+    }
+    slot->event = *event;
+    NK_ATOMIC_STORE(&slot->seq, pos + 1);
+    return nk_true;
+}
+NK_API nk_bool
+nk_input_queue_motion(struct nk_input_queue *queue, double time, int x, int y)
+{
+    struct nk_input_event event;
+    event.type = NK_INPUT_EVENT_MOTION;
+    event.time = time;
+    event.data.motion.x = x;
+    event.data.motion.y = y;
+    return nk_input_queue_push(queue, &event);
+}
+NK_API nk_bool
+nk_input_queue_button(struct nk_input_queue *queue, double time,
+    enum nk_buttons id, int x, int y, nk_bool down)
+{
+    struct nk_input_event event;
+    event.type = NK_INPUT_EVENT_BUTTON;
+    event.time = time;
+    event.data.button.id = id;
+    event.data.button.x = x;
+    event.data.button.y = y;
+    event.data.button.down = down;
+    return nk_input_queue_push(queue, &event);
+}
+NK_API nk_bool
+nk_input_queue_key(struct nk_input_queue *queue, double time,
+    enum nk_keys key, nk_bool down)
+{
+    struct nk_input_event event;
+    event.type = NK_INPUT_EVENT_KEY;
+    event.time = time;
+    event.data.key.id = key;
+    event.data.key.down = down;
+    return nk_input_queue_push(queue, &event);
+}
+NK_API nk_bool
+nk_input_queue_scroll(struct nk_input_queue *queue, double time, struct nk_vec2 val)
+{
+    struct nk_input_event event;
+    event.type = NK_INPUT_EVENT_SCROLL;
+    event.time = time;
+    event.data.scroll = val;
+    return nk_input_queue_push(queue, &event);
+}
+NK_API nk_bool
+nk_input_queue_unicode(struct nk_input_queue *queue, double time, nk_rune unicode)
+{
+    struct nk_input_event event;
+    event.type = NK_INPUT_EVENT_UNICODE;
+    event.time = time;
+    event.data.unicode = unicode;
+    return nk_input_queue_push(queue, &event);
+}
+NK_INTERN nk_bool
+nk_input_event_fits(const struct nk_input *in, const struct nk_input_event *event)
+{
+    switch (event->type) {
+    case NK_INPUT_EVENT_BUTTON: {
+        /* a second change of a button within one frame would merge press
+         * and release of two clicks */
+        const struct nk_mouse_button *btn = &in->mouse.buttons[event->data.button.id];
+        return !btn->clicked || btn->down == event->data.button.down;
+    }
+    case NK_INPUT_EVENT_KEY:
+        /* key presses are only seen while the key is down in the same frame */
+        return !in->keyboard.keys[event->data.key.id].clicked;
+    case NK_INPUT_EVENT_UNICODE: {
+        nk_glyph glyph;
+        int len = nk_utf_encode(event->data.unicode, glyph, NK_UTF_SIZE);
+        return in->keyboard.text_len + len < NK_INPUT_MAX;
+    }
+    default: return nk_true;
+    }
+}
+NK_API int
+nk_input_drain(struct nk_context *ctx, struct nk_input_queue *queue, double time)
+{
+    const struct nk_input_event *motion = 0;
+    int count = 0;
+
+    NK_ASSERT(ctx);
+    NK_ASSERT(queue);
+    if (!ctx || !queue) return 0;
+    for (;;) {
+        struct nk_input_queue_slot *slot;
+        const struct nk_input_event *event;
+        nk_size pos = queue->tail;
+
+        slot = &queue->slots[pos & NK_INPUT_QUEUE_MASK];
+        if (NK_ATOMIC_LOAD(&slot->seq) != pos + 1) break;
+        event = &slot->event;
+        if (event->time > time) break;
+        if (event->type == NK_INPUT_EVENT_MOTION) {
+            /* only the last position of a run of motion events matters. The
+             * slot is handed back once the run ended and it was applied */
+            if (motion) {
+                NK_ATOMIC_STORE(&queue->slots[(pos - 1) & NK_INPUT_QUEUE_MASK].seq,
+                    pos - 1 + NK_INPUT_QUEUE_SIZE);
+            }
+            motion = event;
+            queue->tail = pos + 1;
+            count++;
+            continue;
+        }
+        if (motion) {
+            nk_input_motion(ctx, motion->data.motion.x, motion->data.motion.y);
+            NK_ATOMIC_STORE(&queue->slots[(pos - 1) & NK_INPUT_QUEUE_MASK].seq,
+                pos - 1 + NK_INPUT_QUEUE_SIZE);
+            motion = 0;
+        }
+        if (!nk_input_event_fits(&ctx->input, event)) break;
+
+        switch (event->type) {
+        case NK_INPUT_EVENT_BUTTON:
+            nk_input_button(ctx, event->data.button.id, event->data.button.x,
+                event->data.button.y, event->data.button.down);
+            break;
+        case NK_INPUT_EVENT_KEY:
+            nk_input_key(ctx, event->data.key.id, event->data.key.down);
+            break;
+        case NK_INPUT_EVENT_SCROLL:
+            nk_input_scroll(ctx, event->data.scroll);
+            break;
+        case NK_INPUT_EVENT_UNICODE:
+            nk_input_unicode(ctx, event->data.unicode);
+            break;
+        default: break;
+        }
+        /* hand the slot back to the producers one lap ahead */
+        NK_ATOMIC_STORE(&slot->seq, pos + NK_INPUT_QUEUE_SIZE);
+        queue->tail = pos + 1;
+        count++;
+    }
+    if (motion) {
+        nk_input_motion(ctx, motion->data.motion.x, motion->data.motion.y);
+        NK_ATOMIC_STORE(&queue->slots[(queue->tail - 1) & NK_INPUT_QUEUE_MASK].seq,
+            queue->tail - 1 + NK_INPUT_QUEUE_SIZE);
+    }
+    return count;
+}
+#endif
@@ -37,12 +37,8 @@ nk_link_page_element_into_freelist(struct nk_context *ctx,
     struct nk_page_element *elem)
 {
     /* link table into freelist */
-    if (!ctx->freelist) {
-        ctx->freelist = elem;
-    } else {
-        elem->next = ctx->freelist;
-        ctx->freelist = elem;
-    }
+    elem->next = ctx->freelist;
+    ctx->freelist = elem;
 }
 NK_LIB void
 nk_free_page_element(struct nk_context *ctx, struct nk_page_element *elem)
@@ -52,11 +48,11 @@ nk_free_page_element(struct nk_context *ctx, struct nk_page_element *elem)
         nk_link_page_element_into_freelist(ctx, elem);
         return;
     }
-    /* if possible remove last element from back of fixed memory buffer */
-    {void *elem_end = (void*)(elem + 1);
-    void *buffer_end = (nk_byte*)ctx->memory.memory.ptr + ctx->memory.size;
-    if (elem_end == buffer_end)
-        ctx->memory.size -= sizeof(struct nk_page_element);
+    /* if possible give the element at the start of the back of the fixed
+     * memory buffer back to it, the back grows towards lower addresses */
+    {void *back_begin = (nk_byte*)ctx->memory.memory.ptr + ctx->memory.size;
+    if ((void*)elem == back_begin)
+        ctx->memory.size += sizeof(struct nk_page_element);
     else nk_link_page_element_into_freelist(ctx, elem);}
 }
 
@@ -57,10 +57,58 @@ nk_pool_alloc(struct nk_pool *pool)
             nk_size size = sizeof(struct nk_page);
             size += (pool->capacity - 1) * sizeof(struct nk_page_element);
             page = (struct nk_page*)pool->alloc.alloc(pool->alloc.userdata,0, size);
+            NK_ASSERT(page);
+            if (!page) return 0;
             page->next = pool->pages;
             pool->pages = page;
             page->size = 0;
         }
     } return &pool->pages->win[pool->pages->size++];
 }
+NK_INTERN nk_bool
+nk_pool_page_owns(const struct nk_pool *pool, const struct nk_page *page,
+    const struct nk_page_element *elem)
+{
+    return elem >= page->win && elem < page->win + NK_MIN(page->size, pool->capacity);
+}
+NK_LIB nk_size
+nk_pool_trim(struct nk_pool *pool, struct nk_page_element **freelist)
+{
+    struct nk_page **link;
+    nk_size released = 0;
+    nk_size size;
+
+    NK_ASSERT(pool);
+    NK_ASSERT(freelist);
+    if (!pool || !freelist || pool->type == NK_BUFFER_FIXED)
+        return 0;
+
+    /* a page can go once every element handed out from it is on the freelist.
+     * Trimming is rare and both lists are short, so count by address instead
+     * of tracking a live count in every allocation */
+    size = sizeof(struct nk_page) + (pool->capacity - 1) * sizeof(struct nk_page_element);
+    link = &pool->pages;
+    while (*link) {
+        struct nk_page *page = *link;
+        struct nk_page_element **it;
+        unsigned int free_count = 0;
 
+        for (it = freelist; *it; it = &(*it)->next)
+            free_count += nk_pool_page_owns(pool, page, *it);
+        if (free_count != page->size) {
+            link = &page->next;
+            continue;
+        }
+        /* unlink its elements from the freelist and release the page */
+        it = freelist;
+        while (*it) {
+            if (nk_pool_page_owns(pool, page, *it))
+                *it = (*it)->next;
+            else it = &(*it)->next;
+        }
+        *link = page->next;
+        pool->alloc.free(pool->alloc.userdata, page);
+        released += size;
+    }
+    return released;
+}
@@ -37,6 +37,7 @@ nk_popup_begin(struct nk_context *ctx, enum nk_popup_type type,
         popup = (struct nk_window*)nk_create_window(ctx);
         popup->parent = win;
         win->popup.win = popup;
+        nk_window_grid_invalidate(ctx);
         win->popup.active = 0;
         win->popup.type = NK_PANEL_POPUP;
     }
@@ -129,6 +130,7 @@ nk_nonblock_begin(struct nk_context *ctx,
         popup = (struct nk_window*)nk_create_window(ctx);
         popup->parent = win;
         win->popup.win = popup;
+        nk_window_grid_invalidate(ctx);
         win->popup.type = panel_type;
         nk_command_buffer_init(&popup->buffer, &ctx->memory, NK_CLIPPING_ON);
     } else {
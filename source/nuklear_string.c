@@ -6,6 +6,126 @@
  *                              STRING
  *
  * ===============================================================*/
+NK_INTERN int
+nk_str_skip_runes(const struct nk_str *s, int at, int count, int *skipped)
+{
+    /* advances `count` runes from byte `at` and returns the new byte offset,
+     * both offsets are into the text without the gap */
+    int n = 0, k = 0;
+    int text_len = (int)s->buffer.allocated - s->gap_len;
+    const char *mem = (const char*)s->buffer.memory.ptr;
+
+    if (s->gap_len && at < s->gap_begin)
+        at += nk_utf_decode_run(mem + at, s->gap_begin - at, 0, count, &n);
+    if (n < count && at < text_len) {
+        int phys = (s->gap_len && at >= s->gap_begin) ? at + s->gap_len: at;
+        at += nk_utf_decode_run(mem + phys, (int)s->buffer.allocated - phys,
+            0, count - n, &k);
+    }
+    *skipped = n + k;
+    return at;
+}
+#ifdef NK_INCLUDE_STRING_INDEX
+/* Rune index: `index[i]` holds the byte offset of rune `i * index_stride`
+ * in the text without the gap. Entries are appended on demand by lookups
+ * and every edit only drops the entries behind the edited byte, so walking
+ * to a rune costs at most `index_stride` runes instead of the whole text.
+ * `index_len` and `index_bytes` catch code writing `len` or
+ * `buffer.allocated` directly (see `nk_edit_string`). */
+NK_INTERN void
+nk_str_index_reset(struct nk_str *s)
+{
+    s->index[0] = 0;
+    s->index_count = 1;
+    s->index_stride = NK_STR_INDEX_STRIDE;
+    s->index_len = s->len;
+    s->index_bytes = (int)s->buffer.allocated - s->gap_len;
+}
+NK_INTERN void
+nk_str_index_truncate(struct nk_str *s, int at)
+{
+    /* text in front of byte `at` is unchanged, so are its entries */
+    if (s->index_stride <= 0) {
+        nk_str_index_reset(s);
+        return;
+    }
+    while (s->index_count > 1 && s->index[s->index_count-1] > at)
+        s->index_count--;
+    if (s->index_count == 1)
+        s->index_stride = NK_STR_INDEX_STRIDE;
+    s->index_len = s->len;
+    s->index_bytes = (int)s->buffer.allocated - s->gap_len;
+}
+NK_INTERN int
+nk_str_index_seek(struct nk_str *s, int pos, int *at)
+{
+    /* returns the closest indexed rune in front of `pos` and its byte offset */
+    int k;
+    if (s->index_stride <= 0 || s->index_count < 1 || s->index_len != s->len ||
+        s->index_bytes != (int)s->buffer.allocated - s->gap_len)
+        nk_str_index_reset(s);
+
+    pos = NK_CLAMP(0, pos, s->len);
+    while (pos / s->index_stride >= NK_STR_INDEX_SIZE) {
+        /* index is full: keep every other entry and double the stride */
+        int i;
+        for (i = 0; 2*i < s->index_count; ++i)
+            s->index[i] = s->index[2*i];
+        s->index_count = (s->index_count + 1) / 2;
+        s->index_stride *= 2;
+    }
+    k = pos / s->index_stride;
+    while (s->index_count <= k) {
+        int n;
+        int next = nk_str_skip_runes(s, s->index[s->index_count-1], s->index_stride, &n);
+        if (n < s->index_stride) break;
+        s->index[s->index_count++] = next;
+    }
+    k = NK_MIN(k, s->index_count-1);
+    *at = s->index[k];
+    return k * s->index_stride;
+}
+NK_INTERN int
+nk_str_index_find(const struct nk_str *s, int pos, int *at)
+{
+    /* like `nk_str_index_seek` but only reads the entries already there */
+    int k;
+    *at = 0;
+    if (s->index_stride <= 0 || s->index_count < 1 || s->index_len != s->len ||
+        s->index_bytes != (int)s->buffer.allocated - s->gap_len)
+        return 0;
+    k = NK_CLAMP(0, pos, s->len) / s->index_stride;
+    k = NK_MIN(k, s->index_count-1);
+    *at = s->index[k];
+    return k * s->index_stride;
+}
+#else
+NK_INTERN void
+nk_str_index_reset(struct nk_str *s)
+{
+    NK_UNUSED(s);
+}
+NK_INTERN void
+nk_str_index_truncate(struct nk_str *s, int at)
+{
+    NK_UNUSED(s);
+    NK_UNUSED(at);
+}
+NK_INTERN int
+nk_str_index_find(const struct nk_str *s, int pos, int *at)
+{
+    /* without the index every lookup starts at the front or the gap */
+    NK_UNUSED(s);
+    NK_UNUSED(pos);
+    *at = 0;
+    return 0;
+}
+NK_INTERN int
+nk_str_index_seek(struct nk_str *s, int pos, int *at)
+{
+    return nk_str_index_find(s, pos, at);
+}
+#endif
 #ifdef NK_INCLUDE_DEFAULT_ALLOCATOR
 NK_API void
 nk_str_init_default(struct nk_str *str)
@@ -16,6 +136,9 @@ nk_str_init_default(struct nk_str *str)
     alloc.free = nk_mfree;
     nk_buffer_init(&str->buffer, &alloc, 32);
     str->len = 0;
+    str->use_gap = nk_false;
+    str->gap_begin = str->gap_len = str->gap_rune = 0;
+    nk_str_index_reset(str);
 }
 #endif
 
@@ -24,12 +147,237 @@ nk_str_init(struct nk_str *str, const struct nk_allocator *alloc, nk_size size)
 {
     nk_buffer_init(&str->buffer, alloc, size);
     str->len = 0;
+    str->use_gap = nk_false;
+    str->gap_begin = str->gap_len = str->gap_rune = 0;
+    nk_str_index_reset(str);
 }
 NK_API void
 nk_str_init_fixed(struct nk_str *str, void *memory, nk_size size)
 {
     nk_buffer_init_fixed(&str->buffer, memory, size);
     str->len = 0;
+    str->use_gap = nk_false;
+    str->gap_begin = str->gap_len = str->gap_rune = 0;
+    nk_str_index_reset(str);
+}
+
+/* Gap buffer: with `use_gap` the text is stored as [front | gap | back]
+ * inside `buffer`, with `buffer.allocated` covering all three parts.
+ * Inserting or deleting at the gap only touches the gap, moving it costs
+ * the distance moved. Functions handing out a pointer to the rest of the
+ * text close the gap first, readers of single runes map offsets around it
+ * and `nk_str_span` gives the text in at most two pieces. */
+NK_LIB void
+nk_str_close_gap(struct nk_str *s)
+{
+    int back;
+    NK_ASSERT(s);
+    if (!s || !s->gap_len) return;
+
+    back = (int)s->buffer.allocated - (s->gap_begin + s->gap_len);
+    if (back > 0) {
+        /* memmove */
+        char *mem = (char*)s->buffer.memory.ptr;
+        NK_MEMCPY(mem + s->gap_begin, mem + s->gap_begin + s->gap_len, (nk_size)back);
+    }
+    s->buffer.allocated -= (nk_size)s->gap_len;
+    s->gap_begin = (int)s->buffer.allocated;
+    s->gap_len = 0;
+    s->gap_rune = s->len;
+}
+NK_INTERN int
+nk_str_rune_walk(const struct nk_str *s, int pos, int from, int at)
+{
+    /* walks from rune `from` at byte `at` to rune `pos` */
+    int n;
+    if (s->gap_len && s->gap_rune <= pos && s->gap_rune > from) {
+        /* the gap is a closer starting point than the index */
+        from = s->gap_rune;
+        at = s->gap_begin;
+    }
+    at = nk_str_skip_runes(s, at, pos - from, &n);
+    return (n == pos - from) ? at: -1;
+}
+NK_LIB int
+nk_str_rune_offset(struct nk_str *s, int pos)
+{
+    /* returns the byte offset of rune `pos` in the text without the gap,
+     * extending the rune index on the way */
+    int at, from;
+    NK_ASSERT(s);
+    if (!s || pos < 0 || pos > s->len) return -1;
+    if (pos == s->len) return (int)s->buffer.allocated - s->gap_len;
+    if (s->gap_len && pos == s->gap_rune) return s->gap_begin;
+    from = nk_str_index_seek(s, pos, &at);
+    return nk_str_rune_walk(s, pos, from, at);
+}
+NK_INTERN int
+nk_str_rune_offset_const(const struct nk_str *s, int pos)
+{
+    int at, from;
+    if (pos < 0 || pos > s->len) return -1;
+    if (pos == s->len) return (int)s->buffer.allocated - s->gap_len;
+    if (s->gap_len && pos == s->gap_rune) return s->gap_begin;
+    from = nk_str_index_find(s, pos, &at);
+    return nk_str_rune_walk(s, pos, from, at);
+}
+NK_API const char*
+nk_str_span(const struct nk_str *s, int at, int *len)
+{
+    /* returns the text from byte `at` on and in `len` how many bytes of it
+     * are in one piece, up to the gap or the end of the text */
+    const char *mem;
+    int text_len;
+    NK_ASSERT(s);
+    NK_ASSERT(len);
+    *len = 0;
+    if (!s) return 0;
+    text_len = (int)s->buffer.allocated - s->gap_len;
+    if (at < 0 || at >= text_len) return 0;
+    mem = (const char*)s->buffer.memory.ptr;
+    if (s->gap_len && at < s->gap_begin) {
+        *len = s->gap_begin - at;
+        return mem + at;
+    }
+    *len = text_len - at;
+    return (s->gap_len) ? mem + at + s->gap_len: mem + at;
+}
+NK_INTERN void
+nk_str_close_gap_const(const struct nk_str *s)
+{
+    /* closing the gap moves bytes but leaves the text as it is */
+    if (s->gap_len) nk_str_close_gap((struct nk_str*)s);
+}
+NK_INTERN int
+nk_str_move_gap(struct nk_str *s, int pos, int rune_pos, int size)
+{
+    /* moves the gap to byte offset `pos` (rune `rune_pos`) and makes sure
+     * it can hold at least `size` bytes */
+    char *mem;
+    int text_len = (int)s->buffer.allocated - s->gap_len;
+    if (s->gap_len) {
+        mem = (char*)s->buffer.memory.ptr;
+        if (pos < s->gap_begin) {
+            /* memmove */
+            NK_MEMCPY(mem + pos + s->gap_len, mem + pos, (nk_size)(s->gap_begin - pos));
+        } else if (pos > s->gap_begin) {
+            /* memmove */
+            NK_MEMCPY(mem + s->gap_begin, mem + s->gap_begin + s->gap_len, (nk_size)(pos - s->gap_begin));
+        }
+    }
+    s->gap_begin = pos;
+    s->gap_rune = rune_pos;
+
+    if (s->gap_len < size || !s->gap_len) {
+        /* grow the gap proportional to the text to keep edits amortized O(1) */
+        int back;
+        int grow = NK_MAX(size - s->gap_len, NK_MAX(NK_STR_GAP_SIZE, text_len / 8));
+        if (s->buffer.type != NK_BUFFER_DYNAMIC) {
+            /* keep one byte spare like `nk_str_insert_at_char` */
+            int avail = (int)s->buffer.memory.size - (int)s->buffer.allocated - 1;
+            grow = NK_MIN(grow, avail);
+            if (s->gap_len + grow < size) return 0;
+            if (grow <= 0) return 1;
+        }
+        if (!nk_buffer_alloc(&s->buffer, NK_BUFFER_FRONT, (nk_size)grow, 0))
+            return 0;
+
+        /* memmove */
+        mem = (char*)s->buffer.memory.ptr;
+        back = (int)s->buffer.allocated - grow - (s->gap_begin + s->gap_len);
+        if (back > 0)
+            NK_MEMCPY(mem + s->gap_begin + s->gap_len + grow,
+                mem + s->gap_begin + s->gap_len, (nk_size)back);
+        s->gap_len += grow;
+    }
+    return 1;
+}
+NK_INTERN int
+nk_str_gap_insert(struct nk_str *s, int pos, const char *text, int len)
+{
+    int glyphs;
+    int at = nk_str_rune_offset(s, pos);
+    if (at < 0 || !nk_str_move_gap(s, at, pos, len))
+        return 0;
+
+    NK_MEMCPY((char*)s->buffer.memory.ptr + s->gap_begin, text, (nk_size)len);
+    glyphs = nk_utf_len(text, len);
+    s->gap_begin += len;
+    s->gap_len -= len;
+    s->gap_rune += glyphs;
+    s->len += glyphs;
+    nk_str_index_truncate(s, at);
+    return 1;
+}
+NK_INTERN void
+nk_str_gap_delete(struct nk_str *s, int pos, int len)
+{
+    int count = 0;
+    int back_len;
+    const char *back;
+    int at = nk_str_rune_offset(s, pos);
+    if (at < 0 || !nk_str_move_gap(s, at, pos, 0))
+        return;
+
+    /* deleted runes directly follow the gap so just widen it */
+    back = (const char*)s->buffer.memory.ptr + s->gap_begin + s->gap_len;
+    back_len = (int)s->buffer.allocated - (s->gap_begin + s->gap_len);
+    s->gap_len += nk_utf_decode_run(back, back_len, 0, len, &count);
+    s->len -= count;
+    nk_str_index_truncate(s, at);
+}
+NK_LIB int
+nk_str_decode_runes(const struct nk_str *s, int pos, nk_rune *runes, int count)
+{
+    /* decodes `count` runes starting at rune `pos` without closing the gap */
+    int n = 0;
+    int at;
+    const char *mem;
+    NK_ASSERT(s);
+    if (!s || !runes || count <= 0) return 0;
+
+    at = nk_str_rune_offset_const(s, pos);
+    if (at < 0) return 0;
+    mem = (const char*)s->buffer.memory.ptr;
+    if (s->gap_len && at < s->gap_begin) {
+        nk_utf_decode_run(mem + at, s->gap_begin - at, runes, count, &n);
+        at = s->gap_begin;
+    }
+    if (n < count) {
+        int k = 0;
+        int phys = (s->gap_len) ? at + s->gap_len: at;
+        nk_utf_decode_run(mem + phys, (int)s->buffer.allocated - phys, runes + n, count - n, &k);
+        n += k;
+    }
+    return n;
+}
+NK_LIB int
+nk_str_copy_text(const struct nk_str *s, int pos, int count, char *dst)
+{
+    /* copies the UTF-8 text of `count` runes starting at rune `pos` into
+     * `dst` without closing the gap and returns its size in bytes. Passing
+     * no `dst` only returns the size. */
+    int begin, end, front = 0;
+    const char *mem;
+    NK_ASSERT(s);
+    if (!s || count <= 0) return 0;
+
+    count = NK_MIN(count, s->len - pos);
+    begin = nk_str_rune_offset_const(s, pos);
+    end = nk_str_rune_offset_const(s, pos + count);
+    if (begin < 0 || end < begin) return 0;
+    if (!dst) return end - begin;
+
+    mem = (const char*)s->buffer.memory.ptr;
+    if (s->gap_len && begin < s->gap_begin) {
+        front = NK_MIN(end, s->gap_begin) - begin;
+        NK_MEMCPY(dst, mem + begin, (nk_size)front);
+    }
+    if (begin + front < end) {
+        int phys = s->gap_len ? begin + front + s->gap_len: begin + front;
+        NK_MEMCPY(dst + front, mem + phys, (nk_size)(end - begin - front));
+    }
+    return end - begin;
 }
 NK_API int
 nk_str_append_text_char(struct nk_str *s, const char *str, int len)
@@ -38,10 +386,12 @@ nk_str_append_text_char(struct nk_str *s, const char *str, int len)
     NK_ASSERT(s);
     NK_ASSERT(str);
     if (!s || !str || !len) return 0;
+    nk_str_close_gap(s);
     mem = (char*)nk_buffer_alloc(&s->buffer, NK_BUFFER_FRONT, (nk_size)len * sizeof(char), 0);
     if (!mem) return 0;
     NK_MEMCPY(mem, str, (nk_size)len * sizeof(char));
     s->len += nk_utf_len(str, len);
+    nk_str_index_truncate(s, (int)s->buffer.allocated - len);
     return len;
 }
 NK_API int
@@ -122,9 +472,10 @@ nk_str_insert_at_char(struct nk_str *s, int pos, const char *str, int len)
     NK_ASSERT(s);
     NK_ASSERT(str);
     NK_ASSERT(len >= 0);
+    if (s) nk_str_close_gap(s);
     if (!s || !str || !len || (nk_size)pos > s->buffer.allocated) return 0;
     if ((s->buffer.allocated + (nk_size)len >= s->buffer.memory.size) &&
-        (s->buffer.type == NK_BUFFER_FIXED)) return 0;
+        (s->buffer.type != NK_BUFFER_DYNAMIC)) return 0;
 
     copylen = (int)s->buffer.allocated - pos;
     if (!copylen) {
@@ -143,6 +494,7 @@ nk_str_insert_at_char(struct nk_str *s, int pos, const char *str, int len)
     mem = nk_ptr_add(void, s->buffer.memory.ptr, pos);
     NK_MEMCPY(mem, str, (nk_size)len * sizeof(char));
     s->len = nk_utf_len((char *)s->buffer.memory.ptr, (int)s->buffer.allocated);
+    nk_str_index_truncate(s, pos);
     return 1;
 }
 NK_API int
@@ -157,6 +509,8 @@ nk_str_insert_at_rune(struct nk_str *str, int pos, const char *cstr, int len)
     NK_ASSERT(cstr);
     NK_ASSERT(len);
     if (!str || !cstr || !len) return 0;
+    if (str->use_gap)
+        return nk_str_gap_insert(str, pos, cstr, len);
     begin = nk_str_at_rune(str, pos, &unicode, &glyph_len);
     if (!str->len)
         return nk_str_append_text_char(str, cstr, len);
@@ -243,10 +597,12 @@ nk_str_remove_chars(struct nk_str *s, int len)
 {
     NK_ASSERT(s);
     NK_ASSERT(len >= 0);
+    if (s) nk_str_close_gap(s);
     if (!s || len < 0 || (nk_size)len > s->buffer.allocated) return;
     NK_ASSERT(((int)s->buffer.allocated - (int)len) >= 0);
     s->buffer.allocated -= (nk_size)len;
     s->len = nk_utf_len((char *)s->buffer.memory.ptr, (int)s->buffer.allocated);
+    nk_str_index_truncate(s, (int)s->buffer.allocated);
 }
 NK_API void
 nk_str_remove_runes(struct nk_str *str, int len)
@@ -259,6 +615,7 @@ nk_str_remove_runes(struct nk_str *str, int len)
     NK_ASSERT(str);
     NK_ASSERT(len >= 0);
     if (!str || len < 0) return;
+    nk_str_close_gap(str);
     if (len >= str->len) {
         str->len = 0;
         return;
@@ -273,6 +630,7 @@ NK_API void
 nk_str_delete_chars(struct nk_str *s, int pos, int len)
 {
     NK_ASSERT(s);
+    if (s) nk_str_close_gap(s);
     if (!s || !len || (nk_size)pos > s->buffer.allocated ||
         (nk_size)(pos + len) > s->buffer.allocated) return;
 
@@ -285,6 +643,7 @@ nk_str_delete_chars(struct nk_str *s, int pos, int len)
         s->buffer.allocated -= (nk_size)len;
     } else nk_str_remove_chars(s, len);
     s->len = nk_utf_len((char *)s->buffer.memory.ptr, (int)s->buffer.allocated);
+    nk_str_index_truncate(s, pos);
 }
 NK_API void
 nk_str_delete_runes(struct nk_str *s, int pos, int len)
@@ -300,13 +659,17 @@ nk_str_delete_runes(struct nk_str *s, int pos, int len)
     if (s->len < pos + len)
         len = NK_CLAMP(0, (s->len - pos), s->len);
     if (!len) return;
+    if (s->use_gap) {
+        nk_str_gap_delete(s, pos, len);
+        return;
+    }
 
-    temp = (char *)s->buffer.memory.ptr;
     begin = nk_str_at_rune(s, pos, &unicode, &unused);
     if (!begin) return;
-    s->buffer.memory.ptr = begin;
-    end = nk_str_at_rune(s, len, &unicode, &unused);
-    s->buffer.memory.ptr = temp;
+    /* bound the search by the bytes actually left after begin */
+    temp = (char *)s->buffer.memory.ptr;
+    end = (char*)nk_utf_at(begin, (int)s->buffer.allocated - (int)(begin - temp),
+        len, &unicode, &unused);
     if (!end) return;
     nk_str_delete_chars(s, (int)(begin - temp), (int)(end - begin));
 }
@@ -314,18 +677,15 @@ NK_API char*
 nk_str_at_char(struct nk_str *s, int pos)
 {
     NK_ASSERT(s);
+    if (s) nk_str_close_gap(s);
     if (!s || pos > (int)s->buffer.allocated) return 0;
+    /* caller may write through the pointer */
+    nk_str_index_truncate(s, pos);
     return nk_ptr_add(char, s->buffer.memory.ptr, pos);
 }
 NK_API char*
 nk_str_at_rune(struct nk_str *str, int pos, nk_rune *unicode, int *len)
 {
-    int i = 0;
-    int src_len = 0;
-    int glyph_len = 0;
-    char *text;
-    int text_len;
-
     NK_ASSERT(str);
     NK_ASSERT(unicode);
     NK_ASSERT(len);
@@ -336,39 +696,25 @@ nk_str_at_rune(struct nk_str *str, int pos, nk_rune *unicode, int *len)
         *len = 0;
         return 0;
     }
-
-    text = (char*)str->buffer.memory.ptr;
-    text_len = (int)str->buffer.allocated;
-    glyph_len = nk_utf_decode(text, unicode, text_len);
-    while (glyph_len) {
-        if (i == pos) {
-            *len = glyph_len;
-            break;
-        }
-
-        i++;
-        src_len = src_len + glyph_len;
-        glyph_len = nk_utf_decode(text + src_len, unicode, text_len - src_len);
-    }
-    if (i != pos) return 0;
-    return text + src_len;
+    nk_str_close_gap(str);
+    {int at;
+    const char *mem = (const char*)str->buffer.memory.ptr;
+    int from = nk_str_index_seek(str, pos, &at);
+    return (char*)nk_utf_at(mem + at, (int)str->buffer.allocated - at,
+        pos - from, unicode, len);}
 }
 NK_API const char*
 nk_str_at_char_const(const struct nk_str *s, int pos)
 {
     NK_ASSERT(s);
-    if (!s || pos > (int)s->buffer.allocated) return 0;
-    return nk_ptr_add(char, s->buffer.memory.ptr, pos);
+    if (!s || pos < 0 || pos > (int)s->buffer.allocated - s->gap_len) return 0;
+    /* callers read on to the end of the text */
+    nk_str_close_gap_const(s);
+    return nk_ptr_add_const(char, s->buffer.memory.ptr, pos);
 }
 NK_API const char*
 nk_str_at_const(const struct nk_str *str, int pos, nk_rune *unicode, int *len)
 {
-    int i = 0;
-    int src_len = 0;
-    int glyph_len = 0;
-    char *text;
-    int text_len;
-
     NK_ASSERT(str);
     NK_ASSERT(unicode);
     NK_ASSERT(len);
@@ -379,22 +725,18 @@ nk_str_at_const(const struct nk_str *str, int pos, nk_rune *unicode, int *len)
         *len = 0;
         return 0;
     }
-
-    text = (char*)str->buffer.memory.ptr;
-    text_len = (int)str->buffer.allocated;
-    glyph_len = nk_utf_decode(text, unicode, text_len);
-    while (glyph_len) {
-        if (i == pos) {
-            *len = glyph_len;
-            break;
-        }
-
-        i++;
-        src_len = src_len + glyph_len;
-        glyph_len = nk_utf_decode(text + src_len, unicode, text_len - src_len);
+    {int n;
+    const char *text;
+    int at = nk_str_rune_offset_const(str, pos);
+    text = nk_str_span(str, at, &n);
+    if (!text) {
+        *unicode = 0;
+        *len = 0;
+        return 0;
     }
-    if (i != pos) return 0;
-    return text + src_len;
+    /* runes never straddle the gap */
+    *len = nk_utf_decode(text, unicode, n);
+    return (*len) ? text: 0;}
 }
 NK_API nk_rune
 nk_str_rune_at(const struct nk_str *str, int pos)
@@ -408,7 +750,10 @@ NK_API char*
 nk_str_get(struct nk_str *s)
 {
     NK_ASSERT(s);
+    if (s) nk_str_close_gap(s);
     if (!s || !s->len || !s->buffer.allocated) return 0;
+    /* caller may write through the pointer */
+    nk_str_index_reset(s);
     return (char*)s->buffer.memory.ptr;
 }
 NK_API const char*
@@ -416,6 +761,7 @@ nk_str_get_const(const struct nk_str *s)
 {
     NK_ASSERT(s);
     if (!s || !s->len || !s->buffer.allocated) return 0;
+    nk_str_close_gap_const(s);
     return (const char*)s->buffer.memory.ptr;
 }
 NK_API int
@@ -430,7 +776,7 @@ nk_str_len_char(const struct nk_str *s)
 {
     NK_ASSERT(s);
     if (!s || !s->len || !s->buffer.allocated) return 0;
-    return (int)s->buffer.allocated;
+    return (int)s->buffer.allocated - s->gap_len;
 }
 NK_API void
 nk_str_clear(struct nk_str *str)
@@ -438,6 +784,8 @@ nk_str_clear(struct nk_str *str)
     NK_ASSERT(str);
     nk_buffer_clear(&str->buffer);
     str->len = 0;
+    str->gap_begin = str->gap_len = str->gap_rune = 0;
+    nk_str_index_reset(str);
 }
 NK_API void
 nk_str_free(struct nk_str *str)
@@ -445,4 +793,6 @@ nk_str_free(struct nk_str *str)
     NK_ASSERT(str);
     nk_buffer_free(&str->buffer);
     str->len = 0;
+    str->gap_begin = str->gap_len = str->gap_rune = 0;
+    nk_str_index_reset(str);
 }
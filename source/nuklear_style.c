@@ -731,6 +731,7 @@ nk_style_set_font(struct nk_context *ctx, const struct nk_user_font *font)
     style = &ctx->style;
     style->font = font;
     ctx->stacks.fonts.head = 0;
+    nk_text_cache_clear(&ctx->text_cache);
     if (ctx->current)
         nk_layout_reset_min_row_height(ctx);
 }
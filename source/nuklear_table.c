@@ -40,11 +40,147 @@ nk_push_table(struct nk_window *win, struct nk_table *tbl)
     win->tables = tbl;
     win->table_count++;
 }
+#define NK_TABLE_INDEX_SLOT(index, i)\
+    ((index)->pages[(i) / NK_TABLE_INDEX_PAGE_SLOTS])
+#define NK_TABLE_INDEX_OFFSET(i) ((i) % NK_TABLE_INDEX_PAGE_SLOTS)
+NK_INTERN nk_bool
+nk_table_index_add(struct nk_table_index *index, struct nk_table *tbl,
+    unsigned int entry)
+{
+    unsigned int cap = index->page_count * (unsigned int)NK_TABLE_INDEX_PAGE_SLOTS;
+    unsigned int i;
+
+    /* keep at least an eighth of the slots empty to bound probe lengths */
+    if (index->count >= cap - cap/8) {
+        index->unindexed++;
+        return nk_false;
+    }
+    i = tbl->keys[entry] % cap;
+    while (NK_TABLE_INDEX_SLOT(index, i)->tables[NK_TABLE_INDEX_OFFSET(i)])
+        i = (i + 1) % cap;
+    NK_TABLE_INDEX_SLOT(index, i)->tables[NK_TABLE_INDEX_OFFSET(i)] = tbl;
+    NK_TABLE_INDEX_SLOT(index, i)->entries[NK_TABLE_INDEX_OFFSET(i)] = (nk_byte)entry;
+    index->count++;
+    return nk_true;
+}
+NK_INTERN void
+nk_table_index_remove(struct nk_table_index *index, const struct nk_table *tbl,
+    unsigned int entry)
+{
+    unsigned int cap = index->page_count * (unsigned int)NK_TABLE_INDEX_PAGE_SLOTS;
+    unsigned int i, j;
+    struct nk_table_index_page *page;
+
+    i = tbl->keys[entry] % cap;
+    for (;;) {
+        page = NK_TABLE_INDEX_SLOT(index, i);
+        if (!page->tables[NK_TABLE_INDEX_OFFSET(i)]) {
+            NK_ASSERT(index->unindexed > 0);
+            index->unindexed--;
+            return;
+        }
+        if (page->tables[NK_TABLE_INDEX_OFFSET(i)] == tbl &&
+            page->entries[NK_TABLE_INDEX_OFFSET(i)] == entry)
+            break;
+        i = (i + 1) % cap;
+    }
+    /* shift following values back into the hole instead of leaving a
+     * tombstone, so collected values never lengthen later probes */
+    j = i;
+    for (;;) {
+        struct nk_table_index_page *next;
+        struct nk_table *t;
+        unsigned int home;
+
+        j = (j + 1) % cap;
+        next = NK_TABLE_INDEX_SLOT(index, j);
+        t = next->tables[NK_TABLE_INDEX_OFFSET(j)];
+        if (!t) break;
+        home = t->keys[next->entries[NK_TABLE_INDEX_OFFSET(j)]] % cap;
+        if ((i <= j) ? (i < home && home <= j): (i < home || home <= j))
+            continue;
+        page = NK_TABLE_INDEX_SLOT(index, i);
+        page->tables[NK_TABLE_INDEX_OFFSET(i)] = t;
+        page->entries[NK_TABLE_INDEX_OFFSET(i)] = next->entries[NK_TABLE_INDEX_OFFSET(j)];
+        i = j;
+    }
+    page = NK_TABLE_INDEX_SLOT(index, i);
+    page->tables[NK_TABLE_INDEX_OFFSET(i)] = 0;
+    index->count--;
+}
+NK_INTERN struct nk_page_element*
+nk_table_index_page(struct nk_context *ctx)
+{
+    /* the index is optional: never take the last page elements of a fixed
+     * memory block or pool from windows, panels and values */
+    if (!ctx->freelist && (!ctx->use_pool || (ctx->pool.type == NK_BUFFER_FIXED &&
+        (!ctx->pool.pages || ctx->pool.pages->size >= ctx->pool.capacity))))
+        return 0;
+    return nk_create_page_element(ctx);
+}
+NK_INTERN nk_bool
+nk_table_index_grow(struct nk_context *ctx, struct nk_window *win)
+{
+    struct nk_table_index *index = win->table_index;
+    unsigned int page_count, i;
+    struct nk_table *it;
+
+    if (!index) {
+        struct nk_page_element *elem = nk_table_index_page(ctx);
+        if (!elem) return nk_false;
+        index = &elem->data.idx;
+        win->table_index = index;
+    }
+    /* double the number of slot pages, keeping whatever could be allocated */
+    page_count = index->page_count;
+    i = NK_MIN(NK_MAX(page_count * 2, 1), (unsigned int)NK_TABLE_INDEX_MAX_PAGES);
+    while (index->page_count < i) {
+        struct nk_page_element *elem = nk_table_index_page(ctx);
+        if (!elem) break;
+        index->pages[index->page_count++] = &elem->data.idx_page;
+    }
+    if (!index->page_count) {
+        nk_free_table_index(ctx, win);
+        return nk_false;
+    }
+    if (index->page_count == page_count)
+        return nk_false;
+    /* rehash: only slots move, values stay where they are */
+    for (i = 0; i < index->page_count; ++i)
+        nk_zero_struct(*index->pages[i]);
+    index->count = 0;
+    index->unindexed = 0;
+    for (it = win->tables; it; it = it->next) {
+        for (i = 0; i < it->size; ++i)
+            nk_table_index_add(index, it, i);
+    }
+    for (it = win->stale_tables; it; it = it->next) {
+        for (i = 0; i < it->size; ++i)
+            nk_table_index_add(index, it, i);
+    }
+    return nk_true;
+}
 NK_LIB void
-nk_remove_table(struct nk_window *win, struct nk_table *tbl)
+nk_free_table_index(struct nk_context *ctx, struct nk_window *win)
+{
+    struct nk_table_index *index = win->table_index;
+    unsigned int i;
+    if (!index) return;
+    win->table_index = 0;
+    for (i = 0; i < index->page_count; ++i) {
+        union nk_page_data *pd = NK_CONTAINER_OF(index->pages[i], union nk_page_data, idx_page);
+        nk_free_page_element(ctx, NK_CONTAINER_OF(pd, struct nk_page_element, data));
+    }
+    {union nk_page_data *pd = NK_CONTAINER_OF(index, union nk_page_data, idx);
+    nk_free_page_element(ctx, NK_CONTAINER_OF(pd, struct nk_page_element, data));}
+}
+NK_INTERN void
+nk_unlink_table(struct nk_window *win, struct nk_table *tbl)
 {
     if (win->tables == tbl)
         win->tables = tbl->next;
+    else if (win->stale_tables == tbl)
+        win->stale_tables = tbl->next;
     if (tbl->next)
         tbl->next->prev = tbl->prev;
     if (tbl->prev)
@@ -52,10 +188,50 @@ nk_remove_table(struct nk_window *win, struct nk_table *tbl)
     tbl->next = 0;
     tbl->prev = 0;
 }
+NK_LIB void
+nk_remove_table(struct nk_window *win, struct nk_table *tbl)
+{
+    if (win->table_index) {
+        unsigned int i;
+        for (i = 0; i < tbl->size; ++i)
+            nk_table_index_remove(win->table_index, tbl, i);
+    }
+    nk_unlink_table(win, tbl);
+}
+NK_INTERN void
+nk_link_used_table(struct nk_window *win, struct nk_table *tbl)
+{
+    /* the head stays the only table `nk_add_value` fills, so a table with
+     * free slots replaces a full head and goes behind a partially filled one */
+    struct nk_table *head = win->tables;
+    nk_unlink_table(win, tbl);
+    tbl->seq = win->seq;
+    if (head && head->size < NK_VALUE_PAGE_CAPACITY) {
+        tbl->next = head->next;
+        tbl->prev = head;
+        if (head->next)
+            head->next->prev = tbl;
+        head->next = tbl;
+    } else {
+        tbl->next = head;
+        if (head)
+            head->prev = tbl;
+        win->tables = tbl;
+    }
+}
+NK_INTERN void
+nk_use_table(struct nk_window *win, struct nk_table *tbl)
+{
+    /* first use this frame: move it from the stale to the used tables */
+    if (tbl->seq != win->seq && tbl != win->tables)
+        nk_link_used_table(win, tbl);
+    else tbl->seq = win->seq;
+}
 NK_LIB nk_uint*
 nk_add_value(struct nk_context *ctx, struct nk_window *win,
             nk_hash name, nk_uint value)
 {
+    struct nk_table_index *index;
     NK_ASSERT(ctx);
     NK_ASSERT(win);
     if (!win || !ctx) return 0;
@@ -68,22 +244,104 @@ nk_add_value(struct nk_context *ctx, struct nk_window *win,
     win->tables->seq = win->seq;
     win->tables->keys[win->tables->size] = name;
     win->tables->values[win->tables->size] = value;
-    return &win->tables->values[win->tables->size++];
+    win->tables->size++;
+
+    /* grow at three quarters load, the rehash picks up the new value */
+    index = win->table_index;
+    if (!index || ((index->count + index->unindexed) * 4 >=
+        index->page_count * (unsigned int)NK_TABLE_INDEX_PAGE_SLOTS * 3 &&
+        index->page_count < NK_TABLE_INDEX_MAX_PAGES)) {
+        if (nk_table_index_grow(ctx, win))
+            return &win->tables->values[win->tables->size-1];
+        index = win->table_index;
+    }
+    if (index)
+        nk_table_index_add(index, win->tables, win->tables->size-1);
+    return &win->tables->values[win->tables->size-1];
 }
-NK_LIB nk_uint*
-nk_find_value(const struct nk_window *win, nk_hash name)
+NK_INTERN nk_uint*
+nk_find_table_value(struct nk_window *win, struct nk_table *iter, nk_hash name)
 {
-    struct nk_table *iter = win->tables;
     while (iter) {
-        unsigned int i = 0;
-        unsigned int size = iter->size;
-        for (i = 0; i < size; ++i) {
+        unsigned int i;
+        for (i = 0; i < iter->size; ++i) {
             if (iter->keys[i] == name) {
-                iter->seq = win->seq;
+                nk_use_table(win, iter);
                 return &iter->values[i];
             }
-        } size = NK_VALUE_PAGE_CAPACITY;
+        }
         iter = iter->next;
     }
     return 0;
 }
+NK_LIB nk_uint*
+nk_find_value(struct nk_window *win, nk_hash name)
+{
+    const struct nk_table_index *index = win->table_index;
+    nk_uint *value;
+    if (index) {
+        struct nk_table *iter;
+        unsigned int cap = index->page_count * (unsigned int)NK_TABLE_INDEX_PAGE_SLOTS;
+        unsigned int i = name % cap;
+        while ((iter = NK_TABLE_INDEX_SLOT(index, i)->tables[NK_TABLE_INDEX_OFFSET(i)]) != 0) {
+            unsigned int entry = NK_TABLE_INDEX_SLOT(index, i)->entries[NK_TABLE_INDEX_OFFSET(i)];
+            if (iter->keys[entry] == name) {
+                nk_use_table(win, iter);
+                return &iter->values[entry];
+            }
+            i = (i + 1) % cap;
+        }
+        if (!index->unindexed)
+            return 0;
+    }
+    /* no index or values that did not fit into it */
+    value = nk_find_table_value(win, win->tables, name);
+    if (!value)
+        value = nk_find_table_value(win, win->stale_tables, name);
+    return value;
+}
+NK_LIB nk_size
+nk_collect_tables(struct nk_context *ctx, struct nk_window *win, nk_size budget)
+{
+    nk_size freed = 0;
+    while (win->stale_tables && freed < budget) {
+        struct nk_table *it = win->stale_tables;
+        nk_remove_table(win, it);
+        nk_zero(it, sizeof(union nk_page_data));
+        nk_free_table(ctx, it);
+        freed++;
+    }
+    if (!win->tables && !win->stale_tables)
+        nk_free_table_index(ctx, win);
+    return freed;
+}
+NK_LIB void
+nk_age_tables(struct nk_window *win)
+{
+    struct nk_table *used = win->tables;
+    struct nk_table *tail;
+
+    /* keep a partially filled head for `nk_add_value` if it was used */
+    if (used && used->seq == win->seq && used->size < NK_VALUE_PAGE_CAPACITY) {
+        used = used->next;
+        win->tables->next = 0;
+    } else win->tables = 0;
+    if (!used) return;
+
+    /* tables every lookup missed since the last collection come first, the
+     * ones used this frame are appended behind them */
+    used->prev = 0;
+    if (!win->stale_tables) {
+        win->stale_tables = used;
+        return;
+    }
+    for (tail = win->stale_tables; tail->next; tail = tail->next);
+    tail->next = used;
+    used->prev = tail;
+}
+NK_LIB void
+nk_keep_tables(struct nk_window *win)
+{
+    while (win->stale_tables)
+        nk_link_used_table(win, win->stale_tables);
+}
@@ -7,9 +7,10 @@
  *
  * ===============================================================*/
 NK_LIB void
-nk_widget_text(struct nk_command_buffer *o, struct nk_rect b,
-    const char *string, int len, const struct nk_text *t,
-    nk_flags a, const struct nk_user_font *f)
+nk_widget_text_measured(struct nk_command_buffer *o, struct nk_rect b,
+    const char *string, int len, const struct nk_text *t, nk_flags a,
+    const struct nk_user_font *f, float string_width,
+    struct nk_text_cache_entry *cached)
 {
     struct nk_rect label;
     float text_width;
@@ -19,9 +20,7 @@ nk_widget_text(struct nk_command_buffer *o, struct nk_rect b,
     if (!o || !t) return;
 
     b.h = NK_MAX(b.h, 2 * t->padding.y);
-
-    text_width = f->width(f->userdata, f->height, (const char*)string, len);
-    text_width += (2.0f * t->padding.x);
+    text_width = string_width + (2.0f * t->padding.x);
 
     /* use top-left alignment by default */
     if (!(a & (NK_TEXT_ALIGN_LEFT | NK_TEXT_ALIGN_CENTERED | NK_TEXT_ALIGN_RIGHT)))
@@ -56,7 +55,42 @@ nk_widget_text(struct nk_command_buffer *o, struct nk_rect b,
         label.h = f->height;
     }
 
-    nk_draw_text(o, label, (const char*)string, len, f, t->background, t->text);
+    /* clamp text that does not fit only once per available width */
+    if (cached && string_width > label.w) {
+        if (nk_draw_culled(o, label)) return;
+        if (cached->space != label.w) {
+            int glyphs = 0;
+            float fit_width = string_width;
+            cached->fitting = nk_text_clamp(f, string, len, label.w, &glyphs, &fit_width, 0, 0);
+            cached->space = label.w;
+        }
+        len = cached->fitting;
+        string_width = label.w;
+    }
+    nk_draw_text_measured(o, label, (const char*)string, len, f, string_width,
+        t->background, t->text);
+}
+NK_LIB void
+nk_widget_text(struct nk_command_buffer *o, struct nk_rect b,
+    const char *string, int len, const struct nk_text *t,
+    nk_flags a, const struct nk_user_font *f)
+{
+    struct nk_text_cache_entry *cached = 0;
+    float string_width;
+
+    NK_ASSERT(o);
+    NK_ASSERT(t);
+    if (!o || !t) return;
+
+    if (o->text_cache)
+        cached = nk_text_cache_get(o->text_cache, f, string, len, NK_TEXT_CACHE_LABEL);
+    if (cached && cached->width >= 0) {
+        string_width = cached->width;
+    } else {
+        string_width = f->width(f->userdata, f->height, (const char*)string, len);
+        if (cached) cached->width = string_width;
+    }
+    nk_widget_text_measured(o, b, string, len, t, a, f, string_width, cached);
 }
 NK_LIB void
 nk_widget_text_wrap(struct nk_command_buffer *o, struct nk_rect b,
@@ -64,11 +98,14 @@ nk_widget_text_wrap(struct nk_command_buffer *o, struct nk_rect b,
     const struct nk_user_font *f)
 {
     float width;
+    float line_width;
     int glyphs = 0;
     int fitting = 0;
     int done = 0;
+    int line_index = 0;
     struct nk_rect line;
     struct nk_text text;
+    struct nk_text_cache_entry *cached = 0;
     NK_INTERN nk_rune seperator[] = {' '};
 
     NK_ASSERT(o);
@@ -88,15 +125,43 @@ nk_widget_text_wrap(struct nk_command_buffer *o, struct nk_rect b,
     line.w = b.w - 2 * t->padding.x;
     line.h = 2 * t->padding.y + f->height;
 
-    fitting = nk_text_clamp(f, string, len, line.w, &glyphs, &width, seperator,NK_LEN(seperator));
+    if (o->text_cache)
+        cached = nk_text_cache_get(o->text_cache, f, string, len, NK_TEXT_CACHE_WRAP);
+    if (cached && cached->space != line.w) {
+        /* line breaks depend on the available width */
+        cached->space = line.w;
+        cached->line_count = 0;
+    }
     while (done < len) {
-        if (!fitting || line.y + line.h >= (b.y + b.h)) break;
-        nk_widget_text(o, line, &string[done], fitting, &text, NK_TEXT_LEFT, f);
+        if (line.y + line.h >= (b.y + b.h)) break;
+        if (cached && line_index < cached->line_count) {
+            fitting = cached->lines[line_index];
+            line_width = cached->line_widths[line_index];
+        } else {
+            fitting = nk_text_clamp(f, &string[done], len - done, line.w, &glyphs, &width, seperator,NK_LEN(seperator));
+            line_width = (fitting) ? f->width(f->userdata, f->height, &string[done], fitting): 0;
+            /* past NK_TEXT_CACHE_MAX_LINES the rest is wrapped uncached */
+            if (cached && line_index == cached->line_count)
+                nk_text_cache_push_line(o->text_cache, cached, fitting, line_width);
+        }
+        if (!fitting) break;
+        nk_widget_text_measured(o, line, &string[done], fitting, &text, NK_TEXT_LEFT, f, line_width, 0);
         done += fitting;
         line.y += f->height + 2 * t->padding.y;
-        fitting = nk_text_clamp(f, &string[done], len - done, line.w, &glyphs, &width, seperator,NK_LEN(seperator));
+        line_index++;
     }
 }
+NK_API nk_bool
+nk_set_text_ref(struct nk_context *ctx, nk_bool enable)
+{
+    nk_bool previous;
+    NK_ASSERT(ctx);
+    NK_ASSERT(ctx->current);
+    if (!ctx || !ctx->current) return nk_false;
+    previous = ctx->current->buffer.use_text_ref != 0;
+    ctx->current->buffer.use_text_ref = enable != 0;
+    return previous;
+}
 NK_API void
 nk_text_colored(struct nk_context *ctx, const char *str, int len,
     nk_flags alignment, struct nk_color color)
@@ -191,8 +256,12 @@ nk_labelfv_colored(struct nk_context *ctx, nk_flags flags,
     struct nk_color color, const char *fmt, va_list args)
 {
     char buf[256];
+    nk_bool text_ref;
     nk_strfmt(buf, NK_LEN(buf), fmt, args);
+    /* `buf` is gone before the frame is drawn so it is always copied */
+    text_ref = nk_set_text_ref(ctx, nk_false);
     nk_label_colored(ctx, buf, flags, color);
+    nk_set_text_ref(ctx, text_ref);
 }
 
 NK_API void
@@ -200,24 +269,36 @@ nk_labelfv_colored_wrap(struct nk_context *ctx, struct nk_color color,
     const char *fmt, va_list args)
 {
     char buf[256];
+    nk_bool text_ref;
     nk_strfmt(buf, NK_LEN(buf), fmt, args);
+    /* `buf` is gone before the frame is drawn so it is always copied */
+    text_ref = nk_set_text_ref(ctx, nk_false);
     nk_label_colored_wrap(ctx, buf, color);
+    nk_set_text_ref(ctx, text_ref);
 }
 
 NK_API void
 nk_labelfv(struct nk_context *ctx, nk_flags flags, const char *fmt, va_list args)
 {
     char buf[256];
+    nk_bool text_ref;
     nk_strfmt(buf, NK_LEN(buf), fmt, args);
+    /* `buf` is gone before the frame is drawn so it is always copied */
+    text_ref = nk_set_text_ref(ctx, nk_false);
     nk_label(ctx, buf, flags);
+    nk_set_text_ref(ctx, text_ref);
 }
 
 NK_API void
 nk_labelfv_wrap(struct nk_context *ctx, const char *fmt, va_list args)
 {
     char buf[256];
+    nk_bool text_ref;
     nk_strfmt(buf, NK_LEN(buf), fmt, args);
+    /* `buf` is gone before the frame is drawn so it is always copied */
+    text_ref = nk_set_text_ref(ctx, nk_false);
     nk_label_wrap(ctx, buf);
+    nk_set_text_ref(ctx, text_ref);
 }
 
 NK_API void
@@ -0,0 +1,188 @@
+#include "nuklear.h"
+#include "nuklear_internal.h"
+
+/* ===============================================================
+ *
+ *                          TEXT CACHE
+ *
+ * ===============================================================*/
+/* Two way set associative table of measured texts. Every entry owns one
+ * block from the context allocator holding a copy of its text and, for
+ * wrapped paragraphs, its line breaks. A lookup that has to evict an entry
+ * used in this or the last frame is a conflict. Once more than one in
+ * NK_TEXT_CACHE_GROW_RATIO lookups of a frame conflict, the table doubles at
+ * the end of that frame. */
+NK_INTERN void
+nk_text_cache_release(struct nk_text_cache *cache, struct nk_text_cache_entry *e)
+{
+    if (e->text) cache->alloc.free(cache->alloc.userdata, e->text);
+    nk_zero_struct(*e);
+}
+NK_INTERN nk_bool
+nk_text_cache_store(struct nk_text_cache *cache, struct nk_text_cache_entry *e,
+    const char *text, int len, int line_capacity)
+{
+    /* (re)allocates the block of an entry, keeping the lines already in it */
+    nk_size text_size = ((nk_size)len + 7) & ~(nk_size)7;
+    nk_size size = text_size + (nk_size)line_capacity * (sizeof(int) + sizeof(float));
+    char *block = (char*)cache->alloc.alloc(cache->alloc.userdata, 0, size);
+    int *lines;
+    float *line_widths;
+
+    if (!block) return nk_false;
+    NK_MEMCPY(block, text, (nk_size)len);
+    lines = (int*)(void*)(block + text_size);
+    line_widths = (float*)(void*)(lines + line_capacity);
+    if (e->line_count) {
+        NK_MEMCPY(lines, e->lines, (nk_size)e->line_count * sizeof(int));
+        NK_MEMCPY(line_widths, e->line_widths, (nk_size)e->line_count * sizeof(float));
+    }
+    if (e->text) cache->alloc.free(cache->alloc.userdata, e->text);
+    e->text = block;
+    e->lines = lines;
+    e->line_widths = line_widths;
+    e->line_capacity = line_capacity;
+    return nk_true;
+}
+NK_INTERN nk_bool
+nk_text_cache_resize(struct nk_text_cache *cache, int capacity)
+{
+    /* moves the entries into a table of `capacity` entries */
+    struct nk_text_cache_entry *entries;
+    nk_size size = (nk_size)capacity * sizeof(struct nk_text_cache_entry);
+    int i;
+
+    entries = (struct nk_text_cache_entry*)cache->alloc.alloc(cache->alloc.userdata, 0, size);
+    if (!entries) return nk_false;
+    nk_zero(entries, size);
+    for (i = 0; i < cache->capacity; ++i) {
+        struct nk_text_cache_entry *e = &cache->entries[i], *a, *b, *dst;
+        int slot = (int)(e->hash & (nk_hash)(capacity - 1)) & ~1;
+        if (!e->text) continue;
+        a = &entries[slot];
+        b = &entries[slot + 1];
+        dst = (!a->text) ? a: (!b->text) ? b: (a->stamp <= b->stamp) ? a: b;
+        if (dst->text) {
+            if (dst->stamp > e->stamp) {
+                nk_text_cache_release(cache, e);
+                continue;
+            }
+            nk_text_cache_release(cache, dst);
+        }
+        *dst = *e;
+    }
+    if (cache->entries)
+        cache->alloc.free(cache->alloc.userdata, cache->entries);
+    cache->entries = entries;
+    cache->capacity = capacity;
+    return nk_true;
+}
+NK_INTERN nk_bool
+nk_text_cache_match(const struct nk_text_cache_entry *e,
+    const struct nk_user_font *font, nk_hash hash, const char *text, int len,
+    enum nk_text_cache_kind kind)
+{
+    int i;
+    if (!e->text || e->font != font || e->hash != hash || e->len != len ||
+        e->kind != (int)kind || e->font_height != font->height)
+        return nk_false;
+    for (i = 0; i < len; ++i)
+        if (e->text[i] != text[i]) return nk_false;
+    return nk_true;
+}
+NK_LIB void
+nk_text_cache_clear(struct nk_text_cache *cache)
+{
+    int i;
+    NK_ASSERT(cache);
+    if (!cache) return;
+    for (i = 0; i < cache->capacity; ++i)
+        nk_text_cache_release(cache, &cache->entries[i]);
+}
+NK_LIB void
+nk_text_cache_free(struct nk_text_cache *cache)
+{
+    NK_ASSERT(cache);
+    if (!cache || !cache->entries) return;
+    nk_text_cache_clear(cache);
+    cache->alloc.free(cache->alloc.userdata, cache->entries);
+    cache->entries = 0;
+    cache->capacity = 0;
+}
+NK_LIB void
+nk_text_cache_frame(struct nk_text_cache *cache)
+{
+    /* called at the end of a frame */
+    NK_ASSERT(cache);
+    if (!cache) return;
+    if (cache->capacity < NK_TEXT_CACHE_MAX_SIZE &&
+        (nk_uint)cache->conflicts * NK_TEXT_CACHE_GROW_RATIO > cache->stamp - cache->frame)
+        nk_text_cache_resize(cache, cache->capacity * 2);
+    cache->conflicts = 0;
+    cache->last_frame = cache->frame;
+    cache->frame = cache->stamp;
+}
+NK_LIB struct nk_text_cache_entry*
+nk_text_cache_get(struct nk_text_cache *cache, const struct nk_user_font *font,
+    const char *text, int len, enum nk_text_cache_kind kind)
+{
+    struct nk_text_cache_entry *a, *b, *e;
+    nk_hash hash;
+    int slot;
+
+    NK_ASSERT(cache);
+    NK_ASSERT(font);
+    if (!cache || !font || !text || len <= 0 || !cache->alloc.alloc) return 0;
+    if (!cache->entries && !nk_text_cache_resize(cache, NK_TEXT_CACHE_SIZE))
+        return 0;
+
+    /* two way set associative: look at both entries of the set */
+    hash = nk_murmur_hash(text, len, (nk_hash)kind);
+    slot = (int)(hash & (nk_hash)(cache->capacity - 1)) & ~1;
+    a = &cache->entries[slot];
+    b = &cache->entries[slot + 1];
+    cache->stamp++;
+
+    if (nk_text_cache_match(a, font, hash, text, len, kind))
+        e = a;
+    else if (nk_text_cache_match(b, font, hash, text, len, kind))
+        e = b;
+    else {
+        /* miss: evict the least recently used entry of the set */
+        e = (a->stamp <= b->stamp) ? a: b;
+        if (e->text && e->stamp > cache->last_frame)
+            cache->conflicts++;
+        nk_text_cache_release(cache, e);
+        if (!nk_text_cache_store(cache, e, text, len, 0))
+            return 0;
+        e->font = font;
+        e->font_height = font->height;
+        e->hash = hash;
+        e->len = len;
+        e->kind = (int)kind;
+        e->width = -1.0f;
+        e->space = -1.0f;
+    }
+    e->stamp = cache->stamp;
+    return e;
+}
+NK_LIB nk_bool
+nk_text_cache_push_line(struct nk_text_cache *cache, struct nk_text_cache_entry *e,
+    int fitting, float width)
+{
+    /* appends the next line break of a paragraph, fails once the entry holds
+     * NK_TEXT_CACHE_MAX_LINES of them */
+    NK_ASSERT(cache);
+    NK_ASSERT(e);
+    if (!cache || !e) return nk_false;
+    if (e->line_count == e->line_capacity) {
+        int capacity = NK_MIN(NK_TEXT_CACHE_MAX_LINES, NK_MAX(8, 2 * e->line_capacity));
+        if (capacity <= e->line_capacity ||
+            !nk_text_cache_store(cache, e, e->text, e->len, capacity))
+            return nk_false;
+    }
+    e->lines[e->line_count] = fitting;
+    e->line_widths[e->line_count] = width;
+    e->line_count++;
+    return nk_true;
+}
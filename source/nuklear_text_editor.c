@@ -28,8 +28,256 @@ struct nk_text_edit_row {
 NK_INTERN void nk_textedit_makeundo_delete(struct nk_text_edit*, int, int);
 NK_INTERN void nk_textedit_makeundo_insert(struct nk_text_edit*, int, int);
 NK_INTERN void nk_textedit_makeundo_replace(struct nk_text_edit*, int, int, int);
+NK_INTERN void nk_textedit_journal_record(struct nk_text_edit*, int, int, int, nk_bool);
 #define NK_TEXT_HAS_SELECTION(s)   ((s)->select_start != (s)->select_end)
 
+NK_INTERN void
+nk_textedit_copy_runes(const struct nk_text_edit *state, int where, int length,
+    nk_rune *dst)
+{
+    /* decode the whole range in one batch instead of one lookup per rune */
+    int count = nk_str_decode_runes(&state->string, where, dst, length);
+    for (; count < length; ++count)
+        dst[count] = 0;
+}
+
+/* Line table: `lines` caches where every line starts and how wide it is.
+ * Edits shift the lines behind them and mark the touched line for
+ * measuring, `nk_textedit_lines_sync` measures marked lines and splits or
+ * joins them whenever line breaks were added or removed. With `wrap` set
+ * the table holds rows instead: long lines are broken after the last space
+ * that still fits. Since whether a row ends early depends on the first word
+ * of the row behind it, edits mark the row in front of the edit as well. */
+NK_INTERN struct nk_text_edit_line*
+nk_textedit_lines_insert(struct nk_text_edit_lines *lines, int at, int begin)
+{
+    struct nk_text_edit_line *line;
+    if (!nk_buffer_alloc(&lines->buffer, NK_BUFFER_FRONT,
+        sizeof(struct nk_text_edit_line), NK_ALIGNOF(struct nk_text_edit_line)))
+        return 0;
+
+    /* memmove */
+    line = (struct nk_text_edit_line*)lines->buffer.memory.ptr;
+    if (at < lines->count)
+        NK_MEMCPY(line + at + 1, line + at,
+            (nk_size)(lines->count - at) * sizeof(struct nk_text_edit_line));
+    line[at].begin = begin;
+    line[at].width = -1.0f;
+    lines->count++;
+    return line;
+}
+NK_INTERN void
+nk_textedit_lines_remove(struct nk_text_edit_lines *lines, int at, int n)
+{
+    struct nk_text_edit_line *line;
+    if (n <= 0) return;
+    /* memmove */
+    line = (struct nk_text_edit_line*)lines->buffer.memory.ptr;
+    if (at + n < lines->count)
+        NK_MEMCPY(line + at, line + at + n,
+            (nk_size)(lines->count - at - n) * sizeof(struct nk_text_edit_line));
+    lines->count -= n;
+    lines->buffer.allocated -= (nk_size)n * sizeof(struct nk_text_edit_line);
+}
+NK_LIB int
+nk_textedit_lines_find(const struct nk_text_edit *state, int pos)
+{
+    /* returns the line containing rune `pos` */
+    const struct nk_text_edit_line *line;
+    int lo = 0, hi = state->lines.count - 1;
+    if (hi <= 0) return 0;
+    line = (const struct nk_text_edit_line*)state->lines.buffer.memory.ptr;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (line[mid].begin <= pos)
+            lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
+NK_INTERN void
+nk_textedit_lines_changed(struct nk_text_edit *state, int where,
+    int removed, int inserted)
+{
+    /* `removed` runes at `where` were replaced by `inserted` runes */
+    struct nk_text_edit_lines *lines = &state->lines;
+    struct nk_text_edit_line *line;
+    int i, j;
+
+    if (!lines->count || (!removed && !inserted)) return;
+    line = (struct nk_text_edit_line*)lines->buffer.memory.ptr;
+    i = nk_textedit_lines_find(state, where);
+    line[i].width = -1.0f;
+    if (lines->wrapped > 0 && i > 0)
+        line[i-1].width = -1.0f;
+
+    /* lines whose line break got deleted are joined with line `i` */
+    for (j = i + 1; j < lines->count && line[j].begin <= where + removed; ++j);
+    nk_textedit_lines_remove(lines, i + 1, j - (i + 1));
+    for (j = i + 1; j < lines->count; ++j)
+        line[j].begin += inserted - removed;
+    lines->len += inserted - removed;
+    lines->size = nk_str_len_char(&state->string);
+    lines->dirty = nk_true;
+}
+NK_INTERN int
+nk_textedit_lines_wrap(const struct nk_text_edit *state, int begin, int at,
+    const struct nk_user_font *font, float *width)
+{
+    /* measures the row starting at rune `begin` and byte `at` and returns
+     * where the next row starts or -1 if it is the last row. Spaces may hang
+     * over the wrap width, every row holds at least one glyph. */
+    struct nk_text_advancer adv;
+    float wrap = state->lines.wrapped;
+    float row_width = 0, space_width = 0;
+    int glyphs = 0, space = -1;
+    int end = nk_str_len_char(&state->string);
+
+    while (at < end) {
+        int byte_len;
+        int text_len = 0;
+        int glyph_len;
+        nk_rune unicode;
+        const char *text = nk_str_span(&state->string, at, &byte_len);
+        if (!text) break;
+
+        nk_text_advancer_init(&adv, font, text, byte_len);
+        glyph_len = nk_utf_decode(text, &unicode, byte_len);
+        while (text_len < byte_len && glyph_len) {
+            float w;
+            if (unicode == '\n') {
+                *width = row_width;
+                return begin + glyphs + 1;
+            }
+            if (unicode != '\r') {
+                w = nk_text_advancer_next(&adv, text_len, glyph_len);
+                if (glyphs && unicode != ' ' && row_width + w > wrap) {
+                    if (space >= 0) {
+                        *width = space_width;
+                        return begin + space + 1;
+                    }
+                    *width = row_width;
+                    return begin + glyphs;
+                }
+                if (unicode == ' ') {
+                    space = glyphs;
+                    space_width = row_width;
+                }
+                row_width += w;
+            }
+            glyphs++;
+            text_len += glyph_len;
+            glyph_len = nk_utf_decode(text + text_len, &unicode, byte_len - text_len);
+        }
+        if (text_len < byte_len) break;
+        at += byte_len;
+    }
+    *width = row_width;
+    return -1;
+}
+NK_LIB float
+nk_textedit_measure(const struct nk_str *s, int begin, int end,
+    const struct nk_user_font *font, int *glyphs, nk_bool *newline)
+{
+    /* measures the bytes [begin, end) of `s` up to the first line break,
+     * one piece around the gap at a time. `glyphs` counts the line break */
+    float width = 0;
+    *glyphs = 0;
+    if (newline) *newline = nk_false;
+    while (begin < end) {
+        int n, g = 0;
+        const char *remaining = 0;
+        const char *text = nk_str_span(s, begin, &n);
+        if (!text) break;
+        n = NK_MIN(n, end - begin);
+        width += nk_text_calculate_text_bounds(font, text, n, font->height,
+            &remaining, 0, &g, NK_STOP_ON_NEW_LINE).x;
+        *glyphs += g;
+        if (!remaining || remaining < text + n) {
+            if (newline) *newline = remaining && *remaining == '\n';
+            break;
+        }
+        begin += n;
+    }
+    return width;
+}
+NK_INTERN int
+nk_textedit_lines_measure(struct nk_text_edit *state, int begin,
+    const struct nk_user_font *font, float *width)
+{
+    /* measures the line starting at rune `begin` and returns where the next
+     * line starts or -1 if it is the last line */
+    int at, glyphs = 0;
+    nk_bool newline;
+
+    *width = 0;
+    if (begin >= state->string.len) return -1;
+    at = nk_str_rune_offset(&state->string, begin);
+    if (at < 0) return -1;
+    if (state->lines.wrapped > 0)
+        return nk_textedit_lines_wrap(state, begin, at, font, width);
+    *width = nk_textedit_measure(&state->string, at,
+        nk_str_len_char(&state->string), font, &glyphs, &newline);
+    return (newline) ? begin + glyphs: -1;
+}
+NK_LIB int
+nk_textedit_lines_sync(struct nk_text_edit *state, const struct nk_user_font *font)
+{
+    /* brings the line table up to date, returns 0 if there is none */
+    struct nk_text_edit_lines *lines = &state->lines;
+    struct nk_text_edit_line *line;
+    int i;
+
+    if (lines->buffer.type != NK_BUFFER_DYNAMIC || !lines->buffer.memory.ptr || !font)
+        return 0;
+    /* edits keep `len` and `size` up to date, text changed without the
+     * text editor most likely changed either */
+    if (lines->font != font || lines->font_height != font->height ||
+        lines->len != state->string.len || lines->wrapped != lines->wrap ||
+        lines->size != nk_str_len_char(&state->string))
+        lines->count = 0;
+    if (!lines->count) {
+        nk_buffer_clear(&lines->buffer);
+        if (!nk_textedit_lines_insert(lines, 0, 0))
+            return 0;
+        lines->font = font;
+        lines->font_height = font->height;
+        lines->len = state->string.len;
+        lines->size = nk_str_len_char(&state->string);
+        lines->wrapped = lines->wrap;
+        lines->dirty = nk_true;
+    }
+    if (!lines->dirty) return 1;
+
+    for (i = 0; i < lines->count; ++i) {
+        int j, next;
+        float width;
+        line = (struct nk_text_edit_line*)lines->buffer.memory.ptr;
+        if (line[i].width >= 0) continue;
+
+        next = nk_textedit_lines_measure(state, line[i].begin, font, &width);
+        line[i].width = width;
+        for (j = i + 1; j < lines->count && (next < 0 || line[j].begin < next); ++j);
+        nk_textedit_lines_remove(lines, i + 1, j - (i + 1));
+        if (next >= 0 && (i + 1 == lines->count || line[i+1].begin != next)) {
+            if (!nk_textedit_lines_insert(lines, i + 1, next)) {
+                lines->count = 0;
+                return 0;
+            }
+        }
+    }
+    lines->dirty = nk_false;
+    return 1;
+}
+NK_LIB nk_bool
+nk_textedit_lines_wrapped(const struct nk_text_edit *state, int pos)
+{
+    /* true if rune `pos` starts a row that continues the line of the row
+     * in front of it. Only valid right after `nk_textedit_lines_sync` */
+    return state->lines.count && state->lines.wrapped > 0 &&
+        pos > 0 && pos < state->string.len &&
+        nk_str_rune_at(&state->string, pos - 1) != '\n';
+}
 NK_INTERN float
 nk_textedit_get_width(const struct nk_text_edit *edit, int line_start, int char_id,
     const struct nk_user_font *font)
@@ -43,21 +291,35 @@ NK_INTERN void
 nk_textedit_layout_row(struct nk_text_edit_row *r, struct nk_text_edit *edit,
     int line_start_id, float row_height, const struct nk_user_font *font)
 {
-    int l;
+    int at;
     int glyphs = 0;
-    nk_rune unicode;
-    const char *remaining;
-    int len = nk_str_len_char(&edit->string);
-    const char *end = nk_str_get_const(&edit->string) + len;
-    const char *text = nk_str_at_const(&edit->string, line_start_id, &unicode, &l);
-    const struct nk_vec2 size = nk_text_calculate_text_bounds(font,
-        text, (int)(end - text), row_height, &remaining, 0, &glyphs, NK_STOP_ON_NEW_LINE);
+    float width = 0;
+
+    if (nk_textedit_lines_sync(edit, font)) {
+        const struct nk_text_edit_line *line;
+        int i = nk_textedit_lines_find(edit, line_start_id);
+        line = (const struct nk_text_edit_line*)edit->lines.buffer.memory.ptr;
+        if (line[i].begin == line_start_id) {
+            int next = (i + 1 < edit->lines.count) ? line[i+1].begin: edit->string.len;
+            r->x0 = 0.0f;
+            r->x1 = line[i].width;
+            r->baseline_y_delta = row_height;
+            r->ymin = 0.0f;
+            r->ymax = row_height;
+            r->num_chars = next - line_start_id;
+            return;
+        }
+    }
+
+    at = nk_str_rune_offset(&edit->string, line_start_id);
+    if (at >= 0) width = nk_textedit_measure(&edit->string, at,
+        nk_str_len_char(&edit->string), font, &glyphs, 0);
 
     r->x0 = 0.0f;
-    r->x1 = size.x;
-    r->baseline_y_delta = size.y;
+    r->x1 = width;
+    r->baseline_y_delta = row_height;
     r->ymin = 0.0f;
-    r->ymax = size.y;
+    r->ymax = row_height;
     r->num_chars = glyphs;
 }
 NK_INTERN int
@@ -73,20 +335,33 @@ nk_textedit_locate_coord(struct nk_text_edit *edit, float x, float y,
     r.ymin = r.ymax = 0;
     r.num_chars = 0;
 
-    /* search rows to find one that straddles 'y' */
-    while (i < n) {
-        nk_textedit_layout_row(&r, edit, i, row_height, font);
-        if (r.num_chars <= 0)
-            return n;
+    if (n && row_height > 0 && nk_textedit_lines_sync(edit, font)) {
+        /* all rows have the same height so the row is known right away */
+        const struct nk_text_edit_line *line;
+        int row;
+        if (y < 0) return 0;
+        row = (int)(y / row_height);
+        if (row >= edit->lines.count) return n;
+        line = (const struct nk_text_edit_line*)edit->lines.buffer.memory.ptr;
+        i = line[row].begin;
+        r.x1 = line[row].width;
+        r.num_chars = ((row + 1 < edit->lines.count) ? line[row+1].begin: n) - i;
+    } else {
+        /* search rows to find one that straddles 'y' */
+        while (i < n) {
+            nk_textedit_layout_row(&r, edit, i, row_height, font);
+            if (r.num_chars <= 0)
+                return n;
 
-        if (i==0 && y < base_y + r.ymin)
-            return 0;
+            if (i==0 && y < base_y + r.ymin)
+                return 0;
 
-        if (y < base_y + r.ymax)
-            break;
+            if (y < base_y + r.ymax)
+                break;
 
-        i += r.num_chars;
-        base_y += r.baseline_y_delta;
+            i += r.num_chars;
+            base_y += r.baseline_y_delta;
+        }
     }
 
     /* below all text, return 'after' last character */
@@ -116,7 +391,8 @@ nk_textedit_locate_coord(struct nk_text_edit *edit, float x, float y,
 
     /* if the last character is a newline, return that.
      * otherwise return 'after' the last character */
-    if (nk_str_rune_at(&edit->string, i+r.num_chars-1) == '\n')
+    if (nk_str_rune_at(&edit->string, i+r.num_chars-1) == '\n' ||
+        nk_textedit_lines_wrapped(edit, i+r.num_chars))
         return i+r.num_chars-1;
     else return i+r.num_chars;
 }
@@ -154,6 +430,37 @@ nk_textedit_find_charpos(struct nk_text_find *find, struct nk_text_edit *state,
     int i=0, first;
 
     nk_zero_struct(r);
+    if (nk_textedit_lines_sync(state, font)) {
+        const struct nk_text_edit_line *line;
+        int row;
+        line = (const struct nk_text_edit_line*)state->lines.buffer.memory.ptr;
+        find->height = row_height;
+        if (n == z) {
+            /* same answer as walking all rows below: the empty row behind the text */
+            find->y = 0;
+            if (single_line) {
+                find->first_char = 0;
+                find->length = z;
+                find->x = line[0].width;
+                find->prev_first = 0;
+            } else {
+                find->first_char = z;
+                find->length = 0;
+                find->x = 0;
+                find->prev_first = (z) ? line[nk_textedit_lines_find(state, z-1)].begin: 0;
+            }
+            return;
+        }
+        row = nk_textedit_lines_find(state, n);
+        find->first_char = first = line[row].begin;
+        find->length = ((row + 1 < state->lines.count) ? line[row+1].begin: z) - first;
+        find->prev_first = (row) ? line[row-1].begin: 0;
+        find->y = (float)row * row_height;
+        find->x = 0;
+        for (i=0; first+i < n; ++i)
+            find->x += nk_textedit_get_width(state, first, i, font);
+        return;
+    }
     if (n == z) {
         /* if it's at the end, then find the last line -- simpler than trying to
         explicitly handle this case in the regular code */
@@ -217,8 +524,10 @@ NK_API void
 nk_textedit_delete(struct nk_text_edit *state, int where, int len)
 {
     /* delete characters while updating undo */
+    int n = state->string.len;
     nk_textedit_makeundo_delete(state, where, len);
     nk_str_delete_runes(&state->string, where, len);
+    nk_textedit_lines_changed(state, where, n - state->string.len, 0);
     state->has_preferred_x = 0;
 }
 NK_API void
@@ -339,12 +648,40 @@ nk_textedit_cut(struct nk_text_edit *state)
     }
    return 0;
 }
+NK_INTERN int
+nk_textedit_insert_run(struct nk_text_edit *state, const char *text, int len)
+{
+    /* splice a run of glyphs in at the cursor with a single insert. A fixed
+     * buffer rejects the whole run once it would overflow, so fill it up
+     * glyph by glyph instead. Returns the number of glyphs inserted. */
+    int n = state->string.len;
+    int at = 0;
+    int glyph_len;
+    nk_rune unicode;
+
+    if (len <= 0) return 0;
+    if (!nk_str_insert_at_rune(&state->string, state->cursor, text, len)) {
+        while (at < len) {
+            glyph_len = nk_utf_decode(text + at, &unicode, len - at);
+            if (!glyph_len || !nk_str_insert_at_rune(&state->string,
+                state->cursor + (state->string.len - n), text + at, glyph_len))
+                break;
+            at += glyph_len;
+        }
+    }
+    n = state->string.len - n;
+    if (n) {
+        nk_textedit_lines_changed(state, state->cursor, 0, n);
+        state->cursor += n;
+    }
+    return n;
+}
 NK_API nk_bool
 nk_textedit_paste(struct nk_text_edit *state, char const *ctext, int len)
 {
     /* API paste: replace existing selection with passed-in text */
+    int where;
     int glyphs;
-    const char *text = (const char *) ctext;
     if (state->mode == NK_TEXT_EDIT_MODE_VIEW) return 0;
 
     /* if there's a selection, the paste should delete it */
@@ -352,28 +689,27 @@ nk_textedit_paste(struct nk_text_edit *state, char const *ctext, int len)
     nk_textedit_delete_selection(state);
 
     /* try to insert the characters */
-    glyphs = nk_utf_len(ctext, len);
-    if (nk_str_insert_text_char(&state->string, state->cursor, text, len)) {
-        nk_textedit_makeundo_insert(state, state->cursor, glyphs);
-        state->cursor += len;
+    where = state->cursor;
+    glyphs = nk_textedit_insert_run(state, ctext, len);
+    if (glyphs) {
+        /* a paste is never merged into the typing around it */
+        if (state->undo.journal.pool.alloc)
+            nk_textedit_journal_record(state, where, 0, glyphs, nk_false);
+        else nk_textedit_makeundo_insert(state, where, glyphs);
         state->has_preferred_x = 0;
         return 1;
     }
-    /* remove the undo since we didn't actually insert the characters */
-    if (state->undo.undo_point)
-        --state->undo.undo_point;
     return 0;
 }
-NK_API void
-nk_textedit_text(struct nk_text_edit *state, const char *text, int total_len)
+NK_INTERN void
+nk_textedit_replace_text(struct nk_text_edit *state, const char *text, int total_len)
 {
+    /* replace mode overwrites one glyph per typed glyph so it has to keep
+     * going glyph by glyph */
     nk_rune unicode;
     int glyph_len;
     int text_len = 0;
-
-    NK_ASSERT(state);
-    NK_ASSERT(text);
-    if (!text || !total_len || state->mode == NK_TEXT_EDIT_MODE_VIEW) return;
+    int n;
 
     glyph_len = nk_utf_decode(text, &unicode, total_len);
     while ((text_len < total_len) && glyph_len)
@@ -388,21 +724,25 @@ nk_textedit_text(struct nk_text_edit *state, const char *text, int total_len)
         if (!NK_TEXT_HAS_SELECTION(state) &&
             state->cursor < state->string.len)
         {
-            if (state->mode == NK_TEXT_EDIT_MODE_REPLACE) {
-                nk_textedit_makeundo_replace(state, state->cursor, 1, 1);
-                nk_str_delete_runes(&state->string, state->cursor, 1);
-            }
+            n = state->string.len;
+            nk_textedit_makeundo_replace(state, state->cursor, 1, 1);
+            nk_str_delete_runes(&state->string, state->cursor, 1);
+            nk_textedit_lines_changed(state, state->cursor, n - state->string.len, 0);
+            n = state->string.len;
             if (nk_str_insert_text_utf8(&state->string, state->cursor,
                                         text+text_len, 1))
             {
+                nk_textedit_lines_changed(state, state->cursor, 0, state->string.len - n);
                 ++state->cursor;
                 state->has_preferred_x = 0;
             }
         } else {
             nk_textedit_delete_selection(state); /* implicitly clamps */
+            n = state->string.len;
             if (nk_str_insert_text_utf8(&state->string, state->cursor,
                                         text+text_len, 1))
             {
+                nk_textedit_lines_changed(state, state->cursor, 0, state->string.len - n);
                 nk_textedit_makeundo_insert(state, state->cursor, 1);
                 state->cursor = NK_MIN(state->cursor + 1, state->string.len);
                 state->has_preferred_x = 0;
@@ -413,6 +753,65 @@ nk_textedit_text(struct nk_text_edit *state, const char *text, int total_len)
         glyph_len = nk_utf_decode(text + text_len, &unicode, total_len-text_len);
     }
 }
+NK_API void
+nk_textedit_text(struct nk_text_edit *state, const char *text, int total_len)
+{
+    nk_rune unicode;
+    int glyph_len;
+    int text_len = 0;
+    int run_begin = 0;
+    int where = -1;
+    int inserted = 0;
+    int full = 0;
+
+    NK_ASSERT(state);
+    NK_ASSERT(text);
+    if (!text || !total_len || state->mode == NK_TEXT_EDIT_MODE_VIEW) return;
+    if (state->mode == NK_TEXT_EDIT_MODE_REPLACE) {
+        nk_textedit_replace_text(state, text, total_len);
+        return;
+    }
+
+    /* insert mode: filter the input once and splice each maximal run of
+     * accepted glyphs in with a single insert and one undo record */
+    glyph_len = nk_utf_decode(text, &unicode, total_len);
+    while (!full && run_begin < total_len)
+    {
+        int skip = 0;
+        if (text_len < total_len && glyph_len) {
+            /* don't insert a backward delete, just process the event */
+            if (unicode == 127) skip = 1;
+            /* can't add newline in single-line mode */
+            else if (unicode == '\n' && state->single_line) skip = 1;
+            /* filter incoming text */
+            else if (state->filter && !state->filter(state, unicode)) skip = 1;
+            if (!skip) {
+                text_len += glyph_len;
+                glyph_len = nk_utf_decode(text + text_len, &unicode, total_len-text_len);
+                continue;
+            }
+        }
+        if (text_len > run_begin) {
+            int run = text_len - run_begin;
+            int n;
+            if (where < 0) {
+                nk_textedit_delete_selection(state); /* implicitly clamps */
+                where = state->cursor;
+            }
+            n = nk_textedit_insert_run(state, text + run_begin, run);
+            inserted += n;
+            full = (n < nk_utf_len(text + run_begin, run));
+        }
+        if (text_len >= total_len || !glyph_len) break;
+        text_len += glyph_len;
+        run_begin = text_len;
+        glyph_len = nk_utf_decode(text + text_len, &unicode, total_len-text_len);
+    }
+    if (inserted) {
+        nk_textedit_makeundo_insert(state, where, inserted);
+        state->has_preferred_x = 0;
+    }
+}
 NK_LIB void
 nk_textedit_key(struct nk_text_edit *state, enum nk_keys key, int shift_mod,
     const struct nk_user_font *font, float row_height)
@@ -702,7 +1101,8 @@ retry:
                 font, row_height);
             state->has_preferred_x = 0;
             state->cursor = find.first_char + find.length;
-            if (find.length > 0 && nk_str_rune_at(&state->string, state->cursor-1) == '\n')
+            if (find.length > 0 && (nk_str_rune_at(&state->string, state->cursor-1) == '\n' ||
+                nk_textedit_lines_wrapped(state, state->cursor)))
                 --state->cursor;
             state->select_end = state->cursor;
         } else {
@@ -714,11 +1114,324 @@ retry:
 
             state->has_preferred_x = 0;
             state->cursor = find.first_char + find.length;
-            if (find.length > 0 && nk_str_rune_at(&state->string, state->cursor-1) == '\n')
+            if (find.length > 0 && (nk_str_rune_at(&state->string, state->cursor-1) == '\n' ||
+                nk_textedit_lines_wrapped(state, state->cursor)))
                 --state->cursor;
         }} break;
     }
 }
+/* Undo journal: optional replacement for the fixed undo arrays. Entries
+ * live in a ring, counted from slot `first` the oldest `undo_count` entries
+ * can be undone and the `redo_count` entries behind them redone. Every entry
+ * keeps the text it removed followed by the text it inserted in a second
+ * ring of bytes, so undoing and redoing it only swaps the two. Text never
+ * wraps around the end of that ring, a span that would is moved to the
+ * front instead. The newest entry stays open (`inserted_bytes < 0`) and
+ * saves the text it inserted only once a change is made that cannot be
+ * merged into it, which is how consecutive typing becomes a single entry.
+ * If that text does not fit into the journal the entry keeps only the text
+ * it removed (`inserted` runes but no `inserted_bytes`): it can still be
+ * undone, but not redone. */
+#define NK_TEXTEDIT_JOURNAL_SLOT(j, i)\
+    (&(j)->entries[((j)->first + (i)) & ((j)->entry_cap - 1)])
+#define NK_TEXTEDIT_JOURNAL_TEXT(j, at)\
+    ((j)->text + ((at) & (nk_size)((j)->text_cap - 1)))
+
+NK_INTERN void
+nk_textedit_journal_reset(struct nk_text_undo_journal *j)
+{
+    j->first = 0;
+    j->undo_count = j->redo_count = 0;
+    j->text_begin = j->text_end = 0;
+}
+NK_INTERN void
+nk_textedit_journal_free(struct nk_text_undo_journal *j)
+{
+    if (j->pool.free) {
+        if (j->entries) j->pool.free(j->pool.userdata, j->entries);
+        if (j->text) j->pool.free(j->pool.userdata, j->text);
+    }
+    nk_zero_struct(*j);
+}
+NK_INTERN int
+nk_textedit_journal_span(const struct nk_text_undo_entry *e)
+{
+    return e->removed_bytes + NK_MAX(e->inserted_bytes, 0);
+}
+NK_INTERN void
+nk_textedit_journal_drop_oldest(struct nk_text_undo_journal *j)
+{
+    /* nothing is moved, the slot and its text are simply left behind */
+    j->first = (j->first + 1) & (j->entry_cap - 1);
+    j->undo_count--;
+    j->text_begin = (j->undo_count + j->redo_count) ?
+        NK_TEXTEDIT_JOURNAL_SLOT(j, 0)->text: j->text_end;
+}
+NK_INTERN void
+nk_textedit_journal_flush_redo(struct nk_text_undo_journal *j)
+{
+    struct nk_text_undo_entry *e;
+    if (!j->redo_count) return;
+    j->redo_count = 0;
+    if (!j->undo_count) {
+        j->text_begin = j->text_end = 0;
+        return;
+    }
+    e = NK_TEXTEDIT_JOURNAL_SLOT(j, j->undo_count - 1);
+    j->text_end = e->text + (nk_size)nk_textedit_journal_span(e);
+}
+NK_INTERN int
+nk_textedit_journal_grow_entries(struct nk_text_undo_journal *j)
+{
+    int i;
+    int count = j->undo_count + j->redo_count;
+    int cap = j->entry_cap ? j->entry_cap * 2: NK_MIN(16, NK_TEXTEDIT_JOURNAL_ENTRIES);
+    struct nk_text_undo_entry *mem;
+
+    if (cap > NK_TEXTEDIT_JOURNAL_ENTRIES) return 0;
+    mem = (struct nk_text_undo_entry*)j->pool.alloc(j->pool.userdata, 0,
+        (nk_size)cap * sizeof(struct nk_text_undo_entry));
+    if (!mem) return 0;
+    for (i = 0; i < count; ++i)
+        mem[i] = *NK_TEXTEDIT_JOURNAL_SLOT(j, i);
+    if (j->entries) j->pool.free(j->pool.userdata, j->entries);
+    j->entries = mem;
+    j->entry_cap = cap;
+    j->first = 0;
+    return 1;
+}
+NK_INTERN int
+nk_textedit_journal_grow_text(struct nk_text_undo_journal *j)
+{
+    /* moves the text of all entries to the front of a ring twice the size */
+    int i, n;
+    int count = j->undo_count + j->redo_count;
+    int cap = j->text_cap ? j->text_cap * 2: NK_MIN(256, NK_TEXTEDIT_JOURNAL_SIZE);
+    nk_size at = 0;
+    char *mem;
+
+    if (cap > NK_TEXTEDIT_JOURNAL_SIZE) return 0;
+    mem = (char*)j->pool.alloc(j->pool.userdata, 0, (nk_size)cap);
+    if (!mem) return 0;
+    for (i = 0; i < count; ++i) {
+        struct nk_text_undo_entry *e = NK_TEXTEDIT_JOURNAL_SLOT(j, i);
+        n = nk_textedit_journal_span(e);
+        if (n) NK_MEMCPY(mem + at, NK_TEXTEDIT_JOURNAL_TEXT(j, e->text), (nk_size)n);
+        e->text = at;
+        at += (nk_size)n;
+    }
+    if (j->text) j->pool.free(j->pool.userdata, j->text);
+    j->text = mem;
+    j->text_cap = cap;
+    j->text_begin = 0;
+    j->text_end = at;
+    return 1;
+}
+NK_INTERN int
+nk_textedit_journal_reserve(struct nk_text_undo_journal *j, int keep, int size,
+    int pinned, nk_size *at)
+{
+    /* makes room for `size` bytes at the end of the text. The last `keep`
+     * bytes belong to the newest entry and are moved along if they have to
+     * be, `pinned` is the number of newest entries that may not be dropped. */
+    NK_ASSERT(j->text_end - j->text_begin >= (nk_size)keep);
+    if (!keep && !size) {
+        *at = j->text_end;
+        return 1;
+    }
+    for (;;) {
+        nk_size start = j->text_end - (nk_size)keep;
+        nk_size need = (nk_size)(keep + size);
+        if (j->text_cap) {
+            nk_size phys = start & (nk_size)(j->text_cap - 1);
+            nk_size dst = start;
+            if (phys + need > (nk_size)j->text_cap)
+                dst += (nk_size)j->text_cap - phys;
+            if (dst + need - j->text_begin <= (nk_size)j->text_cap) {
+                /* a moved span lands in front of its old place, see above */
+                if (dst != start && keep)
+                    NK_MEMCPY(NK_TEXTEDIT_JOURNAL_TEXT(j, dst), j->text + phys, (nk_size)keep);
+                *at = dst;
+                j->text_end = dst + need;
+                return 1;
+            }
+        }
+        if (nk_textedit_journal_grow_text(j)) continue;
+        if (j->undo_count <= pinned) return 0;
+        nk_textedit_journal_drop_oldest(j);
+    }
+}
+NK_INTERN int
+nk_textedit_journal_copy(const struct nk_text_edit *state, int begin, int end,
+    int skip, int skip_len, char *dst)
+{
+    /* copies runes [begin, end) of the text as it was before `skip_len` runes
+     * got inserted at `skip`, returns the size in bytes */
+    const struct nk_str *s = &state->string;
+    int n;
+    if (!skip_len || skip >= end)
+        return nk_str_copy_text(s, begin, end - begin, dst);
+    if (skip <= begin)
+        return nk_str_copy_text(s, begin + skip_len, end - begin, dst);
+    n = nk_str_copy_text(s, begin, skip - begin, dst);
+    return n + nk_str_copy_text(s, skip + skip_len, end - skip, dst ? dst + n: 0);
+}
+NK_INTERN void
+nk_textedit_journal_seal(struct nk_text_edit *state, int skip, int skip_len)
+{
+    /* closes the newest entry by saving the text it inserted. `skip_len`
+     * runes inserted at `skip` after it was recorded do not belong to it. */
+    struct nk_text_undo_journal *j = &state->undo.journal;
+    struct nk_text_undo_entry *e;
+    int begin, end, bytes;
+    nk_size at;
+
+    if (!j->undo_count || j->redo_count) return;
+    e = NK_TEXTEDIT_JOURNAL_SLOT(j, j->undo_count - 1);
+    if (e->inserted_bytes >= 0) return;
+
+    begin = e->where;
+    end = e->where + e->inserted;
+    bytes = nk_textedit_journal_copy(state, begin, end, skip, skip_len, 0);
+    if (e->removed_bytes + bytes > NK_TEXTEDIT_JOURNAL_SIZE ||
+        !nk_textedit_journal_reserve(j, e->removed_bytes, bytes, 1, &at)) {
+        /* the change alone is bigger than the journal: keep what undoes it */
+        bytes = 0;
+        if (!nk_textedit_journal_reserve(j, e->removed_bytes, 0, 1, &at)) {
+            nk_textedit_journal_reset(j);
+            return;
+        }
+    }
+    e->text = at;
+    if (bytes) nk_textedit_journal_copy(state, begin, end, skip, skip_len,
+        NK_TEXTEDIT_JOURNAL_TEXT(j, at + (nk_size)e->removed_bytes));
+    e->inserted_bytes = bytes;
+}
+NK_INTERN void
+nk_textedit_journal_record(struct nk_text_edit *state, int where,
+    int removed, int inserted, nk_bool merge)
+{
+    /* `removed` runes at `where` are about to be replaced by `inserted` runes.
+     * Pure inserts are recorded after the fact, which is fine because only
+     * the removed text has to be saved right away. */
+    struct nk_text_undo_journal *j = &state->undo.journal;
+    struct nk_text_undo_entry *e = 0;
+    int bytes;
+    nk_size at;
+
+    /* a new change invalidates everything that could be redone */
+    nk_textedit_journal_flush_redo(j);
+    if (j->undo_count)
+        e = NK_TEXTEDIT_JOURNAL_SLOT(j, j->undo_count - 1);
+    if (merge && e && e->inserted_bytes < 0 && where == e->where + e->inserted) {
+        if (!removed && !e->removed) {
+            /* typing: extend the open run */
+            e->inserted += inserted;
+            goto close_line;
+        }
+        if (removed && removed == inserted && e->removed == e->inserted) {
+            /* overwriting: the replaced text goes behind the open entry's */
+            bytes = nk_str_copy_text(&state->string, where, removed, 0);
+            if (e->removed_bytes + bytes <= NK_TEXTEDIT_JOURNAL_SIZE &&
+                nk_textedit_journal_reserve(j, e->removed_bytes, bytes, 1, &at)) {
+                e->text = at;
+                nk_str_copy_text(&state->string, where, removed,
+                    NK_TEXTEDIT_JOURNAL_TEXT(j, at + (nk_size)e->removed_bytes));
+                e->removed += removed;
+                e->removed_bytes += bytes;
+                e->inserted += inserted;
+                return;
+            }
+            /* too big to merge, the replaced text starts an entry of its own */
+        }
+    }
+
+    /* start a new entry, inserts already happened and are skipped */
+    nk_textedit_journal_seal(state, where, removed ? 0: inserted);
+    if (j->undo_count == j->entry_cap && !nk_textedit_journal_grow_entries(j)) {
+        if (!j->undo_count) return;
+        nk_textedit_journal_drop_oldest(j);
+    }
+    bytes = nk_str_copy_text(&state->string, where, removed, 0);
+    if (bytes > NK_TEXTEDIT_JOURNAL_SIZE || !nk_textedit_journal_reserve(j, 0, bytes, 0, &at)) {
+        /* without the removed text nothing before this change can be undone */
+        nk_textedit_journal_reset(j);
+        return;
+    }
+    e = NK_TEXTEDIT_JOURNAL_SLOT(j, j->undo_count++);
+    e->where = where;
+    e->removed = removed;
+    e->inserted = inserted;
+    e->removed_bytes = bytes;
+    e->inserted_bytes = -1;
+    e->text = at;
+    if (bytes) nk_str_copy_text(&state->string, where, removed,
+        NK_TEXTEDIT_JOURNAL_TEXT(j, at));
+    if (!merge) {
+        nk_textedit_journal_seal(state, 0, 0);
+        return;
+    }
+
+close_line:
+    /* a typed line break ends the run */
+    if (!removed && inserted &&
+        nk_str_rune_at(&state->string, where + inserted - 1) == '\n')
+        nk_textedit_journal_seal(state, 0, 0);
+}
+NK_INTERN void
+nk_textedit_journal_undo(struct nk_text_edit *state)
+{
+    struct nk_text_undo_journal *j = &state->undo.journal;
+    struct nk_text_undo_entry *e;
+    int n;
+
+    nk_textedit_journal_seal(state, 0, 0);
+    if (!j->undo_count) return;
+    e = NK_TEXTEDIT_JOURNAL_SLOT(j, j->undo_count - 1);
+    if (e->inserted) {
+        n = state->string.len;
+        nk_str_delete_runes(&state->string, e->where, e->inserted);
+        nk_textedit_lines_changed(state, e->where, n - state->string.len, 0);
+    }
+    if (e->removed_bytes) {
+        n = state->string.len;
+        nk_str_insert_at_rune(&state->string, e->where,
+            NK_TEXTEDIT_JOURNAL_TEXT(j, e->text), e->removed_bytes);
+        nk_textedit_lines_changed(state, e->where, 0, state->string.len - n);
+    }
+    state->cursor = e->where + e->removed;
+    j->undo_count--;
+    j->redo_count++;
+    if (e->inserted && !e->inserted_bytes) {
+        /* the inserted text was not kept, so this and everything after
+         * it can not be redone */
+        nk_textedit_journal_flush_redo(j);
+    }
+}
+NK_INTERN void
+nk_textedit_journal_redo(struct nk_text_edit *state)
+{
+    struct nk_text_undo_journal *j = &state->undo.journal;
+    struct nk_text_undo_entry *e;
+    int n;
+
+    if (!j->redo_count) return;
+    e = NK_TEXTEDIT_JOURNAL_SLOT(j, j->undo_count);
+    if (e->removed) {
+        n = state->string.len;
+        nk_str_delete_runes(&state->string, e->where, e->removed);
+        nk_textedit_lines_changed(state, e->where, n - state->string.len, 0);
+    }
+    if (e->inserted_bytes > 0) {
+        n = state->string.len;
+        nk_str_insert_at_rune(&state->string, e->where, NK_TEXTEDIT_JOURNAL_TEXT(j,
+            e->text + (nk_size)e->removed_bytes), e->inserted_bytes);
+        nk_textedit_lines_changed(state, e->where, 0, state->string.len - n);
+    }
+    state->cursor = e->where + e->inserted;
+    j->undo_count++;
+    j->redo_count--;
+}
 NK_INTERN void
 nk_textedit_flush_redo(struct nk_text_undo_state *state)
 {
@@ -813,8 +1526,8 @@ nk_textedit_createundo(struct nk_text_undo_state *state, int pos,
         return 0;
 
     r->where = pos;
-    r->insert_length = (short) insert_len;
-    r->delete_length = (short) delete_len;
+    r->insert_length = insert_len;
+    r->delete_length = delete_len;
 
     if (insert_len == 0) {
         r->char_storage = -1;
@@ -830,6 +1543,11 @@ nk_textedit_undo(struct nk_text_edit *state)
 {
     struct nk_text_undo_state *s = &state->undo;
     struct nk_text_undo_record u, *r;
+    int n;
+    if (s->journal.pool.alloc) {
+        nk_textedit_journal_undo(state);
+        return;
+    }
     if (s->undo_point == 0)
         return;
 
@@ -857,7 +1575,6 @@ nk_textedit_undo(struct nk_text_edit *state)
             * to store the redo characters */
             r->insert_length = 0;
         } else {
-            int i;
             /* there's definitely room to store the characters eventually */
             while (s->undo_char_point + u.delete_length > s->redo_char_point) {
                 /* there's currently not enough room, so discard a redo record */
@@ -872,22 +1589,25 @@ nk_textedit_undo(struct nk_text_edit *state)
             s->redo_char_point = (short)(s->redo_char_point -  u.delete_length);
 
             /* now save the characters */
-            for (i=0; i < u.delete_length; ++i)
-                s->undo_char[r->char_storage + i] =
-                    nk_str_rune_at(&state->string, u.where + i);
+            nk_textedit_copy_runes(state, u.where, u.delete_length,
+                &s->undo_char[r->char_storage]);
         }
         /* now we can carry out the deletion */
+        n = state->string.len;
         nk_str_delete_runes(&state->string, u.where, u.delete_length);
+        nk_textedit_lines_changed(state, u.where, n - state->string.len, 0);
     }
 
     /* check type of recorded action: */
     if (u.insert_length) {
         /* easy case: was a deletion, so we need to insert n characters */
+        n = state->string.len;
         nk_str_insert_text_runes(&state->string, u.where,
             &s->undo_char[u.char_storage], u.insert_length);
+        nk_textedit_lines_changed(state, u.where, 0, state->string.len - n);
         s->undo_char_point = (short)(s->undo_char_point - u.insert_length);
     }
-    state->cursor = (short)(u.where + u.insert_length);
+    state->cursor = u.where + u.insert_length;
 
     s->undo_point--;
     s->redo_point--;
@@ -897,6 +1617,11 @@ nk_textedit_redo(struct nk_text_edit *state)
 {
     struct nk_text_undo_state *s = &state->undo;
     struct nk_text_undo_record *u, r;
+    int n;
+    if (s->journal.pool.alloc) {
+        nk_textedit_journal_redo(state);
+        return;
+    }
     if (s->redo_point == NK_TEXTEDIT_UNDOSTATECOUNT)
         return;
 
@@ -918,23 +1643,24 @@ nk_textedit_redo(struct nk_text_edit *state)
             u->insert_length = 0;
             u->delete_length = 0;
         } else {
-            int i;
             u->char_storage = s->undo_char_point;
             s->undo_char_point = (short)(s->undo_char_point + u->insert_length);
 
             /* now save the characters */
-            for (i=0; i < u->insert_length; ++i) {
-                s->undo_char[u->char_storage + i] =
-                    nk_str_rune_at(&state->string, u->where + i);
-            }
+            nk_textedit_copy_runes(state, u->where, u->insert_length,
+                &s->undo_char[u->char_storage]);
         }
+        n = state->string.len;
         nk_str_delete_runes(&state->string, r.where, r.delete_length);
+        nk_textedit_lines_changed(state, r.where, n - state->string.len, 0);
     }
 
     if (r.insert_length) {
         /* easy case: need to insert n characters */
+        n = state->string.len;
         nk_str_insert_text_runes(&state->string, r.where,
             &s->undo_char[r.char_storage], r.insert_length);
+        nk_textedit_lines_changed(state, r.where, 0, state->string.len - n);
     }
     state->cursor = r.where + r.insert_length;
 
@@ -944,28 +1670,32 @@ nk_textedit_redo(struct nk_text_edit *state)
 NK_INTERN void
 nk_textedit_makeundo_insert(struct nk_text_edit *state, int where, int length)
 {
-    nk_textedit_createundo(&state->undo, where, 0, length);
+    if (state->undo.journal.pool.alloc)
+        nk_textedit_journal_record(state, where, 0, length, nk_true);
+    else nk_textedit_createundo(&state->undo, where, 0, length);
 }
 NK_INTERN void
 nk_textedit_makeundo_delete(struct nk_text_edit *state, int where, int length)
 {
-    int i;
-    nk_rune *p = nk_textedit_createundo(&state->undo, where, length, 0);
-    if (p) {
-        for (i=0; i < length; ++i)
-            p[i] = nk_str_rune_at(&state->string, where+i);
+    nk_rune *p;
+    if (state->undo.journal.pool.alloc) {
+        nk_textedit_journal_record(state, where, length, 0, nk_true);
+        return;
     }
+    p = nk_textedit_createundo(&state->undo, where, length, 0);
+    if (p) nk_textedit_copy_runes(state, where, length, p);
 }
 NK_INTERN void
 nk_textedit_makeundo_replace(struct nk_text_edit *state, int where,
     int old_length, int new_length)
 {
-    int i;
-    nk_rune *p = nk_textedit_createundo(&state->undo, where, old_length, new_length);
-    if (p) {
-        for (i=0; i < old_length; ++i)
-            p[i] = nk_str_rune_at(&state->string, where+i);
+    nk_rune *p;
+    if (state->undo.journal.pool.alloc) {
+        nk_textedit_journal_record(state, where, old_length, new_length, nk_true);
+        return;
     }
+    p = nk_textedit_createundo(&state->undo, where, old_length, new_length);
+    if (p) nk_textedit_copy_runes(state, where, old_length, p);
 }
 NK_LIB void
 nk_textedit_clear_state(struct nk_text_edit *state, enum nk_text_edit_type type,
@@ -976,6 +1706,7 @@ nk_textedit_clear_state(struct nk_text_edit *state, enum nk_text_edit_type type,
    state->undo.undo_char_point = 0;
    state->undo.redo_point = NK_TEXTEDIT_UNDOSTATECOUNT;
    state->undo.redo_char_point = NK_TEXTEDIT_UNDOCHARCOUNT;
+   nk_textedit_journal_reset(&state->undo.journal);
    state->select_end = state->select_start = 0;
    state->cursor = 0;
    state->has_preferred_x = 0;
@@ -1006,6 +1737,7 @@ nk_textedit_init(struct nk_text_edit *state, const struct nk_allocator *alloc, n
     NK_MEMSET(state, 0, sizeof(struct nk_text_edit));
     nk_textedit_clear_state(state, NK_TEXT_EDIT_SINGLE_LINE, 0);
     nk_str_init(&state->string, alloc, size);
+    nk_buffer_init(&state->lines.buffer, alloc, 16 * sizeof(struct nk_text_edit_line));
 }
 #ifdef NK_INCLUDE_DEFAULT_ALLOCATOR
 NK_API void
@@ -1016,6 +1748,7 @@ nk_textedit_init_default(struct nk_text_edit *state)
     NK_MEMSET(state, 0, sizeof(struct nk_text_edit));
     nk_textedit_clear_state(state, NK_TEXT_EDIT_SINGLE_LINE, 0);
     nk_str_init_default(&state->string);
+    nk_buffer_init_default(&state->lines.buffer);
 }
 #endif
 NK_API void
@@ -1031,5 +1764,43 @@ nk_textedit_free(struct nk_text_edit *state)
     NK_ASSERT(state);
     if (!state) return;
     nk_str_free(&state->string);
+    nk_buffer_free(&state->lines.buffer);
+    nk_zero_struct(state->lines);
+    nk_textedit_journal_free(&state->undo.journal);
 }
 
+NK_API void
+nk_textedit_set_gap_buffer(struct nk_text_edit *state, nk_bool enable)
+{
+    NK_ASSERT(state);
+    if (!state) return;
+    if (!enable)
+        nk_str_close_gap(&state->string);
+    state->string.use_gap = enable;
+}
+NK_API void
+nk_textedit_set_undo_journal(struct nk_text_edit *state, nk_bool enable)
+{
+    struct nk_text_undo_journal *j;
+    NK_ASSERT(state);
+    if (!state) return;
+    j = &state->undo.journal;
+    if (!enable) {
+        nk_textedit_journal_free(j);
+        return;
+    }
+    if (j->pool.alloc) return;
+
+    /* the journal allocates from the same place as the text */
+    NK_ASSERT(state->string.buffer.type == NK_BUFFER_DYNAMIC);
+    if (state->string.buffer.type != NK_BUFFER_DYNAMIC ||
+        !state->string.buffer.pool.alloc) return;
+    j->pool = state->string.buffer.pool;
+    nk_textedit_journal_reset(j);
+
+    /* history kept in the fixed arrays does not carry over */
+    state->undo.undo_point = 0;
+    state->undo.undo_char_point = 0;
+    state->undo.redo_point = NK_TEXTEDIT_UNDOSTATECOUNT;
+    state->undo.redo_char_point = NK_TEXTEDIT_UNDOCHARCOUNT;
+}
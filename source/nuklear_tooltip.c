@@ -103,8 +103,13 @@ NK_API void
 nk_tooltipfv(struct nk_context *ctx, const char *fmt, va_list args)
 {
     char buf[256];
+    nk_bool text_ref;
     nk_strfmt(buf, NK_LEN(buf), fmt, args);
+    /* the tooltip inherits the setting of the window, but `buf` is gone
+     * before the frame is drawn */
+    text_ref = nk_set_text_ref(ctx, nk_false);
     nk_tooltip(ctx, buf);
+    nk_set_text_ref(ctx, text_ref);
 }
 #endif
 
@@ -1,6 +1,20 @@
 #include "nuklear.h"
 #include "nuklear_internal.h"
 
+#ifndef NK_UTF_NO_SIMD
+  #if defined(__AVX2__)
+    #include <immintrin.h>
+    #define NK_UTF_AVX2
+    #define NK_UTF_SSE2
+  #elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define NK_UTF_SSE2
+  #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define NK_UTF_NEON
+  #endif
+#endif
+
 /* ===============================================================
  *
  *                              UTF-8
@@ -44,6 +58,11 @@ nk_utf_decode(const char *c, nk_rune *u, int clen)
 
     if (!c || !u) return 0;
     if (!clen) return 0;
+    if (!((nk_byte)c[0] & 0x80)) {
+        /* ASCII fast path */
+        *u = (nk_byte)c[0];
+        return 1;
+    }
     *u = NK_UTF_INVALID;
 
     udecoded = nk_utf_decode_byte(c[0], &len);
@@ -81,12 +100,75 @@ nk_utf_encode(nk_rune u, char *c, int clen)
     c[0] = nk_utf_encode_byte(u, len);
     return len;
 }
+NK_LIB int
+nk_utf_ascii_len(const char *str, int len)
+{
+    /* returns the number of leading ASCII bytes. The vector loops only
+     * find the block containing the first non ASCII byte, the scalar
+     * loop below then locates it exactly. */
+    int i = 0;
+    NK_ASSERT(str);
+    if (!str || len <= 0) return 0;
+#if defined(NK_UTF_AVX2)
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(const void*)(str + i));
+        if (_mm256_movemask_epi8(v)) break;
+    }
+#endif
+#if defined(NK_UTF_SSE2)
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(const void*)(str + i));
+        if (_mm_movemask_epi8(v)) break;
+    }
+#elif defined(NK_UTF_NEON)
+    for (; i + 16 <= len; i += 16) {
+        uint8x16_t v = vld1q_u8((const uint8_t*)(const void*)(str + i));
+        uint8x8_t o = vorr_u8(vget_low_u8(v), vget_high_u8(v));
+        if (vget_lane_u64(vreinterpret_u64_u8(o), 0) & 0x8080808080808080ull) break;
+    }
+#endif
+    while (i < len && !((nk_byte)str[i] & 0x80)) ++i;
+    return i;
+}
+NK_LIB int
+nk_utf_decode_run(const char *str, int len, nk_rune *runes, int max_runes,
+    int *count)
+{
+    /* decodes up to `max_runes` glyphs into `runes` (may be NULL to only
+     * count or skip glyphs) and returns the number of bytes consumed */
+    int n = 0;
+    int i = 0;
+    NK_ASSERT(str);
+    if (!str || len <= 0 || max_runes <= 0) {
+        if (count) *count = 0;
+        return 0;
+    }
+    while (i < len && n < max_runes) {
+        nk_rune unicode;
+        int glyph_len;
+        int ascii = nk_utf_ascii_len(str + i, NK_MIN(len - i, max_runes - n));
+        if (runes) {
+            int k;
+            for (k = 0; k < ascii; ++k)
+                runes[n + k] = (nk_byte)str[i + k];
+        }
+        i += ascii;
+        n += ascii;
+        if (i >= len || n >= max_runes) break;
+
+        glyph_len = nk_utf_decode(str + i, &unicode, len - i);
+        if (!glyph_len) break;
+        if (runes) runes[n] = unicode;
+        i += glyph_len;
+        n++;
+    }
+    if (count) *count = n;
+    return i;
+}
 NK_API int
 nk_utf_len(const char *str, int len)
 {
-    const char *text;
     int glyphs = 0;
-    int text_len;
     int glyph_len;
     int src_len = 0;
     nk_rune unicode;
@@ -94,13 +176,16 @@ nk_utf_len(const char *str, int len)
     NK_ASSERT(str);
     if (!str || !len) return 0;
 
-    text = str;
-    text_len = len;
-    glyph_len = nk_utf_decode(text, &unicode, text_len);
-    while (glyph_len && src_len < len) {
+    while (src_len < len) {
+        int ascii = nk_utf_ascii_len(str + src_len, len - src_len);
+        glyphs += ascii;
+        src_len += ascii;
+        if (src_len >= len) break;
+
+        glyph_len = nk_utf_decode(str + src_len, &unicode, len - src_len);
+        if (!glyph_len) break;
         glyphs++;
         src_len = src_len + glyph_len;
-        glyph_len = nk_utf_decode(text + src_len, &unicode, text_len - src_len);
     }
     return glyphs;
 }
@@ -111,8 +196,6 @@ nk_utf_at(const char *buffer, int length, int index,
     int i = 0;
     int src_len = 0;
     int glyph_len = 0;
-    const char *text;
-    int text_len;
 
     NK_ASSERT(buffer);
     NK_ASSERT(unicode);
@@ -125,20 +208,28 @@ nk_utf_at(const char *buffer, int length, int index,
         return 0;
     }
 
-    text = buffer;
-    text_len = length;
-    glyph_len = nk_utf_decode(text, unicode, text_len);
-    while (glyph_len) {
+    for (;;) {
+        /* skip ASCII runs without decoding, stopping at the requested glyph */
+        int ascii = nk_utf_ascii_len(buffer + src_len,
+            NK_MIN(length - src_len, index - i + 1));
+        if (i + ascii > index) {
+            src_len += index - i;
+            *unicode = (nk_byte)buffer[src_len];
+            *len = 1;
+            return buffer + src_len;
+        }
+        i += ascii;
+        src_len += ascii;
+        if (ascii) *unicode = (nk_byte)buffer[src_len-1];
+
+        glyph_len = nk_utf_decode(buffer + src_len, unicode, length - src_len);
+        if (!glyph_len) /* one past the last glyph is still a valid position */
+            return (i == index) ? buffer + src_len: 0;
         if (i == index) {
             *len = glyph_len;
-            break;
+            return buffer + src_len;
         }
-
         i++;
         src_len = src_len + glyph_len;
-        glyph_len = nk_utf_decode(text + src_len, unicode, text_len - src_len);
     }
-    if (i != index) return 0;
-    return buffer + src_len;
 }
-
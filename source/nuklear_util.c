@@ -1,6 +1,20 @@
 #include "nuklear.h"
 #include "nuklear_internal.h"
 
+#ifndef NK_NO_SIMD
+  #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define NK_SIMD_SSE2
+    #include <emmintrin.h>
+    #if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+      #define NK_SIMD_AVX2
+      #include <immintrin.h>
+    #endif
+  #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define NK_SIMD_NEON
+    #include <arm_neon.h>
+  #endif
+#endif
+
 /* ===============================================================
  *
  *                              UTIL
@@ -13,8 +27,8 @@ NK_LIB nk_bool nk_is_upper(int c){return (c >= 'A' && c <= 'Z') || (c >= 0xC0 &&
 NK_LIB int nk_to_upper(int c) {return (c >= 'a' && c <= 'z') ? (c - ('a' - 'A')) : c;}
 NK_LIB int nk_to_lower(int c) {return (c >= 'A' && c <= 'Z') ? (c - ('a' + 'A')) : c;}
 
-NK_LIB void*
-nk_memcopy(void *dst0, const void *src0, nk_size length)
+NK_INTERN void*
+nk_memcopy_words(void *dst0, const void *src0, nk_size length)
 {
     nk_ptr t;
     char *dst = (char*)dst0;
@@ -70,8 +84,8 @@ done:
     return (dst0);
 }
 
-NK_LIB void
-nk_memset(void *ptr, int c0, nk_size size)
+NK_INTERN void
+nk_memset_words(void *ptr, int c0, nk_size size)
 {
     #define nk_word unsigned
     #define nk_wsize sizeof(nk_word)
@@ -122,6 +136,172 @@ nk_memset(void *ptr, int c0, nk_size size)
     #undef nk_wmask
 }
 
+#if defined(NK_SIMD_SSE2) || defined(NK_SIMD_NEON)
+/* Vector copies move 16 (or 32 with AVX2) bytes per load/store with
+ * unaligned accesses. Both run for at least one vector: the first (or last)
+ * vector is loaded before the loop stores anything and written last, which
+ * covers the ragged end and keeps overlapping moves correct in both
+ * directions. Smaller sizes stay with the word loops above. */
+#define NK_SIMD_MIN_SIZE 16
+
+#ifdef NK_SIMD_SSE2
+typedef __m128i nk_vec;
+#define nk_vec_load(p) _mm_loadu_si128((const __m128i*)(const void*)(p))
+#define nk_vec_store(p, v) _mm_storeu_si128((__m128i*)(void*)(p), v)
+#define nk_vec_splat(c) _mm_set1_epi8((char)(c))
+#else
+typedef uint8x16_t nk_vec;
+#define nk_vec_load(p) vld1q_u8((const nk_byte*)(p))
+#define nk_vec_store(p, v) vst1q_u8((nk_byte*)(p), v)
+#define nk_vec_splat(c) vdupq_n_u8((nk_byte)(c))
+#endif
+
+#define NK_SIMD_MEMCOPY(name, attr, vec, load, store, size)\
+NK_INTERN attr void* \
+name(void *dst0, const void *src0, nk_size n)\
+{\
+    nk_byte *dst = (nk_byte*)dst0;\
+    const nk_byte *src = (const nk_byte*)src0;\
+    if (dst <= src || dst >= src + n) {\
+        nk_byte *last = dst + n - size;\
+        vec tail = load(src + n - size);\
+        for (; (nk_size)(last - dst) >= 4*size; dst += 4*size, src += 4*size) {\
+            vec a = load(src), b = load(src + size);\
+            vec c = load(src + 2*size), d = load(src + 3*size);\
+            store(dst, a); store(dst + size, b);\
+            store(dst + 2*size, c); store(dst + 3*size, d);\
+        }\
+        for (; dst < last; dst += size, src += size)\
+            store(dst, load(src));\
+        store(last, tail);\
+    } else {\
+        nk_byte *end = dst + n;\
+        const nk_byte *send = src + n;\
+        vec head = load(src);\
+        for (; (nk_size)(end - dst) >= 4*size; end -= 4*size, send -= 4*size) {\
+            vec a = load(send - size), b = load(send - 2*size);\
+            vec c = load(send - 3*size), d = load(send - 4*size);\
+            store(end - size, a); store(end - 2*size, b);\
+            store(end - 3*size, c); store(end - 4*size, d);\
+        }\
+        for (; (nk_size)(end - dst) > size; end -= size, send -= size)\
+            store(end - size, load(send - size));\
+        store(dst, head);\
+    }\
+    return dst0;\
+}
+
+#define NK_SIMD_MEMSET(name, attr, vec, splat, store, size)\
+NK_INTERN attr void \
+name(void *ptr, int c0, nk_size n)\
+{\
+    nk_byte *dst = (nk_byte*)ptr;\
+    nk_byte *last = dst + n - size;\
+    vec c = splat(c0);\
+    store(dst, c);\
+    dst = (nk_byte*)NK_ALIGN_PTR(dst + 1, size);\
+    for (; dst < last && (nk_size)(last - dst) >= 4*size; dst += 4*size) {\
+        store(dst, c); store(dst + size, c);\
+        store(dst + 2*size, c); store(dst + 3*size, c);\
+    }\
+    for (; dst < last; dst += size)\
+        store(dst, c);\
+    store(last, c);\
+}
+
+NK_SIMD_MEMCOPY(nk_memcopy_vec, , nk_vec, nk_vec_load, nk_vec_store, 16)
+NK_SIMD_MEMSET(nk_memset_vec, , nk_vec, nk_vec_splat, nk_vec_store, 16)
+
+#ifdef NK_SIMD_AVX2
+#define nk_avx2_load(p) _mm256_loadu_si256((const __m256i*)(const void*)(p))
+#define nk_avx2_store(p, v) _mm256_storeu_si256((__m256i*)(void*)(p), v)
+#define nk_avx2_splat(c) _mm256_set1_epi8((char)(c))
+NK_SIMD_MEMCOPY(nk_memcopy_avx2_32, __attribute__((target("avx2"))), __m256i, nk_avx2_load, nk_avx2_store, 32)
+NK_SIMD_MEMSET(nk_memset_avx2_32, __attribute__((target("avx2"))), __m256i, nk_avx2_splat, nk_avx2_store, 32)
+NK_INTERN void*
+nk_memcopy_avx2(void *dst, const void *src, nk_size n)
+{
+    if (n < 32) return nk_memcopy_vec(dst, src, n);
+    return nk_memcopy_avx2_32(dst, src, n);
+}
+NK_INTERN void
+nk_memset_avx2(void *ptr, int c0, nk_size n)
+{
+    if (n < 32) nk_memset_vec(ptr, c0, n);
+    else nk_memset_avx2_32(ptr, c0, n);
+}
+#endif
+
+#ifdef NK_SIMD_AVX2
+/* The widest implementation the CPU supports is picked by `nk_simd_init`,
+ * which context setup calls. A copy made before any context exists picks
+ * it itself. Worker contexts copy memory on other threads, so the pointers
+ * are only read and written atomically. */
+NK_INTERN void *nk_memcopy_select(void *dst, const void *src, nk_size n);
+NK_INTERN void nk_memset_select(void *ptr, int c0, nk_size n);
+NK_GLOBAL void *(*nk_memcopy_impl)(void*, const void*, nk_size) = nk_memcopy_select;
+NK_GLOBAL void (*nk_memset_impl)(void*, int, nk_size) = nk_memset_select;
+#define NK_SIMD_IMPL(impl) __atomic_load_n(&(impl), __ATOMIC_RELAXED)
+
+NK_LIB void
+nk_simd_init(void)
+{
+    void *(*copy)(void*, const void*, nk_size) = nk_memcopy_vec;
+    void (*set)(void*, int, nk_size) = nk_memset_vec;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        copy = nk_memcopy_avx2;
+        set = nk_memset_avx2;
+    }
+    __atomic_store_n(&nk_memcopy_impl, copy, __ATOMIC_RELAXED);
+    __atomic_store_n(&nk_memset_impl, set, __ATOMIC_RELAXED);
+}
+NK_INTERN void*
+nk_memcopy_select(void *dst, const void *src, nk_size n)
+{
+    nk_simd_init();
+    return NK_SIMD_IMPL(nk_memcopy_impl)(dst, src, n);
+}
+NK_INTERN void
+nk_memset_select(void *ptr, int c0, nk_size n)
+{
+    nk_simd_init();
+    NK_SIMD_IMPL(nk_memset_impl)(ptr, c0, n);
+}
+#else
+/* the vector width is fixed at compile time */
+NK_LIB void nk_simd_init(void) {}
+#define NK_SIMD_IMPL(impl) impl
+#define nk_memcopy_impl nk_memcopy_vec
+#define nk_memset_impl nk_memset_vec
+#endif
+NK_LIB void*
+nk_memcopy(void *dst, const void *src, nk_size n)
+{
+    if (n < NK_SIMD_MIN_SIZE || dst == src)
+        return nk_memcopy_words(dst, src, n);
+    return NK_SIMD_IMPL(nk_memcopy_impl)(dst, src, n);
+}
+NK_LIB void
+nk_memset(void *ptr, int c0, nk_size size)
+{
+    if (size < NK_SIMD_MIN_SIZE)
+        nk_memset_words(ptr, c0, size);
+    else NK_SIMD_IMPL(nk_memset_impl)(ptr, c0, size);
+}
+#else
+NK_LIB void nk_simd_init(void) {}
+NK_LIB void*
+nk_memcopy(void *dst, const void *src, nk_size n)
+{
+    return nk_memcopy_words(dst, src, n);
+}
+NK_LIB void
+nk_memset(void *ptr, int c0, nk_size size)
+{
+    nk_memset_words(ptr, c0, size);
+}
+#endif
 NK_LIB void
 nk_zero(void *ptr, nk_size size)
 {
@@ -1012,6 +1192,48 @@ nk_file_load(const char* path, nk_size* siz, const struct nk_allocator *alloc)
     return buf;
 }
 #endif
+NK_LIB void
+nk_text_advancer_init(struct nk_text_advancer *a, const struct nk_user_font *font,
+    const char *text, int len)
+{
+    NK_ASSERT(a);
+    NK_ASSERT(font);
+    a->font = font;
+    a->text = text;
+    a->len = len;
+    a->pos = 0;
+    a->count = 0;
+    a->index = 0;
+}
+NK_LIB float
+nk_text_advancer_next(struct nk_text_advancer *a, int offset, int glyph_len)
+{
+    const struct nk_user_font *font = a->font;
+    if (!glyph_len) return 0;
+    if (!font->advances)
+        return font->width(font->userdata, font->height, a->text + offset, glyph_len);
+
+    /* skip glyphs the caller did not ask for (e.g. line breaks) */
+    while (a->pos < offset && a->index < a->count) {
+        nk_rune unicode;
+        int l = nk_utf_decode(a->text + a->pos, &unicode, a->len - a->pos);
+        if (!l) break;
+        a->pos += l;
+        a->index++;
+    }
+    if (offset != a->pos || a->index >= a->count) {
+        /* query advances for the next run of glyphs in one call */
+        int n = 0;
+        int run = nk_utf_decode_run(a->text + offset, a->len - offset, 0,
+                                    NK_TEXT_ADVANCE_BATCH, &n);
+        if (!n) return 0;
+        font->advances(font->userdata, font->height, a->text + offset, run, a->advances);
+        a->count = n;
+        a->index = 0;
+    }
+    a->pos = offset + glyph_len;
+    return a->advances[a->index++];
+}
 NK_LIB int
 nk_text_clamp(const struct nk_user_font *font, const char *text,
     int text_len, float space, int *glyphs, float *text_width,
@@ -1029,12 +1251,18 @@ nk_text_clamp(const struct nk_user_font *font, const char *text,
     int sep_len = 0;
     int sep_g = 0;
     float sep_width = 0;
+    struct nk_text_advancer adv;
     sep_count = NK_MAX(sep_count,0);
 
+    nk_text_advancer_init(&adv, font, text, text_len);
     glyph_len = nk_utf_decode(text, &unicode, text_len);
     while (glyph_len && (width < space) && (len < text_len)) {
+        /* with batched advances every prefix width is a running sum,
+         * otherwise the whole prefix has to be measured again */
+        if (font->advances)
+            s = width + nk_text_advancer_next(&adv, len, glyph_len);
+        else s = font->width(font->userdata, font->height, text, len + glyph_len);
         len += glyph_len;
-        s = font->width(font->userdata, font->height, text, len);
         for (i = 0; i < sep_count; ++i) {
             if (unicode != sep_list[i]) continue;
             sep_width = last_width = width;
@@ -1069,16 +1297,16 @@ nk_text_calculate_text_bounds(const struct nk_user_font *font,
     struct nk_vec2 text_size = nk_vec2(0,0);
     float line_width = 0.0f;
 
-    float glyph_width;
     int glyph_len = 0;
     nk_rune unicode = 0;
     int text_len = 0;
+    struct nk_text_advancer adv;
     if (!begin || byte_len <= 0 || !font)
         return nk_vec2(0,row_height);
 
+    nk_text_advancer_init(&adv, font, begin, byte_len);
     glyph_len = nk_utf_decode(begin, &unicode, byte_len);
     if (!glyph_len) return text_size;
-    glyph_width = font->width(font->userdata, font->height, begin, glyph_len);
 
     *glyphs = 0;
     while ((text_len < byte_len) && glyph_len) {
@@ -1103,10 +1331,9 @@ nk_text_calculate_text_bounds(const struct nk_user_font *font,
         }
 
         *glyphs = *glyphs + 1;
+        line_width += nk_text_advancer_next(&adv, text_len, glyph_len);
         text_len += glyph_len;
-        line_width += (float)glyph_width;
         glyph_len = nk_utf_decode(begin + text_len, &unicode, byte_len-text_len);
-        glyph_width = font->width(font->userdata, font->height, begin+text_len, glyph_len);
         continue;
     }
 
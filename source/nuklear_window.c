@@ -19,22 +19,25 @@ NK_LIB void
 nk_free_window(struct nk_context *ctx, struct nk_window *win)
 {
     /* unlink windows from list */
-    struct nk_table *it = win->tables;
     if (win->popup.win) {
         nk_free_window(ctx, win->popup.win);
         win->popup.win = 0;
     }
+    nk_free_table_index(ctx, win);
+    nk_free_edit_lines(ctx, win);
     win->next = 0;
     win->prev = 0;
 
-    while (it) {
-        /*free window state tables */
-        struct nk_table *n = it->next;
+    /* free window state tables, the stale ones are a list of their own */
+    while (win->tables) {
+        struct nk_table *it = win->tables;
+        nk_remove_table(win, it);
+        nk_free_table(ctx, it);
+    }
+    while (win->stale_tables) {
+        struct nk_table *it = win->stale_tables;
         nk_remove_table(win, it);
         nk_free_table(ctx, it);
-        if (it == win->tables)
-            win->tables = n;
-        it = n;
     }
 
     /* link windows into freelist */
@@ -42,10 +45,74 @@ nk_free_window(struct nk_context *ctx, struct nk_window *win)
     struct nk_page_element *pe = NK_CONTAINER_OF(pd, struct nk_page_element, data);
     nk_free_page_element(ctx, pe);}
 }
+#define NK_WINDOW_INDEX_SLOT(hash) ((int)((hash) & (NK_WINDOW_INDEX_SIZE - 1)))
+NK_INTERN void
+nk_window_index_add(struct nk_window_index *index, struct nk_window *win)
+{
+    int i;
+    NK_ASSERT(index);
+    NK_ASSERT(win);
+
+    /* keep a quarter of the slots empty so probe sequences stay short */
+    if (index->count >= NK_WINDOW_INDEX_SIZE - NK_WINDOW_INDEX_SIZE/4) {
+        index->unindexed++;
+        return;
+    }
+    i = NK_WINDOW_INDEX_SLOT(win->name);
+    while (index->slots[i])
+        i = (i + 1) & (NK_WINDOW_INDEX_SIZE - 1);
+    index->slots[i] = win;
+    index->count++;
+}
+NK_INTERN void
+nk_window_index_remove(struct nk_window_index *index, const struct nk_window *win)
+{
+    int i, j;
+    NK_ASSERT(index);
+    NK_ASSERT(win);
+
+    i = NK_WINDOW_INDEX_SLOT(win->name);
+    while (index->slots[i] && index->slots[i] != win)
+        i = (i + 1) & (NK_WINDOW_INDEX_SIZE - 1);
+    if (!index->slots[i]) {
+        NK_ASSERT(index->unindexed > 0);
+        index->unindexed--;
+        return;
+    }
+    /* shift following entries back into the hole instead of leaving a
+     * tombstone, so removing and re-inserting windows to change their
+     * z-order never degrades lookups */
+    j = i;
+    for (;;) {
+        int home;
+        j = (j + 1) & (NK_WINDOW_INDEX_SIZE - 1);
+        if (!index->slots[j]) break;
+        home = NK_WINDOW_INDEX_SLOT(index->slots[j]->name);
+        if ((i <= j) ? (i < home && home <= j): (i < home || home <= j))
+            continue;
+        index->slots[i] = index->slots[j];
+        i = j;
+    }
+    index->slots[i] = 0;
+    index->count--;
+}
 NK_LIB struct nk_window*
 nk_find_window(const struct nk_context *ctx, nk_hash hash, const char *name)
 {
     struct nk_window *iter;
+    int i = NK_WINDOW_INDEX_SLOT(hash);
+    while ((iter = ctx->windows.slots[i]) != 0) {
+        if (iter->name == hash) {
+            int max_len = nk_strlen(iter->name_string);
+            if (!nk_stricmpn(iter->name_string, name, max_len))
+                return iter;
+        }
+        i = (i + 1) & (NK_WINDOW_INDEX_SIZE - 1);
+    }
+    if (!ctx->windows.unindexed)
+        return 0;
+
+    /* index overflowed: windows added after that are only in the list */
     iter = ctx->begin;
     while (iter) {
         NK_ASSERT(iter != iter->next);
@@ -62,18 +129,15 @@ NK_LIB void
 nk_insert_window(struct nk_context *ctx, struct nk_window *win,
     enum nk_window_insert_location loc)
 {
-    const struct nk_window *iter;
     NK_ASSERT(ctx);
     NK_ASSERT(win);
     if (!win || !ctx) return;
 
-    iter = ctx->begin;
-    while (iter) {
-        NK_ASSERT(iter != iter->next);
-        NK_ASSERT(iter != win);
-        if (iter == win) return;
-        iter = iter->next;
-    }
+    /* windows outside of the list are always unlinked */
+    NK_ASSERT(win != ctx->begin && !win->next && !win->prev);
+    if (win == ctx->begin || win->next || win->prev) return;
+    nk_window_index_add(&ctx->windows, win);
+    nk_window_grid_invalidate(ctx);
 
     if (!ctx->begin) {
         win->next = 0;
@@ -106,6 +170,8 @@ nk_insert_window(struct nk_context *ctx, struct nk_window *win,
 NK_LIB void
 nk_remove_window(struct nk_context *ctx, struct nk_window *win)
 {
+    nk_window_index_remove(&ctx->windows, win);
+    nk_window_grid_invalidate(ctx);
     if (win == ctx->begin || win == ctx->end) {
         if (win == ctx->begin) {
             ctx->begin = win->next;
@@ -168,6 +234,11 @@ nk_begin_titled(struct nk_context *ctx, const char *name, const char *title,
         NK_ASSERT(win);
         if (!win) return 0;
 
+        /* name first: the window index is keyed by it */
+        win->name = name_hash;
+        name_length = NK_MIN(name_length, NK_WINDOW_MAX_NAME-1);
+        NK_MEMCPY(win->name_string, name, name_length);
+        win->name_string[name_length] = 0;
         if (flags & NK_WINDOW_BACKGROUND)
             nk_insert_window(ctx, win, NK_INSERT_FRONT);
         else nk_insert_window(ctx, win, NK_INSERT_BACK);
@@ -175,10 +246,6 @@ nk_begin_titled(struct nk_context *ctx, const char *name, const char *title,
 
         win->flags = flags;
         win->bounds = bounds;
-        win->name = name_hash;
-        name_length = NK_MIN(name_length, NK_WINDOW_MAX_NAME-1);
-        NK_MEMCPY(win->name_string, name, name_length);
-        win->name_string[name_length] = 0;
         win->popup.win = 0;
         win->widgets_disabled = nk_false;
         if (!ctx->active)
@@ -187,8 +254,12 @@ nk_begin_titled(struct nk_context *ctx, const char *name, const char *title,
         /* update window */
         win->flags &= ~(nk_flags)(NK_WINDOW_PRIVATE-1);
         win->flags |= flags;
-        if (!(win->flags & (NK_WINDOW_MOVABLE | NK_WINDOW_SCALABLE)))
+        if (!(win->flags & (NK_WINDOW_MOVABLE | NK_WINDOW_SCALABLE)) &&
+            (win->bounds.x != bounds.x || win->bounds.y != bounds.y ||
+            win->bounds.w != bounds.w || win->bounds.h != bounds.h)) {
             win->bounds = bounds;
+            nk_window_grid_invalidate(ctx);
+        }
         /* If this assert triggers you either:
          *
          * I.) Have more than one window with the same name or
@@ -198,10 +269,8 @@ nk_begin_titled(struct nk_context *ctx, const char *name, const char *title,
          *      provided demo backends). */
         NK_ASSERT(win->seq != ctx->seq);
         win->seq = ctx->seq;
-        if (!ctx->active && !(win->flags & NK_WINDOW_HIDDEN)) {
+        if (!ctx->active && !(win->flags & NK_WINDOW_HIDDEN))
             ctx->active = win;
-            ctx->end = win;
-        }
     }
     if (win->flags & NK_WINDOW_HIDDEN) {
         ctx->current = win;
@@ -214,6 +283,7 @@ nk_begin_titled(struct nk_context *ctx, const char *name, const char *title,
     {
         int inpanel, ishovered;
         struct nk_window *iter = win;
+        struct nk_window *popup;
         float h = ctx->style.font->height + 2.0f * style->window.header.padding.y +
             (2.0f * style->window.header.label_padding.y);
         struct nk_rect win_bounds = (!(win->flags & NK_WINDOW_MINIMIZED))?
@@ -224,42 +294,19 @@ nk_begin_titled(struct nk_context *ctx, const char *name, const char *title,
         inpanel = inpanel && ctx->input.mouse.buttons[NK_BUTTON_LEFT].clicked;
         ishovered = nk_input_is_mouse_hovering_rect(&ctx->input, win_bounds);
         if ((win != ctx->active) && ishovered && !ctx->input.mouse.buttons[NK_BUTTON_LEFT].down) {
-            iter = win->next;
-            while (iter) {
-                struct nk_rect iter_bounds = (!(iter->flags & NK_WINDOW_MINIMIZED))?
-                    iter->bounds: nk_rect(iter->bounds.x, iter->bounds.y, iter->bounds.w, h);
-                if (NK_INTERSECT(win_bounds.x, win_bounds.y, win_bounds.w, win_bounds.h,
-                    iter_bounds.x, iter_bounds.y, iter_bounds.w, iter_bounds.h) &&
-                    (!(iter->flags & NK_WINDOW_HIDDEN)))
-                    break;
-
-                if (iter->popup.win && iter->popup.active && !(iter->flags & NK_WINDOW_HIDDEN) &&
-                    NK_INTERSECT(win->bounds.x, win_bounds.y, win_bounds.w, win_bounds.h,
-                    iter->popup.win->bounds.x, iter->popup.win->bounds.y,
-                    iter->popup.win->bounds.w, iter->popup.win->bounds.h))
-                    break;
-                iter = iter->next;
-            }
+            /* lowest window above this one overlapping it or its open popup */
+            iter = nk_window_grid_find(ctx, win, win_bounds, nk_false, h);
+            popup = nk_window_grid_find_popup(ctx, win, iter, win_bounds, nk_false);
+            if (popup) iter = popup;
         }
 
         /* activate window if clicked */
         if (iter && inpanel && (win != ctx->end)) {
-            iter = win->next;
-            while (iter) {
-                /* try to find a panel with higher priority in the same position */
-                struct nk_rect iter_bounds = (!(iter->flags & NK_WINDOW_MINIMIZED))?
-                iter->bounds: nk_rect(iter->bounds.x, iter->bounds.y, iter->bounds.w, h);
-                if (NK_INBOX(ctx->input.mouse.pos.x, ctx->input.mouse.pos.y,
-                    iter_bounds.x, iter_bounds.y, iter_bounds.w, iter_bounds.h) &&
-                    !(iter->flags & NK_WINDOW_HIDDEN))
-                    break;
-                if (iter->popup.win && iter->popup.active && !(iter->flags & NK_WINDOW_HIDDEN) &&
-                    NK_INTERSECT(win_bounds.x, win_bounds.y, win_bounds.w, win_bounds.h,
-                    iter->popup.win->bounds.x, iter->popup.win->bounds.y,
-                    iter->popup.win->bounds.w, iter->popup.win->bounds.h))
-                    break;
-                iter = iter->next;
-            }
+            /* try to find a panel with higher priority in the same position */
+            struct nk_rect pos = nk_rect(ctx->input.mouse.pos.x, ctx->input.mouse.pos.y, 0, 0);
+            iter = nk_window_grid_find(ctx, win, pos, nk_true, h);
+            popup = nk_window_grid_find_popup(ctx, win, iter, win_bounds, nk_false);
+            if (popup) iter = popup;
         }
         if (iter && !(win->flags & NK_WINDOW_ROM) && (win->flags & NK_WINDOW_BACKGROUND)) {
             win->flags |= (nk_flags)NK_WINDOW_ROM;
@@ -445,29 +492,15 @@ nk_window_is_hovered(const struct nk_context *ctx)
 NK_API nk_bool
 nk_window_is_any_hovered(const struct nk_context *ctx)
 {
-    struct nk_window *iter;
+    struct nk_rect pos;
+    float h;
     NK_ASSERT(ctx);
     if (!ctx) return 0;
-    iter = ctx->begin;
-    while (iter) {
-        /* check if window is being hovered */
-        if(!(iter->flags & NK_WINDOW_HIDDEN)) {
-            /* check if window popup is being hovered */
-            if (iter->popup.active && iter->popup.win && nk_input_is_mouse_hovering_rect(&ctx->input, iter->popup.win->bounds))
-                return 1;
 
-            if (iter->flags & NK_WINDOW_MINIMIZED) {
-                struct nk_rect header = iter->bounds;
-                header.h = ctx->style.font->height + 2 * ctx->style.window.header.padding.y;
-                if (nk_input_is_mouse_hovering_rect(&ctx->input, header))
-                    return 1;
-            } else if (nk_input_is_mouse_hovering_rect(&ctx->input, iter->bounds)) {
-                return 1;
-            }
-        }
-        iter = iter->next;
-    }
-    return 0;
+    pos = nk_rect(ctx->input.mouse.pos.x, ctx->input.mouse.pos.y, 0, 0);
+    h = 2 * ctx->style.window.header.padding.y;
+    if (ctx->style.font) h += ctx->style.font->height;
+    return nk_window_grid_any(ctx, pos, nk_true, h);
 }
 NK_API nk_bool
 nk_item_is_any_active(const struct nk_context *ctx)
@@ -568,6 +601,7 @@ nk_window_set_bounds(struct nk_context *ctx,
     win = nk_window_find(ctx, name);
     if (!win) return;
     win->bounds = bounds;
+    nk_window_grid_invalidate(ctx);
 }
 NK_API void
 nk_window_set_position(struct nk_context *ctx,
@@ -577,6 +611,7 @@ nk_window_set_position(struct nk_context *ctx,
     if (!win) return;
     win->bounds.x = pos.x;
     win->bounds.y = pos.y;
+    nk_window_grid_invalidate(ctx);
 }
 NK_API void
 nk_window_set_size(struct nk_context *ctx,
@@ -586,6 +621,7 @@ nk_window_set_size(struct nk_context *ctx,
     if (!win) return;
     win->bounds.w = size.x;
     win->bounds.h = size.y;
+    nk_window_grid_invalidate(ctx);
 }
 NK_API void
 nk_window_set_scroll(struct nk_context *ctx, nk_uint offset_x, nk_uint offset_y)
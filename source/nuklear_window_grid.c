@@ -0,0 +1,311 @@
+#include "nuklear.h"
+#include "nuklear_internal.h"
+
+/* ===============================================================
+ *
+ *                          WINDOW GRID
+ *
+ * ===============================================================*/
+/* window bounds beyond are clamped into the border cells */
+#define NK_WINDOW_GRID_LIMIT 1.0e7f
+
+NK_INTERN nk_bool
+nk_window_grid_overlaps(struct nk_rect r, struct nk_rect area, nk_bool point)
+{
+    if (point)
+        return NK_INBOX(area.x, area.y, r.x, r.y, r.w, r.h);
+    return NK_INTERSECT(area.x, area.y, area.w, area.h, r.x, r.y, r.w, r.h);
+}
+NK_INTERN nk_bool
+nk_window_grid_hit(const struct nk_window *win, struct nk_rect area,
+    nk_bool point, float header_height)
+{
+    struct nk_rect bounds = win->bounds;
+    if (win->flags & NK_WINDOW_HIDDEN)
+        return nk_false;
+    if (win->flags & NK_WINDOW_MINIMIZED)
+        bounds.h = header_height;
+    return nk_window_grid_overlaps(bounds, area, point);
+}
+NK_INTERN nk_bool
+nk_window_grid_popup_hit(const struct nk_window *win, struct nk_rect area, nk_bool point)
+{
+    if (!win->popup.win || !win->popup.active || (win->flags & NK_WINDOW_HIDDEN))
+        return nk_false;
+    return nk_window_grid_overlaps(win->popup.win->bounds, area, point);
+}
+NK_INTERN int
+nk_window_grid_cell(float pos, float origin, float cell, int count)
+{
+    /* NaN ends up in the last cell, so clamping never drops a window */
+    float index = (pos - origin) / cell;
+    index = NK_CLAMP(0.0f, index, (float)(count - 1));
+    return (int)index;
+}
+NK_INTERN struct nk_rect
+nk_window_grid_bounds(const struct nk_window *win, float header)
+{
+    /* cover the header as well in case the window is minimized later on */
+    struct nk_rect bounds = win->bounds;
+    bounds.h = NK_MAX(bounds.h, header);
+    return bounds;
+}
+NK_INTERN nk_size
+nk_window_grid_count(const struct nk_context *ctx, const struct nk_window_grid *grid)
+{
+    const struct nk_window *iter;
+    nk_size count = 0;
+    for (iter = ctx->begin; iter; iter = iter->next) {
+        struct nk_rect r = nk_window_grid_bounds(iter, grid->header);
+        int x0, y0, x1, y1;
+        if (!(r.w > 0 && r.h > 0)) continue;
+        x0 = nk_window_grid_cell(r.x, grid->x, grid->cell, grid->cols);
+        y0 = nk_window_grid_cell(r.y, grid->y, grid->cell, grid->rows);
+        x1 = nk_window_grid_cell(r.x + r.w, grid->x, grid->cell, grid->cols);
+        y1 = nk_window_grid_cell(r.y + r.h, grid->y, grid->cell, grid->rows);
+        count += (nk_size)(x1 - x0 + 1) * (nk_size)(y1 - y0 + 1);
+    }
+    return count;
+}
+NK_INTERN void
+nk_window_grid_build(struct nk_context *ctx, float header)
+{
+    struct nk_window_grid *grid = &ctx->grid;
+    struct nk_window *iter;
+    float x0 = NK_WINDOW_GRID_LIMIT, y0 = NK_WINDOW_GRID_LIMIT;
+    float x1 = -NK_WINDOW_GRID_LIMIT, y1 = -NK_WINDOW_GRID_LIMIT;
+    nk_size entry_count = 0, popup_offset, entry_offset, size;
+    int cells, popups = 0, z = 0, i;
+
+    if (grid->seq != ctx->seq) {
+        /* memory of earlier frames went back to the frame arena */
+        grid->seq = ctx->seq;
+        grid->starts = 0;
+        grid->capacity = 0;
+    }
+    grid->valid = nk_true;
+    grid->header = header;
+    grid->cell = 0;
+
+    /* number windows by z order and find the area they cover. NaN never
+     * passes the comparisons and keeps the current extent */
+    for (iter = ctx->begin; iter; iter = iter->next) {
+        struct nk_rect r = nk_window_grid_bounds(iter, header);
+        iter->z = z++;
+        if (iter->popup.win) popups++;
+        if (!(r.w > 0 && r.h > 0)) continue;
+        x0 = NK_MIN(r.x, x0);
+        y0 = NK_MIN(r.y, y0);
+        x1 = NK_MAX(x1, r.x + r.w);
+        y1 = NK_MAX(y1, r.y + r.h);
+    }
+    x0 = NK_MAX(x0, -NK_WINDOW_GRID_LIMIT);
+    y0 = NK_MAX(y0, -NK_WINDOW_GRID_LIMIT);
+    x1 = NK_MAX(x0, NK_MIN(x1, NK_WINDOW_GRID_LIMIT));
+    y1 = NK_MAX(y0, NK_MIN(y1, NK_WINDOW_GRID_LIMIT));
+
+    /* grow the cells until both the cells and the windows listed in
+     * them stay in proportion to the number of windows */
+    grid->x = x0;
+    grid->y = y0;
+    grid->cell = NK_WINDOW_GRID_CELL_SIZE;
+    for (;;) {
+        grid->cols = (int)((x1 - x0) / grid->cell) + 1;
+        grid->rows = (int)((y1 - y0) / grid->cell) + 1;
+        if (grid->cols <= NK_WINDOW_GRID_CELLS && grid->rows <= NK_WINDOW_GRID_CELLS &&
+            grid->cols * grid->rows <= NK_WINDOW_GRID_CELLS) {
+            entry_count = nk_window_grid_count(ctx, grid);
+            if (grid->cols * grid->rows == 1 ||
+                entry_count <= (nk_size)(grid->cols * grid->rows) + 4 * (nk_size)z)
+                break;
+        }
+        grid->cell *= 2;
+    }
+    cells = grid->cols * grid->rows;
+
+    /* cell offsets, windows per cell and windows with a popup in one block
+     * of the frame arena, reused until the next `nk_clear` if it fits */
+    entry_offset = (nk_size)(cells + 1) * sizeof(int);
+    entry_offset = (entry_offset + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    popup_offset = entry_offset + entry_count * sizeof(struct nk_window*);
+    size = popup_offset + (nk_size)popups * sizeof(struct nk_window*);
+    if (size > grid->capacity) {
+        void *memory = nk_frame_alloc(ctx, size);
+        if (!memory) {
+            grid->cell = 0;
+            return;
+        }
+        grid->starts = (int*)memory;
+        grid->capacity = size;
+    }
+    grid->entries = (struct nk_window**)(void*)((nk_byte*)grid->starts + entry_offset);
+    grid->popups = (struct nk_window**)(void*)((nk_byte*)grid->starts + popup_offset);
+    grid->popup_count = 0;
+
+    /* count windows per cell into the following slot, turn the counts into
+     * offsets and fill the cells in z order. Filling moves each offset to
+     * the start of the next cell, so the offsets are shifted back after */
+    NK_MEMSET(grid->starts, 0, (nk_size)(cells + 1) * sizeof(int));
+    for (i = 0; i < 2; ++i) {
+        for (iter = ctx->begin; iter; iter = iter->next) {
+            struct nk_rect r = nk_window_grid_bounds(iter, header);
+            int cx0, cy0, cx1, cy1, x, y;
+            if (!i && iter->popup.win)
+                grid->popups[grid->popup_count++] = iter;
+            if (!(r.w > 0 && r.h > 0)) continue;
+            cx0 = nk_window_grid_cell(r.x, grid->x, grid->cell, grid->cols);
+            cy0 = nk_window_grid_cell(r.y, grid->y, grid->cell, grid->rows);
+            cx1 = nk_window_grid_cell(r.x + r.w, grid->x, grid->cell, grid->cols);
+            cy1 = nk_window_grid_cell(r.y + r.h, grid->y, grid->cell, grid->rows);
+            for (y = cy0; y <= cy1; ++y) {
+                for (x = cx0; x <= cx1; ++x) {
+                    int cell = y * grid->cols + x;
+                    if (!i) grid->starts[cell + 1]++;
+                    else grid->entries[grid->starts[cell]++] = iter;
+                }
+            }
+        }
+        if (!i) {
+            int c;
+            for (c = 0; c < cells; ++c)
+                grid->starts[c + 1] += grid->starts[c];
+        }
+    }
+    for (i = cells; i > 0; --i)
+        grid->starts[i] = grid->starts[i - 1];
+    grid->starts[0] = 0;
+}
+NK_INTERN struct nk_window_grid*
+nk_window_grid_get(struct nk_context *ctx, float header_height)
+{
+    struct nk_window_grid *grid = &ctx->grid;
+    if (!grid->valid || grid->seq != ctx->seq || header_height > grid->header)
+        nk_window_grid_build(ctx, header_height);
+    return grid;
+}
+NK_LIB void
+nk_window_grid_invalidate(struct nk_context *ctx)
+{
+    NK_ASSERT(ctx);
+    if (!ctx) return;
+    ctx->grid.valid = nk_false;
+}
+NK_INTERN nk_bool
+nk_window_grid_current(const struct nk_context *ctx, float header_height)
+{
+    /* true if the grid can be read as it is */
+    const struct nk_window_grid *grid = &ctx->grid;
+    return grid->valid && grid->seq == ctx->seq &&
+        header_height <= grid->header && grid->cell;
+}
+NK_INTERN struct nk_window*
+nk_window_grid_search(const struct nk_window_grid *grid, const struct nk_window *above,
+    struct nk_rect area, nk_bool point, float header_height)
+{
+    struct nk_window *found = 0;
+    int x0, y0, x1, y1, x, y;
+
+    x0 = nk_window_grid_cell(area.x, grid->x, grid->cell, grid->cols);
+    y0 = nk_window_grid_cell(area.y, grid->y, grid->cell, grid->rows);
+    x1 = (point) ? x0: nk_window_grid_cell(area.x + area.w, grid->x, grid->cell, grid->cols);
+    y1 = (point) ? y0: nk_window_grid_cell(area.y + area.h, grid->y, grid->cell, grid->rows);
+    for (y = y0; y <= y1; ++y) {
+        for (x = x0; x <= x1; ++x) {
+            int cell = y * grid->cols + x;
+            int begin = grid->starts[cell];
+            int end = grid->starts[cell + 1];
+            if (above) {
+                /* skip the windows below `above` in the z sorted cell */
+                int last = end;
+                while (begin < last) {
+                    int mid = begin + (last - begin) / 2;
+                    if (grid->entries[mid]->z <= above->z)
+                        begin = mid + 1;
+                    else last = mid;
+                }
+            }
+            for (; begin < end; ++begin) {
+                struct nk_window *iter = grid->entries[begin];
+                if (found && iter->z >= found->z) break;
+                if (nk_window_grid_hit(iter, area, point, header_height)) {
+                    found = iter;
+                    break;
+                }
+            }
+        }
+    }
+    return found;
+}
+NK_INTERN struct nk_window*
+nk_window_grid_search_popup(const struct nk_window_grid *grid, const struct nk_window *above,
+    const struct nk_window *below, struct nk_rect area, nk_bool point)
+{
+    int i;
+    for (i = 0; i < grid->popup_count; ++i) {
+        struct nk_window *iter = grid->popups[i];
+        if (above && iter->z <= above->z) continue;
+        if (below && iter->z >= below->z) break;
+        if (nk_window_grid_popup_hit(iter, area, point))
+            return iter;
+    }
+    return 0;
+}
+NK_LIB struct nk_window*
+nk_window_grid_find(struct nk_context *ctx, const struct nk_window *above,
+    struct nk_rect area, nk_bool point, float header_height)
+{
+    struct nk_window_grid *grid;
+
+    NK_ASSERT(ctx);
+    if (!ctx) return 0;
+    grid = nk_window_grid_get(ctx, header_height);
+    if (!grid->cell) {
+        /* no memory for the grid: search the list */
+        struct nk_window *iter = (above) ? above->next: ctx->begin;
+        for (; iter; iter = iter->next) {
+            if (nk_window_grid_hit(iter, area, point, header_height))
+                return iter;
+        }
+        return 0;
+    }
+    return nk_window_grid_search(grid, above, area, point, header_height);
+}
+NK_LIB struct nk_window*
+nk_window_grid_find_popup(struct nk_context *ctx, const struct nk_window *above,
+    const struct nk_window *below, struct nk_rect area, nk_bool point)
+{
+    struct nk_window_grid *grid;
+
+    NK_ASSERT(ctx);
+    if (!ctx) return 0;
+    grid = nk_window_grid_get(ctx, ctx->grid.header);
+    if (!grid->cell) {
+        struct nk_window *iter = (above) ? above->next: ctx->begin;
+        for (; iter && iter != below; iter = iter->next) {
+            if (nk_window_grid_popup_hit(iter, area, point))
+                return iter;
+        }
+        return 0;
+    }
+    return nk_window_grid_search_popup(grid, above, below, area, point);
+}
+NK_LIB nk_bool
+nk_window_grid_any(const struct nk_context *ctx, struct nk_rect area,
+    nk_bool point, float header_height)
+{
+    /* true if a window or an open popup covers `area`. Queries must not
+     * change the context, so this only reads a grid that is up to date and
+     * otherwise searches the list */
+    const struct nk_window *iter;
+    NK_ASSERT(ctx);
+    if (!ctx) return nk_false;
+    if (nk_window_grid_current(ctx, header_height))
+        return nk_window_grid_search(&ctx->grid, 0, area, point, header_height) ||
+            nk_window_grid_search_popup(&ctx->grid, 0, 0, area, point);
+    for (iter = ctx->begin; iter; iter = iter->next) {
+        if (nk_window_grid_hit(iter, area, point, header_height) ||
+            nk_window_grid_popup_hit(iter, area, point))
+            return nk_true;
+    }
+    return nk_false;
+}
@@ -0,0 +1,322 @@
+/* frames serialized in one process and applied in another over a pipe give
+ * the same draw commands, fonts and images only travel as registered ids */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "nuklear.h"
+
+#define FRAMES 40
+#define DROPPED 20
+
+static const struct nk_user_font *font_a, *font_b;
+static unsigned char pixels[16];
+static char expected[1 << 20], applied[1 << 20], frame_data[1 << 20];
+
+static float
+text_width(nk_handle handle, float height, const char *text, int len)
+{
+    (void)handle; (void)height;
+    return 7.0f * (float)nk_utf_len(text, len);
+}
+static void
+custom(void *canvas, short x, short y, unsigned short w, unsigned short h, nk_handle data)
+{
+    (void)canvas; (void)x; (void)y; (void)w; (void)h; (void)data;
+}
+static int
+font_id(const struct nk_user_font *font)
+{
+    return (font == font_a) ? 1: (font == font_b) ? 2: 0;
+}
+static int
+image_id(nk_handle handle)
+{
+    return (handle.ptr == pixels) ? -1: handle.id;
+}
+static size_t
+dump(struct nk_context *ctx, char *out)
+{
+    /* one line per command with its fields, pointers replaced by ids */
+    const struct nk_command *cmd;
+    size_t n = 0;
+    nk_foreach(cmd, ctx) {
+        const union {
+            struct nk_command_rect_filled rect;
+            struct nk_command_scissor scissor;
+            struct nk_command_polygon_filled polygon;
+            struct nk_command_text text;
+            struct nk_command_text_ref text_ref;
+            struct nk_command_image image;
+            struct nk_command_custom custom;
+        } *c = (const void*)cmd;
+        int i;
+        switch (cmd->type) {
+        case NK_COMMAND_SCISSOR:
+            n += (size_t)sprintf(out + n, "scissor %d %d %d %d", c->scissor.x,
+                c->scissor.y, c->scissor.w, c->scissor.h);
+            break;
+        case NK_COMMAND_RECT_FILLED:
+            n += (size_t)sprintf(out + n, "rect %d %d %d %d %d %08x", c->rect.rounding,
+                c->rect.x, c->rect.y, c->rect.w, c->rect.h, nk_color_u32(c->rect.color));
+            break;
+        case NK_COMMAND_POLYGON_FILLED:
+            n += (size_t)sprintf(out + n, "polygon %08x", nk_color_u32(c->polygon.color));
+            for (i = 0; i < c->polygon.point_count; ++i)
+                n += (size_t)sprintf(out + n, " %d,%d", c->polygon.points[i].x, c->polygon.points[i].y);
+            break;
+        case NK_COMMAND_TEXT:
+            n += (size_t)sprintf(out + n, "text f%d %d %d %d %d %08x [%s]",
+                font_id(c->text.font), c->text.x, c->text.y, c->text.w, c->text.h,
+                nk_color_u32(c->text.foreground), c->text.string);
+            break;
+        case NK_COMMAND_TEXT_REF:
+            /* references are sent as copies */
+            n += (size_t)sprintf(out + n, "text f%d %d %d %d %d %08x [%.*s]",
+                font_id(c->text_ref.font), c->text_ref.x, c->text_ref.y, c->text_ref.w,
+                c->text_ref.h, nk_color_u32(c->text_ref.foreground),
+                c->text_ref.length, c->text_ref.string);
+            break;
+        case NK_COMMAND_IMAGE:
+            n += (size_t)sprintf(out + n, "image %d %d %d %d %d %d %d", c->image.x,
+                c->image.y, c->image.w, c->image.h, image_id(c->image.img.handle),
+                c->image.img.w, c->image.img.h);
+            break;
+        case NK_COMMAND_CUSTOM:
+            n += (size_t)sprintf(out + n, "custom %d %d %d", c->custom.x,
+                c->custom.callback_data.id, c->custom.callback == custom);
+            break;
+        default:
+            n += (size_t)sprintf(out + n, "type %d", cmd->type);
+            break;
+        }
+        out[n++] = '\n';
+    }
+    out[n] = 0;
+    return n;
+}
+static void
+build(struct nk_context *ctx, int frame)
+{
+    int i, k;
+    for (i = 0; i < 3; ++i) {
+        char name[16];
+        snprintf(name, sizeof(name), "window%d", i);
+        if (i == 2 && (frame / 7) % 3 == 1) continue; /* a window comes and goes */
+        if (nk_begin(ctx, name, nk_rect(10.0f + (float)(i * 230 + frame % 5), 10, 220, 320),
+            NK_WINDOW_BORDER|NK_WINDOW_TITLE)) {
+            struct nk_command_buffer *canvas = nk_window_get_canvas(ctx);
+            struct nk_rect r;
+            canvas->use_text_ref = (frame % 3 == 0);
+            nk_layout_row_dynamic(ctx, 20, 2);
+            for (k = 0; k < 6; ++k) {
+                if (k == 3) nk_style_set_font(ctx, font_b);
+                nk_labelf(ctx, NK_TEXT_LEFT, "%d:%d", i, (k == 5) ? k + frame: k);
+                if (k == 3) nk_style_set_font(ctx, font_a);
+                nk_button_label(ctx, "button");
+            }
+            nk_layout_row_dynamic(ctx, 40, 1);
+            if (nk_widget(&r, ctx)) {
+                float points[6] = {r.x, r.y, r.x + 20, r.y + 10, r.x + 10, r.y + 30};
+                struct nk_image img = (i & 1) ? nk_image_ptr(pixels): nk_image_id(40 + i);
+                img.w = img.h = 2;
+                nk_fill_polygon(canvas, points, 3, nk_rgb(10 * i, 20, frame));
+                nk_draw_image(canvas, nk_rect(r.x + 40, r.y, 20, 20), &img, nk_rgb(255, 255, 255));
+                nk_push_custom(canvas, nk_rect(r.x + 70, r.y, 20, 20), custom, nk_handle_id(70 + i));
+            }
+        }
+        nk_end(ctx);
+    }
+}
+static int
+read_all(int fd, void *memory, size_t size)
+{
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = read(fd, (char*)memory + done, size - done);
+        if (n <= 0) return 0;
+        done += (size_t)n;
+    }
+    return 1;
+}
+static int
+write_all(int fd, const void *memory, size_t size)
+{
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = write(fd, (const char*)memory + done, size - done);
+        if (n <= 0) return 0;
+        done += (size_t)n;
+    }
+    return 1;
+}
+static void
+register_ids(struct nk_command_serializer *ser, struct nk_command_deserializer *des,
+    const struct nk_user_font *a, const struct nk_user_font *b)
+{
+    int i;
+    if (ser) {
+        nk_command_serializer_font(ser, a, 1);
+        nk_command_serializer_font(ser, b, 2);
+        nk_command_serializer_image(ser, nk_handle_ptr(pixels), 9);
+        for (i = 0; i < 3; ++i)
+            nk_command_serializer_image(ser, nk_handle_id(40 + i), (nk_uint)(40 + i));
+    }
+    if (des) {
+        nk_command_deserializer_font(des, 1, a);
+        nk_command_deserializer_font(des, 2, b);
+        nk_command_deserializer_image(des, 9, nk_handle_ptr(pixels));
+        for (i = 0; i < 3; ++i)
+            nk_command_deserializer_image(des, (nk_uint)(40 + i), nk_handle_id(40 + i));
+    }
+}
+static int
+renderer(int fd, const struct nk_user_font *a, const struct nk_user_font *b)
+{
+    /* the fonts of this process are other objects with the same ids */
+    struct nk_user_font ra = *a, rb = *b;
+    struct nk_command_deserializer des;
+    struct nk_context ctx;
+    int frame, failed = 0;
+
+    font_a = &ra;
+    font_b = &rb;
+    nk_init_default(&ctx, &ra);
+    nk_command_deserializer_init_default(&des);
+    des.custom = custom;
+    register_ids(0, &des, &ra, &rb);
+    for (frame = 0; frame < FRAMES; ++frame) {
+        size_t size, expected_size;
+        int accept;
+        nk_bool applied_ok;
+        if (!read_all(fd, &size, sizeof(size)) || !read_all(fd, frame_data, size) ||
+            !read_all(fd, &accept, sizeof(accept)) ||
+            !read_all(fd, &expected_size, sizeof(expected_size)) ||
+            !read_all(fd, expected, expected_size)) return 2;
+        expected[expected_size] = 0;
+        applied_ok = nk_command_deserialize(&des, &ctx, frame_data, size);
+        if (applied_ok != accept) {
+            printf("frame %d: deserialize returned %d\n", frame, applied_ok);
+            failed = 1;
+        } else if (applied_ok) {
+            dump(&ctx, applied);
+            if (strcmp(expected, applied)) {
+                printf("frame %d: commands differ\n%s----\n%s", frame, expected, applied);
+                failed = 1;
+            }
+        }
+        nk_clear(&ctx);
+    }
+    nk_command_deserializer_free(&des);
+    nk_free(&ctx);
+    return failed;
+}
+static int
+unregistered(const struct nk_user_font *a, const struct nk_user_font *b)
+{
+    /* frames using fonts or images without an id are neither sent nor applied */
+    struct nk_command_serializer ser;
+    struct nk_command_deserializer des;
+    struct nk_context ctx, rctx;
+    const void *data;
+    nk_size size;
+    int failed = 0;
+
+    nk_init_default(&ctx, a);
+    nk_init_default(&rctx, a);
+    nk_command_serializer_init_default(&ser);
+    nk_command_deserializer_init_default(&des);
+
+    nk_command_serializer_font(&ser, a, 1);
+    build(&ctx, 0);
+    if (nk_command_serialize(&ser, &ctx, &size)) {
+        printf("frame with unregistered font and images was serialized\n");
+        failed = 1;
+    }
+    nk_clear(&ctx);
+
+    register_ids(&ser, 0, a, b);
+    build(&ctx, 0);
+    data = nk_command_serialize(&ser, &ctx, &size);
+    if (!data) {
+        printf("frame with registered fonts and images was not serialized\n");
+        failed = 1;
+    } else if (nk_command_deserialize(&des, &rctx, data, size)) {
+        printf("frame with unknown ids was applied\n");
+        failed = 1;
+    }
+    nk_clear(&ctx);
+    nk_clear(&rctx);
+
+    nk_command_deserializer_free(&des);
+    nk_command_serializer_free(&ser);
+    nk_free(&rctx);
+    nk_free(&ctx);
+    return failed;
+}
+int
+main(void)
+{
+    struct nk_user_font a, b;
+    struct nk_command_serializer ser;
+    struct nk_context ctx;
+    int fds[2], status, frame;
+    pid_t pid;
+
+    memset(&a, 0, sizeof(a));
+    a.height = 14;
+    a.width = text_width;
+    b = a;
+    b.height = 18;
+    font_a = &a;
+    font_b = &b;
+    if (unregistered(&a, &b))
+        return 1;
+
+    if (pipe(fds)) return 1;
+    pid = fork();
+    if (pid < 0) return 1;
+    if (!pid) {
+        close(fds[1]);
+        _exit(renderer(fds[0], &a, &b));
+    }
+    close(fds[0]);
+
+    nk_init_default(&ctx, &a);
+    nk_command_serializer_init_default(&ser);
+    register_ids(&ser, 0, &a, &b);
+    for (frame = 0; frame < FRAMES; ++frame) {
+        const void *data;
+        nk_size size;
+        size_t dump_size;
+        int accept = 1;
+
+        nk_input_begin(&ctx);
+        nk_input_motion(&ctx, 5 + (frame * 37) % 700, 5 + (frame * 13) % 300);
+        nk_input_end(&ctx);
+        build(&ctx, frame);
+        data = nk_command_serialize(&ser, &ctx, &size);
+        if (!data) return 1;
+        if (frame == DROPPED) {
+            /* a lost frame: the next one is rejected until the sender resets */
+            data = "NK";
+            size = 2;
+            accept = 0;
+        } else if (frame == DROPPED + 1) {
+            accept = 0;
+            nk_command_serializer_reset(&ser);
+        }
+        dump_size = dump(&ctx, expected);
+        nk_clear(&ctx);
+        if (!write_all(fds[1], &size, sizeof(size)) || !write_all(fds[1], data, size) ||
+            !write_all(fds[1], &accept, sizeof(accept)) ||
+            !write_all(fds[1], &dump_size, sizeof(dump_size)) ||
+            !write_all(fds[1], expected, dump_size)) return 1;
+    }
+    close(fds[1]);
+    nk_command_serializer_free(&ser);
+    nk_free(&ctx);
+    if (waitpid(pid, &status, 0) != pid) return 1;
+    return !(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
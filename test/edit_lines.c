@@ -0,0 +1,119 @@
+/* every word wrapped edit widget keeps its own line table, so two of them
+ * in one window do not re-wrap their text every frame */
+#include <stdio.h>
+#include <string.h>
+#include "nuklear.h"
+
+#define TEXT_SIZE 4096
+
+static int failed;
+static int width_calls;
+
+static float
+text_width(nk_handle handle, float height, const char *text, int len)
+{
+    (void)handle; (void)height;
+    width_calls++;
+    return 7.0f * (float)nk_utf_len(text, len);
+}
+static int
+first_rows(struct nk_context *ctx)
+{
+    /* rows in the table of the first edit widget */
+    const struct nk_window *win = nk_window_find(ctx, "edits");
+    const struct nk_edit_lines *it;
+    for (it = win ? win->edit_lines: 0; it; it = it->next)
+        if (it->name == 0) return it->lines.count;
+    return 0;
+}
+static int
+table_count(struct nk_context *ctx)
+{
+    const struct nk_window *win = nk_window_find(ctx, "edits");
+    const struct nk_edit_lines *it;
+    int count = 0;
+    for (it = win ? win->edit_lines: 0; it; it = it->next)
+        count++;
+    return count;
+}
+static void
+frame(struct nk_context *ctx, char texts[][TEXT_SIZE], int lens[], int edits)
+{
+    const struct nk_command *cmd;
+    int i;
+    nk_input_begin(ctx);
+    nk_input_end(ctx);
+    if (nk_begin(ctx, "edits", nk_rect(0, 0, 400, 800), 0)) {
+        nk_layout_row_dynamic(ctx, 300, 1);
+        for (i = 0; i < edits; ++i)
+            nk_edit_string(ctx, NK_EDIT_BOX | NK_EDIT_WORD_WRAP, texts[i], &lens[i],
+                TEXT_SIZE, 0);
+    }
+    nk_end(ctx);
+    nk_foreach(cmd, ctx);
+    nk_clear(ctx);
+}
+int
+main(void)
+{
+    static char texts[2][TEXT_SIZE];
+    int lens[2];
+    struct nk_context ctx;
+    struct nk_user_font font;
+    int i, one;
+
+    memset(&font, 0, sizeof(font));
+    font.height = 10;
+    font.width = text_width;
+    for (i = 0; i < 2; ++i) {
+        int at = 0;
+        while (at + 16 < TEXT_SIZE / 2)
+            at += sprintf(texts[i] + at, (i) ? "longer wore %d ": "longer word %d ", at);
+        lens[i] = at;
+    }
+    if (!nk_init_default(&ctx, &font))
+        return 1;
+
+    /* drawing one widget measures its visible rows */
+    for (i = 0; i < 3; ++i)
+        frame(&ctx, texts, lens, 1);
+    width_calls = 0;
+    frame(&ctx, texts, lens, 1);
+    one = width_calls;
+
+    /* two of them cost twice that once both tables are built */
+    for (i = 0; i < 3; ++i)
+        frame(&ctx, texts, lens, 2);
+    if (table_count(&ctx) != 2) {
+        printf("%d line tables for two edit widgets\n", table_count(&ctx));
+        failed = 1;
+    }
+    width_calls = 0;
+    frame(&ctx, texts, lens, 2);
+    if (width_calls > 2 * one + 16) {
+        printf("two edit widgets measured %d times in a frame, one %d times\n",
+            width_calls, one);
+        failed = 1;
+    }
+
+    /* the table of a widget that is gone is freed with the frame */
+    frame(&ctx, texts, lens, 1);
+    if (table_count(&ctx) != 1) {
+        printf("%d line tables for one edit widget\n", table_count(&ctx));
+        failed = 1;
+    }
+
+    /* another buffer with text of the same length gets its own rows */
+    memset(texts[1], 'x', (size_t)lens[0]);
+    for (i = 9; i < lens[0]; i += 10)
+        texts[1][i] = '\n';
+    texts[1][lens[0]] = 0;
+    lens[1] = lens[0];
+    frame(&ctx, texts + 1, lens + 1, 1);
+    if (first_rows(&ctx) != lens[0] / 10 + 1) {
+        printf("%d rows for %d lines\n", first_rows(&ctx), lens[0] / 10 + 1);
+        failed = 1;
+    }
+    nk_free(&ctx);
+    return failed;
+}
@@ -0,0 +1,178 @@
+/* inserting, deleting and reading text of a gap buffer string around the
+ * gap, compared against the same edits on a plain string */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nuklear.h"
+
+static int failed;
+
+static int
+spans(const struct nk_str *s, char *out)
+{
+    /* the text piece by piece without closing the gap, returns the pieces */
+    int pos = 0, len, pieces = 0;
+    const char *text;
+    while ((text = nk_str_span(s, pos, &len)) != 0) {
+        memcpy(out + pos, text, (size_t)len);
+        pos += len;
+        pieces++;
+    }
+    out[pos] = 0;
+    return pieces;
+}
+static void
+expect(struct nk_str *s, const char *text, int line)
+{
+    /* checks the spans first since the other readers close the gap */
+    char buf[4096];
+    const char *get;
+    int len = (int)strlen(text);
+    spans(s, buf);
+    if (strcmp(buf, text)) {
+        printf("line %d: spans give \"%s\", expected \"%s\"\n", line, buf, text);
+        failed = 1;
+    }
+    if (nk_str_len_char(s) != len || nk_str_len(s) != nk_utf_len(text, len)) {
+        printf("line %d: length %d bytes %d runes, expected %d bytes %d runes\n", line,
+            nk_str_len_char(s), nk_str_len(s), len, nk_utf_len(text, len));
+        failed = 1;
+    }
+    get = nk_str_get_const(s);
+    if (len && (!get || memcmp(get, text, (size_t)len))) {
+        printf("line %d: nk_str_get_const gives \"%.*s\", expected \"%s\"\n", line,
+            get ? len: 0, get ? get: "", text);
+        failed = 1;
+    }
+}
+static void
+around_gap(void)
+{
+    struct nk_str s;
+    char buf[256];
+    const char *at;
+    nk_rune rune;
+    int len;
+
+    nk_str_init_default(&s);
+    s.use_gap = nk_true;
+    nk_str_append_str_char(&s, "hello world");
+    nk_str_insert_at_rune(&s, 6, "big ", 4);
+    if (!s.gap_len || spans(&s, buf) != 2) {
+        printf("insert in the middle left no gap\n");
+        failed = 1;
+    }
+    /* next to the gap on both sides */
+    nk_str_insert_at_rune(&s, 10, "old ", 4);
+    nk_str_insert_at_rune(&s, 6, "a ", 2);
+    nk_str_delete_runes(&s, 8, 4);
+    nk_str_delete_runes(&s, 0, 1);
+    at = nk_str_at_const(&s, 9, &rune, &len);
+    if (!at || rune != 'd' || len != 1 || !s.gap_len) {
+        printf("rune behind the gap is %c\n", at ? (char)rune: '?');
+        failed = 1;
+    }
+    expect(&s, "ello a old world", __LINE__);
+    if (s.gap_len) {
+        printf("nk_str_get_const left the gap open\n");
+        failed = 1;
+    }
+
+    /* the gap opens again with the next edit, at_char_const reads to the end */
+    nk_str_delete_runes(&s, 6, 4);
+    at = nk_str_at_char_const(&s, 2);
+    if (!at || memcmp(at, "lo a world", 10)) {
+        printf("nk_str_at_char_const gives \"%.10s\"\n", at ? at: "");
+        failed = 1;
+    }
+
+    /* runes of several bytes on both sides */
+    nk_str_clear(&s);
+    nk_str_append_str_char(&s, "\xc3\xa4\xe2\x82\xac\xf0\x9f\x98\x80");
+    nk_str_insert_at_rune(&s, 1, "\xc3\xb6x", 3);
+    if (nk_str_rune_at(&s, 0) != 0xe4 || nk_str_rune_at(&s, 1) != 0xf6 ||
+        nk_str_rune_at(&s, 2) != 'x' || nk_str_rune_at(&s, 3) != 0x20ac ||
+        nk_str_rune_at(&s, 4) != 0x1f600) {
+        printf("runes around the gap differ\n");
+        failed = 1;
+    }
+    nk_str_delete_runes(&s, 2, 2);
+    expect(&s, "\xc3\xa4\xc3\xb6\xf0\x9f\x98\x80", __LINE__);
+    nk_str_free(&s);
+}
+static void
+fixed(void)
+{
+    /* a fixed buffer only has the bytes it was given for text and gap */
+    char memory[24];
+    struct nk_str s;
+    int i;
+    nk_str_init_fixed(&s, memory, sizeof(memory));
+    s.use_gap = nk_true;
+    nk_str_append_str_char(&s, "0123456789");
+    for (i = 0; i < 20; ++i)
+        nk_str_insert_at_rune(&s, 5, "ab", 2);
+    if (nk_str_len_char(&s) > (int)sizeof(memory) - 1 || nk_str_len_char(&s) < 20) {
+        printf("fixed buffer holds %d bytes\n", nk_str_len_char(&s));
+        failed = 1;
+    }
+    nk_str_delete_runes(&s, 0, 5);
+    nk_str_delete_runes(&s, nk_str_len(&s) - 5, 5);
+    for (i = 0; i < nk_str_len(&s); ++i) {
+        if (nk_str_rune_at(&s, i) != (nk_rune)((i & 1) ? 'b': 'a')) {
+            printf("fixed buffer rune %d is %c\n", i, (char)nk_str_rune_at(&s, i));
+            failed = 1;
+            break;
+        }
+    }
+}
+static void
+random_edits(void)
+{
+    /* random inserts and deletes give the same text as a plain string */
+    char expected[2048];
+    struct nk_str s;
+    int i, len = 0;
+
+    srand(7);
+    nk_str_init_default(&s);
+    s.use_gap = nk_true;
+    for (i = 0; i < 4000 && !failed; ++i) {
+        int pos = len ? rand() % (len + 1): 0;
+        if (len < 1500 && rand() % 3) {
+            char text[8];
+            int n = 1 + rand() % 7, k;
+            for (k = 0; k < n; ++k)
+                text[k] = (char)('a' + rand() % 26);
+            nk_str_insert_at_rune(&s, pos, text, n);
+            memmove(expected + pos + n, expected + pos, (size_t)(len - pos));
+            memcpy(expected + pos, text, (size_t)n);
+            len += n;
+        } else if (len) {
+            int n = 1 + rand() % 9;
+            n = NK_MIN(n, len - pos);
+            nk_str_delete_runes(&s, pos, n);
+            memmove(expected + pos, expected + pos + n, (size_t)(len - pos - n));
+            len -= n;
+        }
+        expected[len] = 0;
+        if (i % 97 == 0) expect(&s, expected, __LINE__);
+        else {
+            char buf[2048];
+            spans(&s, buf);
+            if (strcmp(buf, expected)) {
+                printf("edit %d: text differs\n", i);
+                failed = 1;
+            }
+        }
+    }
+    nk_str_free(&s);
+}
+int
+main(void)
+{
+    around_gap();
+    fixed();
+    random_edits();
+    return failed;
+}
@@ -0,0 +1,184 @@
+/* text measurements of labels and wrapped paragraphs come from the context
+ * text cache once they were measured, for the text they were measured for */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nuklear.h"
+#include "nuklear_internal.h"
+
+#define LABELS 300
+#define WORDS 120
+#define TEXTS (LABELS + WORDS)
+
+static int failed;
+static int width_calls;
+
+static float
+text_width(nk_handle handle, float height, const char *text, int len)
+{
+    (void)handle; (void)height;
+    width_calls++;
+    return 7.0f * (float)nk_utf_len(text, len);
+}
+struct hashed {
+    nk_hash hash;
+    int index;
+};
+static int
+by_hash(const void *a, const void *b)
+{
+    nk_hash x = ((const struct hashed*)a)->hash;
+    nk_hash y = ((const struct hashed*)b)->hash;
+    return (x > y) - (x < y);
+}
+static void
+name(char *out, int index)
+{
+    /* letters in both 4 byte blocks the hash mixes */
+    unsigned int state = (unsigned int)index;
+    int i;
+    for (i = 0; i < 8; ++i) {
+        state = state * 1103515245u + 12345u;
+        out[i] = (char)('a' + (state >> 16) % 26);
+    }
+}
+static void
+collision(const struct nk_user_font *font)
+{
+    /* two texts of the same length and hash are still different texts */
+    enum {COUNT = 1 << 19};
+    struct nk_text_cache cache;
+    struct nk_text_cache_entry *e;
+    struct hashed *hashes = (struct hashed*)malloc(COUNT * sizeof(*hashes));
+    char a[8], b[8];
+    int i;
+
+    for (i = 0; i < COUNT; ++i) {
+        name(a, i);
+        hashes[i].hash = nk_murmur_hash(a, 8, NK_TEXT_CACHE_LABEL);
+        hashes[i].index = i;
+    }
+    qsort(hashes, COUNT, sizeof(*hashes), by_hash);
+    for (i = 1; i < COUNT; ++i) {
+        if (hashes[i].hash != hashes[i-1].hash) continue;
+        name(a, hashes[i-1].index);
+        name(b, hashes[i].index);
+        if (memcmp(a, b, 8)) break;
+    }
+    free(hashes);
+    if (i == COUNT) {
+        printf("no two names with the same hash\n");
+        failed = 1;
+        return;
+    }
+
+    nk_zero_struct(cache);
+    cache.alloc.alloc = nk_malloc;
+    cache.alloc.free = nk_mfree;
+    e = nk_text_cache_get(&cache, font, a, 8, NK_TEXT_CACHE_LABEL);
+    if (!e) {
+        printf("no cache entry\n");
+        failed = 1;
+        return;
+    }
+    e->width = 1.0f;
+    e = nk_text_cache_get(&cache, font, b, 8, NK_TEXT_CACHE_LABEL);
+    if (!e || e->width >= 0 || memcmp(e->text, b, 8)) {
+        printf("\"%.8s\" hit the entry of \"%.8s\"\n", b, a);
+        failed = 1;
+    }
+    e = nk_text_cache_get(&cache, font, a, 8, NK_TEXT_CACHE_LABEL);
+    if (!e || e->width != 1.0f) {
+        printf("\"%.8s\" lost its entry\n", a);
+        failed = 1;
+    }
+    nk_text_cache_free(&cache);
+}
+static int
+by_value(const void *a, const void *b)
+{
+    return *(const int*)a - *(const int*)b;
+}
+static void
+text_lengths(struct nk_context *ctx, int *lengths, int *count)
+{
+    const struct nk_command *cmd;
+    *count = 0;
+    nk_foreach(cmd, ctx) {
+        if (cmd->type == NK_COMMAND_TEXT && *count < TEXTS)
+            lengths[(*count)++] = ((const struct nk_command_text*)cmd)->length;
+    }
+    /* windows may swap places between frames */
+    qsort(lengths, (size_t)*count, sizeof(int), by_value);
+}
+static void
+frame(struct nk_context *ctx, const char *paragraph, int *lengths, int *count)
+{
+    char label[16];
+    int i;
+    nk_input_begin(ctx);
+    nk_input_end(ctx);
+    if (nk_begin(ctx, "labels", nk_rect(0, 0, 200, 8000), NK_WINDOW_NO_SCROLLBAR)) {
+        nk_layout_row_dynamic(ctx, 18, 1);
+        for (i = 0; i < LABELS; ++i) {
+            sprintf(label, "label %d", i);
+            nk_label(ctx, label, NK_TEXT_LEFT);
+        }
+    }
+    nk_end(ctx);
+    if (nk_begin(ctx, "paragraph", nk_rect(200, 0, 200, 4000), NK_WINDOW_NO_SCROLLBAR)) {
+        nk_layout_row_dynamic(ctx, 3000, 1);
+        nk_label_wrap(ctx, paragraph);
+    }
+    nk_end(ctx);
+    text_lengths(ctx, lengths, count);
+    nk_clear(ctx);
+}
+static void
+cached_frames(const struct nk_user_font *font)
+{
+    /* more labels than the cache starts with and a paragraph of more lines
+     * than a cache entry kept before */
+    struct nk_context ctx;
+    char paragraph[WORDS * 8];
+    int first[TEXTS], lengths[TEXTS];
+    int first_count, count, i;
+
+    paragraph[0] = 0;
+    for (i = 0; i < WORDS; ++i)
+        strcat(paragraph, (i % 3) ? "word ": "longer ");
+    if (!nk_init_default(&ctx, font)) {
+        failed = 1;
+        return;
+    }
+    frame(&ctx, paragraph, first, &first_count);
+    if (first_count < LABELS + 16) {
+        printf("%d texts drawn\n", first_count);
+        failed = 1;
+    }
+    for (i = 0; i < 8; ++i)
+        frame(&ctx, paragraph, lengths, &count);
+    width_calls = 0;
+    frame(&ctx, paragraph, lengths, &count);
+    if (width_calls * NK_TEXT_CACHE_GROW_RATIO > LABELS) {
+        printf("%d texts measured again, cache of %d entries\n",
+            width_calls, ctx.text_cache.capacity);
+        failed = 1;
+    }
+    if (count != first_count || memcmp(lengths, first, (size_t)count * sizeof(int))) {
+        printf("cached frame draws other texts\n");
+        failed = 1;
+    }
+    nk_free(&ctx);
+}
+int
+main(void)
+{
+    struct nk_user_font font;
+    memset(&font, 0, sizeof(font));
+    font.height = 10;
+    font.width = text_width;
+    collision(&font);
+    cached_frames(&font);
+    return failed;
+}
@@ -0,0 +1,169 @@
+/* undo and redo through the text edit journal, including changes that do
+ * not fit into it */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nuklear.h"
+
+static int failed;
+
+static void
+expect_text(struct nk_text_edit *edit, const char *text, int line)
+{
+    int len = nk_str_len_char(&edit->string);
+    const char *str = nk_str_get(&edit->string);
+    if (len == (int)strlen(text) && (!len || !memcmp(str, text, (size_t)len)))
+        return;
+    printf("line %d: text is %.*s (%d bytes), expected %.40s (%d bytes)\n",
+        line, (len < 40) ? len: 40, str ? str: "", len, text, (int)strlen(text));
+    failed = 1;
+}
+static void
+expect_len(struct nk_text_edit *edit, int len, int line)
+{
+    if (nk_str_len_char(&edit->string) == len) return;
+    printf("line %d: text has %d bytes, expected %d\n",
+        line, nk_str_len_char(&edit->string), len);
+    failed = 1;
+}
+static void
+init(struct nk_text_edit *edit)
+{
+    nk_textedit_init_default(edit);
+    nk_textedit_set_undo_journal(edit, nk_true);
+    edit->mode = NK_TEXT_EDIT_MODE_INSERT;
+    edit->single_line = 0;
+}
+static void
+type(struct nk_text_edit *edit, const char *text)
+{
+    nk_textedit_text(edit, text, (int)strlen(text));
+}
+static void
+undo_redo(void)
+{
+    struct nk_text_edit edit;
+    init(&edit);
+    type(&edit, "hello");
+    type(&edit, " world\n");
+    type(&edit, "again");
+    expect_text(&edit, "hello world\nagain", __LINE__);
+
+    /* a line break ends the typed run */
+    nk_textedit_undo(&edit);
+    expect_text(&edit, "hello world\n", __LINE__);
+    nk_textedit_undo(&edit);
+    expect_text(&edit, "", __LINE__);
+    nk_textedit_undo(&edit);
+    expect_text(&edit, "", __LINE__);
+    nk_textedit_redo(&edit);
+    expect_text(&edit, "hello world\n", __LINE__);
+    nk_textedit_redo(&edit);
+    expect_text(&edit, "hello world\nagain", __LINE__);
+
+    /* replacing a selection is a removal and an insertion, a new change
+     * drops the redo */
+    edit.select_start = 0;
+    edit.select_end = 5;
+    type(&edit, "bye");
+    expect_text(&edit, "bye world\nagain", __LINE__);
+    nk_textedit_undo(&edit);
+    expect_text(&edit, " world\nagain", __LINE__);
+    nk_textedit_undo(&edit);
+    expect_text(&edit, "hello world\nagain", __LINE__);
+    edit.cursor = 0;
+    type(&edit, ">");
+    nk_textedit_redo(&edit);
+    expect_text(&edit, ">hello world\nagain", __LINE__);
+    nk_textedit_free(&edit);
+}
+static void
+oversized(void)
+{
+    /* a paste bigger than the journal keeps the history in front of it */
+    int size = NK_TEXTEDIT_JOURNAL_SIZE + NK_TEXTEDIT_JOURNAL_SIZE / 2;
+    char *big = (char*)malloc((size_t)size + 1);
+    struct nk_text_edit edit;
+
+    memset(big, 'x', (size_t)size);
+    big[size] = 0;
+    init(&edit);
+    type(&edit, "one\n");
+    type(&edit, "two\n");
+    nk_textedit_paste(&edit, big, size);
+    expect_len(&edit, 8 + size, __LINE__);
+
+    nk_textedit_undo(&edit);
+    expect_text(&edit, "one\ntwo\n", __LINE__);
+    nk_textedit_redo(&edit);
+    expect_text(&edit, "one\ntwo\n", __LINE__);
+    nk_textedit_undo(&edit);
+    expect_text(&edit, "one\n", __LINE__);
+    nk_textedit_undo(&edit);
+    expect_text(&edit, "", __LINE__);
+    nk_textedit_redo(&edit);
+    expect_text(&edit, "one\n", __LINE__);
+
+    /* removing more than the journal holds can not be undone, but later
+     * changes can */
+    nk_textedit_paste(&edit, big, size);
+    nk_textedit_select_all(&edit);
+    nk_textedit_delete_selection(&edit);
+    expect_text(&edit, "", __LINE__);
+    type(&edit, "three");
+    nk_textedit_undo(&edit);
+    expect_text(&edit, "", __LINE__);
+    nk_textedit_undo(&edit);
+    expect_text(&edit, "", __LINE__);
+    nk_textedit_redo(&edit);
+    expect_text(&edit, "three", __LINE__);
+    nk_textedit_free(&edit);
+    free(big);
+}
+static void
+overflow(void)
+{
+    /* a full journal drops its oldest changes, the newest stay complete */
+    int piece = NK_TEXTEDIT_JOURNAL_SIZE / 16;
+    int i, count = 40, undone = 0;
+    char *text = (char*)malloc((size_t)piece);
+    struct nk_text_edit edit;
+
+    init(&edit);
+    for (i = 0; i < count; ++i) {
+        memset(text, 'a' + i % 26, (size_t)piece);
+        nk_textedit_paste(&edit, text, piece);
+    }
+    expect_len(&edit, count * piece, __LINE__);
+    for (;;) {
+        int len = nk_str_len_char(&edit.string);
+        nk_textedit_undo(&edit);
+        if (nk_str_len_char(&edit.string) == len) break;
+        undone++;
+    }
+    if (undone < 8 || undone >= count) {
+        printf("%d of %d changes could be undone\n", undone, count);
+        failed = 1;
+    }
+    expect_len(&edit, (count - undone) * piece, __LINE__);
+    for (i = 0; i < undone; ++i)
+        nk_textedit_redo(&edit);
+    expect_len(&edit, count * piece, __LINE__);
+    {const char *str = nk_str_get(&edit.string);
+    for (i = 0; i < count && !failed; ++i) {
+        if (str[i * piece] != 'a' + i % 26 || str[i * piece + piece - 1] != 'a' + i % 26) {
+            printf("piece %d differs after redo\n", i);
+            failed = 1;
+        }
+    }}
+    nk_textedit_free(&edit);
+    free(text);
+}
+int
+main(void)
+{
+    undo_redo();
+    oversized();
+    overflow();
+    return failed;
+}
@@ -0,0 +1,77 @@
+/* closing a window has to give all of its state tables back to the pool */
+#include <stdio.h>
+#include <string.h>
+#include "nuklear.h"
+
+static float
+text_width(nk_handle handle, float height, const char *text, int len)
+{
+    (void)handle; (void)height;
+    return 7.0f * (float)nk_utf_len(text, len);
+}
+static unsigned int
+pool_elements(const struct nk_context *ctx)
+{
+    const struct nk_page *page;
+    unsigned int count = 0;
+    for (page = ctx->pool.pages; page; page = page->next)
+        count += page->size;
+    return count;
+}
+static unsigned int
+free_elements(const struct nk_context *ctx)
+{
+    const struct nk_page_element *elem;
+    unsigned int count = 0;
+    for (elem = ctx->freelist; elem; elem = elem->next)
+        count++;
+    return count;
+}
+static void
+frame(struct nk_context *ctx, int with_group, int close)
+{
+    nk_input_begin(ctx);
+    nk_input_end(ctx);
+    if (nk_begin(ctx, "window", nk_rect(0, 0, 300, 300), NK_WINDOW_BORDER)) {
+        nk_layout_row_dynamic(ctx, 100, 1);
+        if (with_group && nk_group_begin(ctx, "group", NK_WINDOW_BORDER)) {
+            nk_layout_row_dynamic(ctx, 20, 1);
+            nk_label(ctx, "label", NK_TEXT_LEFT);
+            nk_group_end(ctx);
+        }
+    }
+    nk_end(ctx);
+    if (close) nk_window_close(ctx, "window");
+    nk_clear(ctx);
+}
+int
+main(void)
+{
+    struct nk_context ctx;
+    struct nk_user_font font;
+    unsigned int in_use = 0;
+    int round;
+
+    memset(&font, 0, sizeof(font));
+    font.height = 10;
+    font.width = text_width;
+    if (!nk_init_default(&ctx, &font))
+        return 1;
+    for (round = 0; round < 16; ++round) {
+        unsigned int used;
+        frame(&ctx, 1, 0);
+        frame(&ctx, 0, 1);
+        frame(&ctx, 0, 0);
+        nk_window_close(&ctx, "window");
+        nk_clear(&ctx);
+        used = pool_elements(&ctx) - free_elements(&ctx);
+        if (round && used != in_use) {
+            printf("round %d: %u pool elements in use, %u before\n", round, used, in_use);
+            nk_free(&ctx);
+            return 1;
+        }
+        in_use = used;
+    }
+    nk_free(&ctx);
+    return 0;
+}
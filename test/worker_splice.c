@@ -0,0 +1,151 @@
+/* windows of attached worker contexts are drawn above the windows of the
+ * context in the order of attachment, and only the context with the active
+ * text field gets the keyboard */
+#include <stdio.h>
+#include <string.h>
+#include "nuklear.h"
+
+#define WORKERS 2
+#define LABELS 200 /* enough commands to grow the command buffer */
+
+static int failed;
+static const char *names[WORKERS + 1] = {"main", "one", "two"};
+
+struct builder {
+    struct nk_context ctx;
+    char text[64];
+    struct nk_rect edit;
+    int focus;
+};
+
+static float
+text_width(nk_handle handle, float height, const char *text, int len)
+{
+    (void)handle; (void)height;
+    return 7.0f * (float)nk_utf_len(text, len);
+}
+static void
+build(struct builder *b, int index)
+{
+    int i;
+    if (nk_begin(&b->ctx, names[index], nk_rect(200.0f * (float)index, 0, 200, 2000), 0)) {
+        nk_layout_row_dynamic(&b->ctx, 30, 1);
+        b->edit = nk_widget_bounds(&b->ctx);
+        if (b->focus) nk_edit_focus(&b->ctx, NK_EDIT_ALWAYS_INSERT_MODE);
+        b->focus = 0;
+        nk_edit_string_zero_terminated(&b->ctx, NK_EDIT_FIELD, b->text, sizeof(b->text), 0);
+        nk_label(&b->ctx, names[index], NK_TEXT_LEFT);
+        nk_layout_row_dynamic(&b->ctx, 8, 1);
+        for (i = 0; i < LABELS; ++i)
+            nk_label(&b->ctx, "filler", NK_TEXT_LEFT);
+    }
+    nk_end(&b->ctx);
+}
+static void
+frame(struct builder *b, const struct nk_rect *click, char typed)
+{
+    const struct nk_command *cmd;
+    int i, order = 0, count = 0;
+
+    nk_input_begin(&b[0].ctx);
+    if (click) {
+        int x = (int)(click->x + click->w / 2), y = (int)(click->y + click->h / 2);
+        nk_input_motion(&b[0].ctx, x, y);
+        nk_input_button(&b[0].ctx, NK_BUTTON_LEFT, x, y, nk_true);
+    }
+    if (typed) nk_input_char(&b[0].ctx, typed);
+    nk_input_end(&b[0].ctx);
+    for (i = 1; i <= WORKERS; ++i)
+        nk_attach_worker(&b[0].ctx, &b[i].ctx);
+    for (i = WORKERS; i >= 0; --i)
+        build(&b[i], i);
+
+    /* labels naming the windows come in order, each one exactly once */
+    nk_foreach(cmd, &b[0].ctx) {
+        const struct nk_command_text *t = (const struct nk_command_text*)cmd;
+        if (cmd->type != NK_COMMAND_TEXT) continue;
+        for (i = 0; i <= WORKERS; ++i) {
+            if (t->length != (int)strlen(names[i]) || memcmp(t->string, names[i], (size_t)t->length))
+                continue;
+            if (i < order) {
+                printf("\"%s\" drawn after \"%s\"\n", names[i], names[order]);
+                failed = 1;
+            }
+            order = i;
+            count++;
+        }
+    }
+    if (count != WORKERS + 1) {
+        printf("%d window labels drawn\n", count);
+        failed = 1;
+    }
+    nk_clear(&b[0].ctx);
+
+    if (click) {
+        /* let go of the mouse in a frame of its own */
+        nk_input_begin(&b[0].ctx);
+        nk_input_button(&b[0].ctx, NK_BUTTON_LEFT, (int)click->x, (int)click->y, nk_false);
+        nk_input_end(&b[0].ctx);
+        for (i = 1; i <= WORKERS; ++i)
+            nk_attach_worker(&b[0].ctx, &b[i].ctx);
+        for (i = 0; i <= WORKERS; ++i)
+            build(&b[i], i);
+        nk_foreach(cmd, &b[0].ctx);
+        nk_clear(&b[0].ctx);
+    }
+}
+static void
+expect(const struct builder *b, const char *main, const char *one, const char *two, int line)
+{
+    if (strcmp(b[0].text, main) || strcmp(b[1].text, one) || strcmp(b[2].text, two)) {
+        printf("line %d: texts \"%s\" \"%s\" \"%s\", expected \"%s\" \"%s\" \"%s\"\n", line,
+            b[0].text, b[1].text, b[2].text, main, one, two);
+        failed = 1;
+    }
+}
+int
+main(void)
+{
+    static struct builder b[WORKERS + 1];
+    struct nk_user_font font;
+    struct nk_rect edit;
+    int i;
+
+    memset(&font, 0, sizeof(font));
+    font.height = 10;
+    font.width = text_width;
+    for (i = 0; i <= WORKERS; ++i)
+        if (!nk_init_default(&b[i].ctx, &font))
+            return 1;
+
+    for (i = 0; i < 3; ++i)
+        frame(b, 0, 0);
+    expect(b, "", "", "", __LINE__);
+
+    /* typing goes to the text field of the main context */
+    edit = b[0].edit;
+    frame(b, &edit, 0);
+    frame(b, 0, 'a');
+    expect(b, "a", "", "", __LINE__);
+
+    /* a worker text field takes the keyboard from it */
+    edit = b[1].edit;
+    frame(b, &edit, 0);
+    frame(b, 0, 'b');
+    frame(b, 0, 'c');
+    expect(b, "a", "bc", "", __LINE__);
+
+    /* focusing a field from code takes the keyboard too, while the field
+     * of the main context stays active */
+    edit = b[0].edit;
+    frame(b, &edit, 0);
+    frame(b, 0, 'd');
+    b[2].focus = 1;
+    frame(b, 0, 0);
+    frame(b, 0, 'e');
+    expect(b, "ad", "bc", "e", __LINE__);
+
+    for (i = WORKERS; i >= 0; --i)
+        nk_free(&b[i].ctx);
+    return failed;
+}